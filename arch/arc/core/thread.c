@@ -114,6 +114,9 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 #ifdef CONFIG_INIT_STACKS
 	memset(pStackMem, 0xaa, stackSize);
 #endif
+#ifdef CONFIG_STACK_USAGE
+	((struct tcs *)pStackMem)->stack_size = stackSize;
+#endif
 
 	/* carve the thread entry struct from the "base" of the stack */
 
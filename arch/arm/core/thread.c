@@ -116,6 +116,9 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 #ifdef CONFIG_INIT_STACKS
 	memset(pStackMem, 0xaa, stackSize);
 #endif
+#ifdef CONFIG_STACK_USAGE
+	((struct tcs *)pStackMem)->stack_size = stackSize;
+#endif
 
 	/* carve the thread entry struct from the "base" of the stack */
 
@@ -150,6 +153,10 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 	tcs->custom_data = NULL;
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	memset(&tcs->runtime, 0, sizeof(tcs->runtime));
+#endif
+
 #ifdef CONFIG_THREAD_MONITOR
 	/*
 	 * In debug mode tcs->entry give direct access to the thread entry
@@ -192,12 +192,19 @@ struct tcs {
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	void *custom_data;     /* available for custom use */
 #endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	struct k_thread_runtime_stats runtime;
+#endif
 	struct coop coopReg;
 	struct preempt preempReg;
 #if defined(CONFIG_THREAD_MONITOR)
 	struct __thread_entry *entry; /* thread entry and parameters description */
 	struct tcs *next_thread; /* next item in list of ALL fiber+tasks */
 #endif
+#ifdef CONFIG_STACK_USAGE
+	unsigned int stack_size; /* size of the stack area, TCS included */
+#endif
 #if !defined(CONFIG_KERNEL_V2) && defined(CONFIG_NANO_TIMEOUTS)
 	struct _nano_timeout nano_timeout;
 #endif
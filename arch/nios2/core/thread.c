@@ -89,6 +89,9 @@ void _new_thread(char *stack_memory, unsigned stack_size,
 
 #ifdef CONFIG_INIT_STACKS
 	memset(stack_memory, 0xaa, stack_size);
+#endif
+#ifdef CONFIG_STACK_USAGE
+	((struct tcs *)stack_memory)->stack_size = stack_size;
 #endif
 	/* Initial stack frame data, stored at the base of the stack */
 	iframe = (struct init_stack_frame *)
@@ -126,6 +126,9 @@ struct tcs {
 	struct __thread_entry *entry; /* thread entry and parameters description */
 	struct tcs *next_thread; /* next item in list of ALL fiber+tasks */
 #endif
+#ifdef CONFIG_STACK_USAGE
+	unsigned int stack_size; /* size of the stack area, TCS included */
+#endif
 #ifdef CONFIG_MICROKERNEL
 	void *uk_task_ptr;
 #endif
@@ -111,6 +111,10 @@ static void _new_thread_internal(char *pStackMem, unsigned stackSize,
 	tcs->custom_data = NULL;
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	memset(&tcs->runtime, 0, sizeof(tcs->runtime));
+#endif
+
 #if !defined(CONFIG_KERNEL_V2) && defined(CONFIG_MICROKERNEL)
 	tcs->uk_task_ptr = uk_task_ptr;
 #else
@@ -340,6 +344,9 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 #ifdef CONFIG_INIT_STACKS
 	memset(pStackMem, 0xaa, stackSize);
 #endif
+#ifdef CONFIG_STACK_USAGE
+	((struct tcs *)pStackMem)->stack_size = stackSize;
+#endif
 
 	/* carve the thread entry struct from the "base" of the stack */
 
@@ -687,6 +687,9 @@ struct tcs {
 	struct __thread_entry *entry; /* thread entry and parameters description */
 	struct tcs *next_thread; /* next item in list of ALL fiber+tasks */
 #endif
+#ifdef CONFIG_STACK_USAGE
+	unsigned int stack_size; /* size of the stack area, TCS included */
+#endif
 #ifdef CONFIG_GDB_INFO
 	void *esfPtr; /* pointer to exception stack frame saved by */
 		      /* outermost exception wrapper */
@@ -704,6 +707,10 @@ struct tcs {
 	void *custom_data;     /* available for custom use */
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	struct k_thread_runtime_stats runtime;
+#endif
+
 #if !defined(CONFIG_KERNEL_V2) && defined(CONFIG_NANO_TIMEOUTS)
 	struct _nano_timeout nano_timeout;
 #endif
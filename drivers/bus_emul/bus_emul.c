@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <nanokernel.h>
+#include <device.h>
+#include <misc/util.h>
+
+#include "bus_emul_priv.h"
+
+void bus_emul_init_data(struct bus_emul_data *bus)
+{
+	nano_sem_init(&bus->sem);
+	nano_sem_give(&bus->sem);
+
+	sys_slist_init(&bus->models);
+}
+
+struct bus_emul_model *bus_emul_find(struct bus_emul_data *bus,
+				     uint32_t addr)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&bus->models, node) {
+		struct bus_emul_model *model =
+			CONTAINER_OF(node, struct bus_emul_model, node);
+
+		if (model->addr == addr) {
+			return model;
+		}
+	}
+
+	return NULL;
+}
+
+int bus_emul_attach(struct device *dev, struct bus_emul_model *model)
+{
+	struct bus_emul_data *bus = dev->driver_data;
+	int ret = 0;
+
+	nano_sem_take(&bus->sem, TICKS_UNLIMITED);
+
+	if (bus_emul_find(bus, model->addr)) {
+		ret = -EBUSY;
+	} else {
+		if (model->api->reset) {
+			model->api->reset(model);
+		}
+
+		sys_slist_append(&bus->models, &model->node);
+	}
+
+	nano_sem_give(&bus->sem);
+
+	return ret;
+}
+
+void bus_emul_get_stats(struct device *dev, struct bus_emul_stats *stats)
+{
+	struct bus_emul_data *bus = dev->driver_data;
+
+	nano_sem_take(&bus->sem, TICKS_UNLIMITED);
+	*stats = bus->stats;
+	nano_sem_give(&bus->sem);
+}
+
+void bus_emul_reset_stats(struct device *dev)
+{
+	struct bus_emul_data *bus = dev->driver_data;
+
+	nano_sem_take(&bus->sem, TICKS_UNLIMITED);
+	memset(&bus->stats, 0, sizeof(bus->stats));
+	nano_sem_give(&bus->sem);
+}
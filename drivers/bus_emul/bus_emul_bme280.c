@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * BME280 model: chip id, calibration, control and data registers. The
+ * calibration is the one of the compensation example in the datasheet.
+ */
+
+#include <string.h>
+
+#include <nanokernel.h>
+#include <misc/util.h>
+
+#include "bus_emul_priv.h"
+
+#define REG_CALIB00		0x88
+#define REG_DIG_H1		0xA1
+#define REG_ID			0xD0
+#define REG_RESET		0xE0
+#define REG_CALIB26		0xE1
+#define REG_CTRL_HUM		0xF2
+#define REG_CTRL_MEAS		0xF4
+#define REG_CONFIG		0xF5
+#define REG_PRESS_MSB		0xF7
+#define REG_TEMP_MSB		0xFA
+#define REG_HUM_MSB		0xFD
+
+#define CHIP_ID			0x60
+#define RESET_CMD		0xB6
+
+#define NUM_REGS		256
+
+/* dig_T1..dig_P9, little endian */
+static const uint16_t bme280_calib[] = {
+	27504, 26435, (uint16_t)-1000,
+	36477, (uint16_t)-10685, 3024, 2855, 140, (uint16_t)-7, 15500,
+	(uint16_t)-14600, 6000,
+};
+
+/* dig_H2..dig_H6, packed as in the device: H4 313, H5 50 */
+static const uint8_t bme280_calib_hum[] = {
+	0x6a, 0x01, 0x00, 0x13, 0x29, 0x03, 0x1e,
+};
+
+#define DIG_H1			75
+
+static uint8_t bme280_regs[NUM_REGS];
+
+static void bme280_reset(struct bus_emul_model *model)
+{
+	int i;
+
+	memset(&bme280_regs[REG_CALIB00], 0, REG_PRESS_MSB - REG_CALIB00);
+
+	for (i = 0; i < ARRAY_SIZE(bme280_calib); i++) {
+		bme280_regs[REG_CALIB00 + 2 * i] = bme280_calib[i] & 0xff;
+		bme280_regs[REG_CALIB00 + 2 * i + 1] = bme280_calib[i] >> 8;
+	}
+
+	bme280_regs[REG_DIG_H1] = DIG_H1;
+	memcpy(&bme280_regs[REG_CALIB26], bme280_calib_hum,
+	       sizeof(bme280_calib_hum));
+	bme280_regs[REG_ID] = CHIP_ID;
+}
+
+static int bme280_read(struct bus_emul_model *model, uint8_t reg,
+		       uint8_t *buf, uint32_t len)
+{
+	uint32_t i;
+
+	/* the address auto-increments and wraps around */
+	for (i = 0; i < len; i++) {
+		buf[i] = bme280_regs[reg++];
+	}
+
+	return 0;
+}
+
+static int bme280_write(struct bus_emul_model *model, uint8_t reg,
+			const uint8_t *buf, uint32_t len)
+{
+	uint32_t i;
+
+	/* writes are register address and data pairs */
+	for (i = 0; i < len; i += 2) {
+		switch (reg) {
+		case REG_RESET:
+			if (buf[i] == RESET_CMD) {
+				bme280_reset(model);
+			}
+			break;
+		case REG_CTRL_HUM:
+		case REG_CTRL_MEAS:
+		case REG_CONFIG:
+			bme280_regs[reg] = buf[i];
+			break;
+		default:
+			break;
+		}
+
+		if (i + 1 < len) {
+			reg = buf[i + 1];
+		}
+	}
+
+	return 0;
+}
+
+static const struct bus_emul_model_api bme280_api = {
+	.reset = bme280_reset,
+	.read = bme280_read,
+	.write = bme280_write,
+};
+
+struct bus_emul_model bus_emul_bme280_model = {
+	.addr = CONFIG_BUS_EMUL_BME280_ADDR,
+	.api = &bme280_api,
+};
+
+void bus_emul_bme280_set_adc(uint32_t temp, uint32_t press, uint16_t hum)
+{
+	int key = irq_lock();
+
+	/* 20 bit values, left aligned over three registers */
+	bme280_regs[REG_PRESS_MSB] = press >> 12;
+	bme280_regs[REG_PRESS_MSB + 1] = press >> 4;
+	bme280_regs[REG_PRESS_MSB + 2] = (press & 0xf) << 4;
+	bme280_regs[REG_TEMP_MSB] = temp >> 12;
+	bme280_regs[REG_TEMP_MSB + 1] = temp >> 4;
+	bme280_regs[REG_TEMP_MSB + 2] = (temp & 0xf) << 4;
+	bme280_regs[REG_HUM_MSB] = hum >> 8;
+	bme280_regs[REG_HUM_MSB + 1] = hum & 0xff;
+
+	irq_unlock(key);
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * BMI160 model: the registers its driver uses at init time, the power mode
+ * commands, the data registers and the headerless FIFO.
+ */
+
+#include <string.h>
+
+#include <nanokernel.h>
+#include <misc/util.h>
+
+#include "bus_emul_priv.h"
+
+#define REG_CHIPID		0x00
+#define REG_PMU_STATUS		0x03
+#define REG_DATA_GYR_X		0x0C
+#define REG_FIFO_LENGTH0	0x22
+#define REG_FIFO_LENGTH1	0x23
+#define REG_FIFO_DATA		0x24
+#define REG_FIFO_CONFIG1	0x47
+#define REG_CMD			0x7E
+#define NUM_REGS		0x80
+
+#define CHIP_ID			0xD1
+#define FIFO_SIZE		1024
+#define DATA_SIZE		12
+
+#define FIFO_GYR_EN		BIT(7)
+#define FIFO_ACC_EN		BIT(6)
+
+#define CMD_PMU_ACC		0x10
+#define CMD_PMU_GYR		0x14
+#define CMD_PMU_MAG		0x18
+#define CMD_FIFO_FLUSH		0xB0
+#define CMD_SOFT_RESET		0xB6
+
+/* byte read from an empty FIFO */
+#define FIFO_EMPTY		0x80
+
+static struct {
+	uint8_t regs[NUM_REGS];
+	/* gyro and accelerometer sample, kept over a soft reset */
+	uint8_t data[DATA_SIZE];
+	uint8_t fifo[FIFO_SIZE];
+	uint16_t fifo_head;
+	uint16_t fifo_len;
+} bmi160;
+
+static void bmi160_reset(struct bus_emul_model *model)
+{
+	memset(bmi160.regs, 0, sizeof(bmi160.regs));
+	bmi160.regs[REG_CHIPID] = CHIP_ID;
+	memcpy(&bmi160.regs[REG_DATA_GYR_X], bmi160.data, DATA_SIZE);
+
+	bmi160.fifo_head = 0;
+	bmi160.fifo_len = 0;
+}
+
+static void bmi160_cmd(struct bus_emul_model *model, uint8_t cmd)
+{
+	uint8_t *pmu = &bmi160.regs[REG_PMU_STATUS];
+
+	if (cmd == CMD_SOFT_RESET) {
+		bmi160_reset(model);
+	} else if (cmd == CMD_FIFO_FLUSH) {
+		bmi160.fifo_len = 0;
+	} else if ((cmd & ~0x3) == CMD_PMU_ACC) {
+		*pmu = (*pmu & ~(0x3 << 4)) | ((cmd & 0x3) << 4);
+	} else if ((cmd & ~0x3) == CMD_PMU_GYR) {
+		*pmu = (*pmu & ~(0x3 << 2)) | ((cmd & 0x3) << 2);
+	} else if ((cmd & ~0x3) == CMD_PMU_MAG) {
+		*pmu = (*pmu & ~0x3) | (cmd & 0x3);
+	}
+}
+
+static uint8_t bmi160_fifo_pop(void)
+{
+	uint8_t byte;
+
+	if (!bmi160.fifo_len) {
+		return FIFO_EMPTY;
+	}
+
+	byte = bmi160.fifo[bmi160.fifo_head];
+	bmi160.fifo_head = (bmi160.fifo_head + 1) % FIFO_SIZE;
+	bmi160.fifo_len--;
+
+	return byte;
+}
+
+static int bmi160_read(struct bus_emul_model *model, uint8_t reg,
+		       uint8_t *buf, uint32_t len)
+{
+	uint32_t i;
+
+	bmi160.regs[REG_FIFO_LENGTH0] = bmi160.fifo_len & 0xff;
+	bmi160.regs[REG_FIFO_LENGTH1] = bmi160.fifo_len >> 8;
+
+	for (i = 0; i < len; i++) {
+		/* FIFO_DATA does not auto-increment */
+		if (reg == REG_FIFO_DATA) {
+			buf[i] = bmi160_fifo_pop();
+		} else if (reg < NUM_REGS) {
+			buf[i] = bmi160.regs[reg++];
+		} else {
+			buf[i] = 0;
+		}
+	}
+
+	return 0;
+}
+
+static int bmi160_write(struct bus_emul_model *model, uint8_t reg,
+			const uint8_t *buf, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len && reg < NUM_REGS; i++, reg++) {
+		if (reg == REG_CMD) {
+			bmi160_cmd(model, buf[i]);
+		} else {
+			bmi160.regs[reg] = buf[i];
+		}
+	}
+
+	return 0;
+}
+
+static const struct bus_emul_model_api bmi160_api = {
+	.reset = bmi160_reset,
+	.read = bmi160_read,
+	.write = bmi160_write,
+};
+
+struct bus_emul_model bus_emul_bmi160_model = {
+	.addr = CONFIG_BUS_EMUL_BMI160_SLAVE,
+	.api = &bmi160_api,
+};
+
+static void bmi160_put_axes(uint8_t *buf, const int16_t val[3])
+{
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		buf[2 * i] = (uint16_t)val[i] & 0xff;
+		buf[2 * i + 1] = (uint16_t)val[i] >> 8;
+	}
+}
+
+void bus_emul_bmi160_set_sample(const int16_t gyro[3],
+				const int16_t accel[3])
+{
+	int key = irq_lock();
+
+	bmi160_put_axes(bmi160.data, gyro);
+	bmi160_put_axes(bmi160.data + 6, accel);
+	memcpy(&bmi160.regs[REG_DATA_GYR_X], bmi160.data, DATA_SIZE);
+
+	irq_unlock(key);
+}
+
+int bus_emul_bmi160_fifo_fill(int samples, int seq)
+{
+	uint8_t config = bmi160.regs[REG_FIFO_CONFIG1];
+	uint8_t frame[DATA_SIZE];
+	int frame_size = 0;
+	int i, j, key;
+
+	if (!(config & (FIFO_GYR_EN | FIFO_ACC_EN))) {
+		return 0;
+	}
+
+	key = irq_lock();
+
+	for (i = 0; i < samples; i++, seq++) {
+		int16_t gyro[3], accel[3];
+
+		for (j = 0; j < 3; j++) {
+			gyro[j] = bus_emul_bmi160_gyro(seq, j);
+			accel[j] = bus_emul_bmi160_accel(seq, j);
+		}
+
+		frame_size = 0;
+
+		if (config & FIFO_GYR_EN) {
+			bmi160_put_axes(frame, gyro);
+			frame_size += 6;
+		}
+
+		if (config & FIFO_ACC_EN) {
+			bmi160_put_axes(frame + frame_size, accel);
+			frame_size += 6;
+		}
+
+		if (bmi160.fifo_len + frame_size > FIFO_SIZE) {
+			break;
+		}
+
+		for (j = 0; j < frame_size; j++) {
+			bmi160.fifo[(bmi160.fifo_head + bmi160.fifo_len++) %
+				    FIFO_SIZE] = frame[j];
+		}
+	}
+
+	irq_unlock(key);
+
+	return i;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * HTS221 model: identification, control, output and calibration
+ * registers.
+ */
+
+#include <string.h>
+
+#include <nanokernel.h>
+#include <misc/util.h>
+
+#include "bus_emul_priv.h"
+
+#define REG_WHO_AM_I		0x0F
+#define REG_AV_CONF		0x10
+#define REG_CTRL1		0x20
+#define REG_CTRL3		0x22
+#define REG_STATUS		0x27
+#define REG_HUMIDITY_OUT_L	0x28
+#define REG_TEMP_OUT_L		0x2A
+#define REG_CALIB_START		0x30
+
+#define CHIP_ID			0xBC
+#define AUTOINCREMENT_ADDR	BIT(7)
+#define STATUS_H_DA_T_DA	0x03
+
+#define NUM_REGS		0x40
+
+/*
+ * H0_rH_x2 40, H1_rH_x2 160, T0_degC_x8 80, T1_degC_x8 320, H0_T0_OUT 0,
+ * H1_T0_OUT 6000, T0_OUT 0, T1_OUT 3000
+ */
+static const uint8_t hts221_calib[] = {
+	40, 160, 0x50, 0x40, 0x00, 0x04, 0x00, 0x00,
+	0x00, 0x00, 0x70, 0x17, 0x00, 0x00, 0xb8, 0x0b,
+};
+
+static uint8_t hts221_regs[NUM_REGS];
+
+static void hts221_reset(struct bus_emul_model *model)
+{
+	memset(hts221_regs, 0, REG_STATUS);
+	hts221_regs[REG_WHO_AM_I] = CHIP_ID;
+	memcpy(&hts221_regs[REG_CALIB_START], hts221_calib,
+	       sizeof(hts221_calib));
+}
+
+static int hts221_read(struct bus_emul_model *model, uint8_t reg,
+		       uint8_t *buf, uint32_t len)
+{
+	int inc = !!(reg & AUTOINCREMENT_ADDR);
+	uint32_t i;
+
+	reg &= ~AUTOINCREMENT_ADDR;
+
+	for (i = 0; i < len; i++, reg += inc) {
+		buf[i] = reg < NUM_REGS ? hts221_regs[reg] : 0;
+	}
+
+	return 0;
+}
+
+static int hts221_write(struct bus_emul_model *model, uint8_t reg,
+			const uint8_t *buf, uint32_t len)
+{
+	int inc = !!(reg & AUTOINCREMENT_ADDR);
+	uint32_t i;
+
+	reg &= ~AUTOINCREMENT_ADDR;
+
+	for (i = 0; i < len; i++, reg += inc) {
+		if (reg == REG_AV_CONF ||
+		    (reg >= REG_CTRL1 && reg <= REG_CTRL3)) {
+			hts221_regs[reg] = buf[i];
+		}
+	}
+
+	return 0;
+}
+
+static const struct bus_emul_model_api hts221_api = {
+	.reset = hts221_reset,
+	.read = hts221_read,
+	.write = hts221_write,
+};
+
+struct bus_emul_model bus_emul_hts221_model = {
+	.addr = CONFIG_BUS_EMUL_HTS221_ADDR,
+	.api = &hts221_api,
+};
+
+void bus_emul_hts221_set_out(int16_t hum_out, int16_t temp_out)
+{
+	int key = irq_lock();
+
+	hts221_regs[REG_HUMIDITY_OUT_L] = (uint16_t)hum_out & 0xff;
+	hts221_regs[REG_HUMIDITY_OUT_L + 1] = (uint16_t)hum_out >> 8;
+	hts221_regs[REG_TEMP_OUT_L] = (uint16_t)temp_out & 0xff;
+	hts221_regs[REG_TEMP_OUT_L + 1] = (uint16_t)temp_out >> 8;
+	hts221_regs[REG_STATUS] = STATUS_H_DA_T_DA;
+
+	irq_unlock(key);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BUS_EMUL_PRIV_H__
+#define __BUS_EMUL_PRIV_H__
+
+#include <nanokernel.h>
+#include <misc/slist.h>
+#include <drivers/bus_emul.h>
+
+/* Driver data of the emulated I2C and SPI masters */
+struct bus_emul_data {
+	struct nano_sem sem;
+	sys_slist_t models;
+	struct bus_emul_stats stats;
+	/* SPI slave selected by spi_slave_select() */
+	uint32_t slave;
+};
+
+/* Models enabled in Kconfig, attached by their master at init */
+extern struct bus_emul_model bus_emul_bmi160_model;
+extern struct bus_emul_model bus_emul_bme280_model;
+extern struct bus_emul_model bus_emul_hts221_model;
+
+void bus_emul_init_data(struct bus_emul_data *bus);
+
+/* Must be called with the bus semaphore held */
+struct bus_emul_model *bus_emul_find(struct bus_emul_data *bus,
+				     uint32_t addr);
+
+#endif /* __BUS_EMUL_PRIV_H__ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+
+#include <nanokernel.h>
+#include <device.h>
+#include <init.h>
+#include <i2c.h>
+
+#include "bus_emul_priv.h"
+
+static struct bus_emul_data i2c_emul_data;
+
+static int i2c_emul_configure(struct device *dev, uint32_t dev_config)
+{
+	return 0;
+}
+
+static int i2c_emul_transfer(struct device *dev, struct i2c_msg *msgs,
+			     uint8_t num_msgs, uint16_t addr)
+{
+	struct bus_emul_data *bus = dev->driver_data;
+	struct bus_emul_model *model;
+	bool set_reg = true;
+	uint8_t reg = 0;
+	int ret = 0;
+	int i;
+
+	nano_sem_take(&bus->sem, TICKS_UNLIMITED);
+
+	bus->stats.transfers++;
+
+	model = bus_emul_find(bus, addr);
+	if (!model) {
+		bus->stats.nacks++;
+		ret = -EIO;
+		goto out;
+	}
+
+	for (i = 0; i < num_msgs && !ret; i++) {
+		struct i2c_msg *msg = &msgs[i];
+		uint8_t *buf = msg->buf;
+		uint32_t len = msg->len;
+
+		bus->stats.messages++;
+		bus->stats.bytes += len;
+
+		/* the slave address goes out on every (repeated) start */
+		if (!i || (msg->flags & I2C_MSG_RESTART)) {
+			bus->stats.bytes++;
+			set_reg = true;
+		}
+
+		if ((msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_READ) {
+			ret = model->api->read(model, reg, buf, len);
+			reg += len;
+			continue;
+		}
+
+		/* the first byte written after a start is the register */
+		if (set_reg && len) {
+			reg = *buf++;
+			len--;
+			set_reg = false;
+		}
+
+		if (len) {
+			ret = model->api->write(model, reg, buf, len);
+			reg += len;
+		}
+	}
+
+out:
+	nano_sem_give(&bus->sem);
+
+	return ret;
+}
+
+static struct i2c_driver_api i2c_emul_api = {
+	.configure = i2c_emul_configure,
+	.transfer = i2c_emul_transfer,
+};
+
+static int i2c_emul_init(struct device *dev)
+{
+	bus_emul_init_data(dev->driver_data);
+
+#ifdef CONFIG_BUS_EMUL_BME280
+	bus_emul_attach(dev, &bus_emul_bme280_model);
+#endif
+#ifdef CONFIG_BUS_EMUL_HTS221
+	bus_emul_attach(dev, &bus_emul_hts221_model);
+#endif
+
+	dev->driver_api = &i2c_emul_api;
+
+	return 0;
+}
+
+DEVICE_INIT(i2c_emul, CONFIG_I2C_EMUL_NAME, i2c_emul_init, &i2c_emul_data,
+	    NULL, PRIMARY, CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
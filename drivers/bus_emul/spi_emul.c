@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+
+#include <nanokernel.h>
+#include <device.h>
+#include <init.h>
+#include <spi.h>
+#include <misc/util.h>
+
+#include "bus_emul_priv.h"
+
+static struct bus_emul_data spi_emul_data;
+
+static int spi_emul_configure(struct device *dev, struct spi_config *config)
+{
+	return 0;
+}
+
+static int spi_emul_slave_select(struct device *dev, uint32_t slave)
+{
+	struct bus_emul_data *bus = dev->driver_data;
+
+	bus->slave = slave;
+
+	return 0;
+}
+
+static int spi_emul_transceive(struct device *dev,
+			       const void *tx_buf, uint32_t tx_buf_len,
+			       void *rx_buf, uint32_t rx_buf_len)
+{
+	struct bus_emul_data *bus = dev->driver_data;
+	struct bus_emul_model *model;
+	const uint8_t *tx = tx_buf;
+	uint8_t *rx = rx_buf;
+	uint8_t cmd;
+	int ret = 0;
+
+	if (!tx_buf_len) {
+		return -EINVAL;
+	}
+
+	nano_sem_take(&bus->sem, TICKS_UNLIMITED);
+
+	bus->stats.transfers++;
+	bus->stats.messages++;
+	bus->stats.bytes += max(tx_buf_len, rx_buf_len);
+
+	model = bus_emul_find(bus, bus->slave);
+	if (!model) {
+		bus->stats.nacks++;
+		ret = -EIO;
+		goto out;
+	}
+
+	/*
+	 * The first byte is the register address, with bit 7 set for reads.
+	 * rx may be tx, so tx is not looked at past it for reads.
+	 */
+	cmd = tx[0];
+
+	if (cmd & BIT(7)) {
+		if (rx_buf_len > 1) {
+			ret = model->api->read(model, cmd & 0x7f, rx + 1,
+					       rx_buf_len - 1);
+		}
+	} else if (tx_buf_len > 1) {
+		ret = model->api->write(model, cmd, tx + 1, tx_buf_len - 1);
+	}
+
+out:
+	nano_sem_give(&bus->sem);
+
+	return ret;
+}
+
+static struct spi_driver_api spi_emul_api = {
+	.configure = spi_emul_configure,
+	.slave_select = spi_emul_slave_select,
+	.transceive = spi_emul_transceive,
+};
+
+static int spi_emul_init(struct device *dev)
+{
+	bus_emul_init_data(dev->driver_data);
+
+#ifdef CONFIG_BUS_EMUL_BMI160
+	bus_emul_attach(dev, &bus_emul_bmi160_model);
+#endif
+
+	dev->driver_api = &spi_emul_api;
+
+	return 0;
+}
+
+DEVICE_INIT(spi_emul, CONFIG_SPI_EMUL_NAME, spi_emul_init, &spi_emul_data,
+	    NULL, PRIMARY, CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
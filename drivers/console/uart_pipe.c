@@ -36,6 +36,60 @@ static size_t recv_buf_len;
 static uart_pipe_recv_cb app_cb;
 static size_t recv_off;
 
+#ifdef CONFIG_UART_PIPE_ASYNC
+/*
+ * Shorter sends are polled out, waiting for the interrupt would take
+ * longer than the bytes take on the line
+ */
+#define ASYNC_TX_MIN 8
+
+static uint8_t rx_ring[CONFIG_UART_PIPE_ASYNC_RX_RING_SIZE];
+static struct nano_sem tx_sem;
+static int async;
+
+static void uart_pipe_async_cb(struct device *dev, uint32_t events)
+{
+	if (events & UART_ASYNC_TX_DONE) {
+		nano_isr_sem_give(&tx_sem);
+	}
+
+	if (!(events & (UART_ASYNC_RX_READY | UART_ASYNC_RX_IDLE))) {
+		return;
+	}
+
+	/* One callback per FIFO worth of data instead of per byte */
+	while (recv_off < recv_buf_len) {
+		int rx = uart_async_read(dev, recv_buf + recv_off,
+					 recv_buf_len - recv_off);
+
+		if (rx <= 0) {
+			break;
+		}
+
+		recv_off += rx;
+		recv_buf = app_cb(recv_buf, &recv_off);
+	}
+}
+
+static int uart_pipe_async_setup(struct device *uart)
+{
+	nano_sem_init(&tx_sem);
+
+	if (uart_async_callback_set(uart, uart_pipe_async_cb)) {
+		return -ENOTSUP;
+	}
+
+	if (uart_async_rx_enable(uart, rx_ring, sizeof(rx_ring), 1)) {
+		uart_async_callback_set(uart, NULL);
+		return -ENOTSUP;
+	}
+
+	async = 1;
+
+	return 0;
+}
+#endif /* CONFIG_UART_PIPE_ASYNC */
+
 static void uart_pipe_isr(struct device *unused)
 {
 	ARG_UNUSED(unused);
@@ -65,6 +119,19 @@ static void uart_pipe_isr(struct device *unused)
 
 int uart_pipe_send(const uint8_t *data, int len)
 {
+#ifdef CONFIG_UART_PIPE_ASYNC
+	if (async && len >= ASYNC_TX_MIN) {
+		int ret = uart_async_tx(uart_pipe_dev, data, len);
+
+		if (ret) {
+			return ret;
+		}
+
+		nano_sem_take(&tx_sem, TICKS_UNLIMITED);
+		return 0;
+	}
+#endif
+
 	while (len--)  {
 		uart_poll_out(uart_pipe_dev, *data++);
 	}
@@ -84,6 +151,12 @@ static void uart_pipe_setup(struct device *uart)
 		continue;
 	}
 
+#ifdef CONFIG_UART_PIPE_ASYNC
+	if (!uart_pipe_async_setup(uart)) {
+		return;
+	}
+#endif
+
 	uart_irq_callback_set(uart, uart_pipe_isr);
 
 	uart_irq_rx_enable(uart);
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+
+#include <nanokernel.h>
+#include <device.h>
+#include <init.h>
+#include <flash.h>
+#include <string.h>
+#include <toolchain.h>
+#include <misc/util.h>
+#include <drivers/flash_simulator.h>
+
+#define FLASH_SIM_SIZE CONFIG_FLASH_SIMULATOR_SIZE
+#define FLASH_SIM_ERASE_UNIT CONFIG_FLASH_SIMULATOR_ERASE_UNIT
+#define FLASH_SIM_PAGE_SIZE CONFIG_FLASH_SIMULATOR_PAGE_SIZE
+#define FLASH_SIM_UNITS (FLASH_SIM_SIZE / FLASH_SIM_ERASE_UNIT)
+
+#define FLASH_SIM_ERASED 0xff
+
+BUILD_ASSERT(FLASH_SIM_SIZE % FLASH_SIM_ERASE_UNIT == 0);
+BUILD_ASSERT(FLASH_SIM_ERASE_UNIT % FLASH_SIM_PAGE_SIZE == 0);
+
+struct flash_sim_data {
+	struct nano_sem sem;
+	bool write_enabled;
+	struct flash_simulator_stats stats;
+	uint32_t erase_counts[FLASH_SIM_UNITS];
+	uint8_t mem[FLASH_SIM_SIZE];
+};
+
+static struct flash_sim_data flash_sim_data;
+
+static inline bool is_range_valid(off_t offset, size_t len)
+{
+	return offset >= 0 && len <= FLASH_SIM_SIZE &&
+	       offset <= FLASH_SIM_SIZE - len;
+}
+
+static int flash_sim_read(struct device *dev, off_t offset, void *data,
+			  size_t len)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+
+	if (!is_range_valid(offset, len)) {
+		return -EINVAL;
+	}
+
+	nano_sem_take(&sim->sem, TICKS_UNLIMITED);
+
+	memcpy(data, sim->mem + offset, len);
+	sim->stats.bytes_read += len;
+
+	nano_sem_give(&sim->sem);
+
+	return 0;
+}
+
+static int flash_sim_write(struct device *dev, off_t offset,
+			   const void *data, size_t len)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+	int ret = 0;
+	size_t i;
+
+	if (!is_range_valid(offset, len)) {
+		return -EINVAL;
+	}
+
+	/* Like page program, a write can not cross a page boundary */
+	if (len > FLASH_SIM_PAGE_SIZE - (offset % FLASH_SIM_PAGE_SIZE)) {
+		return -EINVAL;
+	}
+
+	nano_sem_take(&sim->sem, TICKS_UNLIMITED);
+
+	if (!sim->write_enabled) {
+		sim->stats.protection_errors++;
+		ret = -EACCES;
+		goto out;
+	}
+
+	for (i = 0; i < len; i++) {
+		if (sim->mem[offset + i] != FLASH_SIM_ERASED) {
+			sim->stats.program_errors++;
+			ret = -EIO;
+			goto out;
+		}
+	}
+
+	memcpy(sim->mem + offset, data, len);
+	sim->stats.bytes_written += len;
+
+#ifdef CONFIG_FLASH_SIMULATOR_TIMING
+	sys_thread_busy_wait(CONFIG_FLASH_SIMULATOR_PROGRAM_TIME_US);
+#endif
+
+out:
+	/* Write protection is enabled again after every write */
+	sim->write_enabled = false;
+
+	nano_sem_give(&sim->sem);
+
+	return ret;
+}
+
+static int flash_sim_erase(struct device *dev, off_t offset, size_t size)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+	uint32_t unit;
+	int ret = 0;
+
+	if (!is_range_valid(offset, size) ||
+	    offset % FLASH_SIM_ERASE_UNIT || size % FLASH_SIM_ERASE_UNIT) {
+		return -EINVAL;
+	}
+
+	nano_sem_take(&sim->sem, TICKS_UNLIMITED);
+
+	if (!sim->write_enabled) {
+		sim->stats.protection_errors++;
+		ret = -EACCES;
+		goto out;
+	}
+
+	memset(sim->mem + offset, FLASH_SIM_ERASED, size);
+
+	for (unit = offset / FLASH_SIM_ERASE_UNIT;
+	     unit < (offset + size) / FLASH_SIM_ERASE_UNIT; unit++) {
+		sim->erase_counts[unit]++;
+		sim->stats.erases++;
+
+#ifdef CONFIG_FLASH_SIMULATOR_TIMING
+		sys_thread_busy_wait(CONFIG_FLASH_SIMULATOR_ERASE_TIME_US);
+#endif
+	}
+
+out:
+	sim->write_enabled = false;
+
+	nano_sem_give(&sim->sem);
+
+	return ret;
+}
+
+static int flash_sim_write_protection(struct device *dev, bool enable)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+
+	sim->write_enabled = !enable;
+
+	return 0;
+}
+
+void flash_simulator_get_stats(struct device *dev,
+			       struct flash_simulator_stats *stats)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+	uint32_t i;
+
+	nano_sem_take(&sim->sem, TICKS_UNLIMITED);
+
+	*stats = sim->stats;
+	stats->min_erase_count = sim->erase_counts[0];
+	stats->max_erase_count = sim->erase_counts[0];
+
+	for (i = 1; i < FLASH_SIM_UNITS; i++) {
+		stats->min_erase_count = min(stats->min_erase_count,
+					     sim->erase_counts[i]);
+		stats->max_erase_count = max(stats->max_erase_count,
+					     sim->erase_counts[i]);
+	}
+
+	nano_sem_give(&sim->sem);
+}
+
+uint32_t flash_simulator_erase_count(struct device *dev, off_t offset)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+
+	if (!is_range_valid(offset, 1)) {
+		return 0;
+	}
+
+	return sim->erase_counts[offset / FLASH_SIM_ERASE_UNIT];
+}
+
+void flash_simulator_reset_stats(struct device *dev)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+
+	nano_sem_take(&sim->sem, TICKS_UNLIMITED);
+
+	memset(&sim->stats, 0, sizeof(sim->stats));
+	memset(sim->erase_counts, 0, sizeof(sim->erase_counts));
+
+	nano_sem_give(&sim->sem);
+}
+
+static struct flash_driver_api flash_sim_api = {
+	.read = flash_sim_read,
+	.write = flash_sim_write,
+	.erase = flash_sim_erase,
+	.write_protection = flash_sim_write_protection,
+};
+
+static int flash_sim_init(struct device *dev)
+{
+	struct flash_sim_data *const sim = dev->driver_data;
+
+	nano_sem_init(&sim->sem);
+	nano_sem_give(&sim->sem);
+
+	/* The flash starts out erased */
+	memset(sim->mem, FLASH_SIM_ERASED, sizeof(sim->mem));
+
+	dev->driver_api = &flash_sim_api;
+
+	return 0;
+}
+
+DEVICE_INIT(flash_simulator, CONFIG_FLASH_SIMULATOR_DEV_NAME, flash_sim_init,
+	    &flash_sim_data, NULL, SECONDARY,
+	    CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
@@ -16,10 +16,12 @@
 
 #include <errno.h>
 
+#include <nanokernel.h>
 #include <flash.h>
 #include <spi.h>
 #include <init.h>
 #include <string.h>
+#include <misc/util.h>
 #include "spi_flash_w25qxxdv_defs.h"
 #include "spi_flash_w25qxxdv.h"
 
@@ -83,17 +85,52 @@ static int spi_flash_wb_reg_read(struct device *dev, uint8_t *data)
 	return 0;
 }
 
+/* Give up the CPU between status polls while an erase is in progress,
+ * those take tens of milliseconds up to seconds.
+ */
+static void flash_idle_sleep(void)
+{
+	static void (*func[3])(int32_t timeout_in_ticks) = {
+		[NANO_CTX_FIBER] = fiber_sleep,
+		[NANO_CTX_TASK] = task_sleep,
+	};
+
+	if (sys_execution_context_type_get() == NANO_CTX_ISR) {
+		sys_thread_busy_wait(W25QXXDV_BUSY_POLL_US);
+		return;
+	}
+
+	func[sys_execution_context_type_get()](1);
+}
+
 static inline void wait_for_flash_idle(struct device *dev)
 {
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	uint32_t max_spin_cycles = (uint32_t)(
+		(uint64_t)W25QXXDV_PP_MAX_US *
+		(uint64_t)sys_clock_hw_cycles_per_sec /
+		(uint64_t)USEC_PER_SEC
+	);
+	uint32_t start_cycles = sys_cycle_get_32();
 	uint8_t buf[2];
 
 	buf[0] = W25QXXDV_CMD_RDSR;
 	spi_flash_wb_reg_read(dev, buf);
 
 	while (buf[1] & W25QXXDV_WIP_BIT) {
+		/* Only an erase can still be busy past the longest page
+		 * program, spin for anything shorter.
+		 */
+		if (driver_data->erasing ||
+		    sys_cycle_get_32() - start_cycles >= max_spin_cycles) {
+			flash_idle_sleep();
+		}
+
 		buf[0] = W25QXXDV_CMD_RDSR;
 		spi_flash_wb_reg_read(dev, buf);
 	}
+
+	driver_data->erasing = false;
 }
 
 static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
@@ -111,13 +148,58 @@ static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
 	return 0;
 }
 
+static inline void spi_flash_wb_read_header(uint8_t *buf, off_t offset)
+{
+	buf[0] = W25QXXDV_READ_CMD;
+	buf[1] = (uint8_t) (offset >> 16);
+	buf[2] = (uint8_t) (offset >> 8);
+	buf[3] = (uint8_t) offset;
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_FAST_READ
+	buf[4] = 0; /* dummy byte */
+#endif
+}
+
+/* Read a few bytes through a local frame, for reads shorter than a header */
+static int spi_flash_wb_read_small(struct device *dev, off_t offset,
+				   uint8_t *data, size_t len)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	uint8_t buf[2 * W25QXXDV_READ_HEADER_LEN];
+
+	spi_flash_wb_read_header(buf, offset);
+	memset(buf + W25QXXDV_READ_HEADER_LEN, 0, len);
+
+	if (spi_transceive(driver_data->spi, buf,
+			   len + W25QXXDV_READ_HEADER_LEN,
+			   buf, len + W25QXXDV_READ_HEADER_LEN) != 0) {
+		return -EIO;
+	}
+
+	memcpy(data, buf + W25QXXDV_READ_HEADER_LEN, len);
+
+	return 0;
+}
+
+/* Reads stream straight into the caller buffer: the command and address
+ * of each frame are placed in the bytes just in front of the data the
+ * frame receives, so the frame is clocked in place. Frames are issued
+ * from the end of the buffer backwards because each header overwrites
+ * the tail of the frame before it, and the header of the first frame is
+ * filled in last with a small read.
+ */
 static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 			     size_t len)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
-	uint8_t *buf = driver_data->buf;
+	uint8_t *dst = data;
+	uint8_t *frame;
+	size_t frame_len;
+	size_t end = len;
+	size_t start;
+	int ret = 0;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if (offset < 0 || len > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE ||
+	    offset > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE - len) {
 		return -ENODEV;
 	}
 
@@ -130,24 +212,37 @@ static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 
 	wait_for_flash_idle(dev);
 
-	buf[0] = W25QXXDV_CMD_READ;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
+	while (end > W25QXXDV_READ_HEADER_LEN) {
+		if (end - W25QXXDV_READ_HEADER_LEN >
+		    W25QXXDV_MAX_READ_FRAME - W25QXXDV_READ_HEADER_LEN) {
+			start = end - W25QXXDV_MAX_READ_FRAME +
+				W25QXXDV_READ_HEADER_LEN;
+		} else {
+			start = W25QXXDV_READ_HEADER_LEN;
+		}
 
-	memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0, len);
+		frame = dst + start - W25QXXDV_READ_HEADER_LEN;
+		frame_len = end - start + W25QXXDV_READ_HEADER_LEN;
 
-	if (spi_transceive(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS,
-			   buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		nano_sem_give(&driver_data->sem);
-		return -EIO;
+		spi_flash_wb_read_header(frame, offset + start);
+
+		if (spi_transceive(driver_data->spi, frame, frame_len,
+				   frame, frame_len) != 0) {
+			ret = -EIO;
+			goto out;
+		}
+
+		end = start;
 	}
 
-	memcpy(data, buf + W25QXXDV_LEN_CMD_ADDRESS, len);
+	if (spi_flash_wb_read_small(dev, offset, dst, end) != 0) {
+		ret = -EIO;
+	}
 
+out:
 	nano_sem_give(&driver_data->sem);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write(struct device *dev, off_t offset,
@@ -155,8 +250,12 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t *buf = driver_data->buf;
+	const uint8_t *src = data;
+	size_t chunk;
+	int ret = 0;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if (offset < 0 || len > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE ||
+	    offset > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE - len) {
 		return -ENOTSUP;
 	}
 
@@ -177,27 +276,60 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
+	while (len) {
+		/* A page program wraps around at the end of the page */
+		chunk = W25QXXDV_PAGE_SIZE - (offset % W25QXXDV_PAGE_SIZE);
+		chunk = min(chunk, len);
+		chunk = min(chunk, CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN);
+
+		/* Write enable is cleared when each page program completes,
+		 * set it again for the following pages. The flash ignores it
+		 * until the previous page program is done, so wait for that
+		 * and check that it took.
+		 */
+		if (src != data) {
+			wait_for_flash_idle(dev);
+
+			buf[0] = W25QXXDV_CMD_WREN;
+			if (spi_flash_wb_reg_write(dev, buf) != 0) {
+				ret = -EIO;
+				break;
+			}
+
+			buf[0] = W25QXXDV_CMD_RDSR;
+			spi_flash_wb_reg_read(dev, buf);
+
+			if (!(buf[1] & W25QXXDV_WEL_BIT)) {
+				ret = -EIO;
+				break;
+			}
+		}
 
-	buf[0] = W25QXXDV_CMD_PP;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
+		buf[0] = W25QXXDV_CMD_PP;
+		buf[1] = (uint8_t) (offset >> 16);
+		buf[2] = (uint8_t) (offset >> 8);
+		buf[3] = (uint8_t) offset;
 
-	memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, data, len);
+		memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, src, chunk);
 
-	/* Assume write protection has been disabled. Note that w25qxxdv
-	 * flash automatically turns on write protection at the completion
-	 * of each write or erase transaction.
-	 */
-	if (spi_write(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		nano_sem_give(&driver_data->sem);
-		return -EIO;
+		/* Assume write protection has been disabled. Note that w25qxxdv
+		 * flash automatically turns on write protection at the
+		 * completion of each write or erase transaction.
+		 */
+		if (spi_write(driver_data->spi, buf,
+			      chunk + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
+			ret = -EIO;
+			break;
+		}
+
+		src += chunk;
+		offset += chunk;
+		len -= chunk;
 	}
 
 	nano_sem_give(&driver_data->sem);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write_protection_set(struct device *dev, bool enable)
@@ -281,6 +413,8 @@ static inline int spi_flash_wb_erase_internal(struct device *dev,
 	 * flash automatically turns on write protection at the completion
 	 * of each write or erase transaction.
 	 */
+	driver_data->erasing = true;
+
 	return spi_write(driver_data->spi, buf, len);
 }
 
@@ -29,6 +29,7 @@ struct spi_flash_data {
 	uint8_t buf[CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN +
 		    W25QXXDV_LEN_CMD_ADDRESS];
 	struct nano_sem sem;
+	bool erasing;
 };
 
 
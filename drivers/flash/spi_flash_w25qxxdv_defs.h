@@ -70,6 +70,28 @@
 
 #define W25QXXDV_SECTOR_MASK     (0xFFF)
 
+/* page program size */
+#define W25QXXDV_PAGE_SIZE       (0x100)
+
+/* Reads are split into frames of at most this many bytes, the SPI drivers
+ * take 16 bit transfer lengths.
+ */
+#define W25QXXDV_MAX_READ_FRAME  (0x8000)
+
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_FAST_READ
+#define W25QXXDV_READ_CMD        W25QXXDV_CMD_FASTREAD
+#define W25QXXDV_READ_HEADER_LEN (W25QXXDV_LEN_CMD_ADDRESS + 1)
+#else
+#define W25QXXDV_READ_CMD        W25QXXDV_CMD_READ
+#define W25QXXDV_READ_HEADER_LEN (W25QXXDV_LEN_CMD_ADDRESS)
+#endif
+
+/* Longest page program (tPP max), status polls spin for up to this long
+ * before sleeping between them.
+ */
+#define W25QXXDV_PP_MAX_US       (3000)
+#define W25QXXDV_BUSY_POLL_US    (100)
+
 /* ID comands */
 #define W25QXXDV_CMD_RDID        0x9F
 #define W25QXXDV_CMD_RES         0xAB
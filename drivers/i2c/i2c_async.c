@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Queued I2C transactions for drivers without their own queue
+ *
+ * Transactions are run one at a time with the synchronous transfer call
+ * of the driver, by a fiber of their own so that the submitter does not
+ * wait and the system workqueue is not held up by slow buses.
+ */
+
+#include <nanokernel.h>
+#include <init.h>
+#include <i2c.h>
+#include <misc/nano_work.h>
+#include <misc/util.h>
+
+static char __stack i2c_async_stack[CONFIG_I2C_ASYNC_STACK_SIZE];
+
+static const struct fiber_config i2c_async_config = {
+	.stack = i2c_async_stack,
+	.stack_size = sizeof(i2c_async_stack),
+	.prio = CONFIG_I2C_ASYNC_PRIORITY,
+};
+
+static struct nano_workqueue i2c_async_wq;
+
+static void i2c_async_run(struct nano_work *work)
+{
+	struct i2c_transaction *trans =
+		CONTAINER_OF(work, struct i2c_transaction, work);
+	int ret;
+
+	ret = i2c_transfer(trans->dev, trans->msgs, trans->num_msgs,
+			   trans->addr);
+
+	trans->callback(trans->dev, ret, trans->user_data);
+}
+
+int _i2c_async_submit(struct device *dev, struct i2c_transaction *trans)
+{
+	trans->dev = dev;
+
+	nano_work_init(&trans->work, i2c_async_run);
+	nano_work_submit_to_queue(&i2c_async_wq, &trans->work);
+
+	return 0;
+}
+
+static int i2c_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	nano_workqueue_start(&i2c_async_wq, &i2c_async_config);
+
+	return 0;
+}
+
+SYS_INIT(i2c_async_init, PRIMARY, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
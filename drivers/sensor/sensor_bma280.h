@@ -147,6 +147,8 @@ struct bma280_data {
 #elif defined(CONFIG_BMA280_TRIGGER_GLOBAL_FIBER)
 	struct nano_work work;
 	struct device *dev;
+#elif defined(CONFIG_BMA280_TRIGGER_SENSOR_WORKQ)
+	struct sensor_trigger_work trig_work;
 #endif
 
 #endif /* CONFIG_BMA280_TRIGGER */
@@ -74,12 +74,13 @@ static void bma280_gpio_callback(struct device *dev,
 	nano_sem_give(&drv_data->gpio_sem);
 #elif defined(CONFIG_BMA280_TRIGGER_GLOBAL_FIBER)
 	nano_work_submit(&drv_data->work);
+#elif defined(CONFIG_BMA280_TRIGGER_SENSOR_WORKQ)
+	sensor_trigger_work_submit(&drv_data->trig_work);
 #endif
 }
 
-static void bma280_fiber_cb(void *arg)
+static void bma280_fiber_cb(struct device *dev)
 {
-	struct device *dev = arg;
 	struct bma280_data *drv_data = dev->driver_data;
 	uint8_t status = 0;
 
@@ -270,6 +271,9 @@ int bma280_init_interrupt(struct device *dev)
 #elif defined(CONFIG_BMA280_TRIGGER_GLOBAL_FIBER)
 	drv_data->work.handler = bma280_work_cb;
 	drv_data->dev = dev;
+#elif defined(CONFIG_BMA280_TRIGGER_SENSOR_WORKQ)
+	sensor_trigger_work_init(&drv_data->trig_work, dev, bma280_fiber_cb,
+				 CONFIG_BMA280_TRIGGER_WORKQ_LEVEL);
 #endif
 
 	gpio_pin_enable_callback(drv_data->gpio, CONFIG_BMA280_GPIO_PIN_NUM);
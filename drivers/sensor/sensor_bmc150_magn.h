@@ -126,7 +126,9 @@ struct bmc150_magn_data {
 	struct device *i2c_master;
 	struct nano_sem sem;
 
-#if defined(CONFIG_BMC150_MAGN_TRIGGER)
+#if defined(CONFIG_BMC150_MAGN_TRIGGER_SENSOR_WORKQ)
+	struct sensor_trigger_work trig_work;
+#elif defined(CONFIG_BMC150_MAGN_TRIGGER)
 	char __stack fiber_stack[CONFIG_BMC150_MAGN_TRIGGER_FIBER_STACK];
 #endif
 
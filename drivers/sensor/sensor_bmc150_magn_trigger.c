@@ -77,33 +77,46 @@ static void bmc150_magn_gpio_drdy_callback(struct device *dev,
 
 	gpio_pin_disable_callback(dev, config->gpio_drdy_int_pin);
 
+#ifdef CONFIG_BMC150_MAGN_TRIGGER_SENSOR_WORKQ
+	sensor_trigger_work_submit(&data->trig_work);
+#else
 	nano_isr_sem_give(&data->sem);
+#endif
 }
 
-static void bmc150_magn_fiber_main(int arg1, int gpio_pin)
+static void bmc150_magn_handle_int(struct device *dev)
 {
-	struct device *dev = (struct device *) arg1;
 	struct bmc150_magn_data *data = dev->driver_data;
 	const struct bmc150_magn_config *config = dev->config->config_info;
 	uint8_t reg_val;
 
-	while (1) {
-		nano_fiber_sem_take(&data->sem, TICKS_UNLIMITED);
+	while (i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
+				 BMC150_MAGN_REG_INT_STATUS, &reg_val) < 0) {
+		SYS_LOG_DBG("failed to clear data ready interrupt");
+	}
 
-		while (i2c_reg_read_byte(data->i2c_master,
-					 config->i2c_slave_addr,
-					 BMC150_MAGN_REG_INT_STATUS,
-					 &reg_val) < 0) {
-			SYS_LOG_DBG("failed to clear data ready interrupt");
-		}
+	if (data->handler_drdy) {
+		data->handler_drdy(dev, &data->trigger_drdy);
+	}
 
-		if (data->handler_drdy) {
-			data->handler_drdy(dev, &data->trigger_drdy);
-		}
+	gpio_pin_enable_callback(data->gpio_drdy, config->gpio_drdy_int_pin);
+}
 
-		gpio_pin_enable_callback(data->gpio_drdy, gpio_pin);
+#ifndef CONFIG_BMC150_MAGN_TRIGGER_SENSOR_WORKQ
+static void bmc150_magn_fiber_main(int arg1, int unused)
+{
+	struct device *dev = (struct device *) arg1;
+	struct bmc150_magn_data *data = dev->driver_data;
+
+	ARG_UNUSED(unused);
+
+	while (1) {
+		nano_fiber_sem_take(&data->sem, TICKS_UNLIMITED);
+
+		bmc150_magn_handle_int(dev);
 	}
 }
+#endif
 
 static int bmc150_magn_set_drdy_polarity(struct device *dev, int state)
 {
@@ -143,12 +156,17 @@ int bmc150_magn_init_interrupt(struct device *dev)
 
 	data->handler_drdy = NULL;
 
+#ifdef CONFIG_BMC150_MAGN_TRIGGER_SENSOR_WORKQ
+	sensor_trigger_work_init(&data->trig_work, dev,
+				 bmc150_magn_handle_int,
+				 CONFIG_BMC150_MAGN_TRIGGER_WORKQ_LEVEL);
+#else
 	nano_sem_init(&data->sem);
 
 	task_fiber_start(data->fiber_stack,
 			 CONFIG_BMC150_MAGN_TRIGGER_FIBER_STACK,
-			 bmc150_magn_fiber_main, (int) dev,
-			 config->gpio_drdy_int_pin, 10, 0);
+			 bmc150_magn_fiber_main, (int) dev, 0, 10, 0);
+#endif
 
 	data->gpio_drdy = device_get_binding(config->gpio_drdy_dev_name);
 	if (!data->gpio_drdy) {
@@ -214,6 +214,9 @@ struct bmg160_device_data {
 	struct nano_work work;
 	struct device *dev;
 #endif
+#ifdef CONFIG_BMG160_TRIGGER_SENSOR_WORKQ
+	struct sensor_trigger_work trig_work;
+#endif
 #ifdef CONFIG_BMG160_TRIGGER
 	sensor_trigger_handler_t anymotion_handler;
 	sensor_trigger_handler_t drdy_handler;
@@ -35,6 +35,8 @@ static void bmg160_gpio_callback(struct device *port, struct gpio_callback *cb,
 	nano_isr_sem_give(&bmg160->trig_sem);
 #elif defined(CONFIG_BMG160_TRIGGER_GLOBAL_FIBER)
 	nano_work_submit(&bmg160->work);
+#elif defined(CONFIG_BMG160_TRIGGER_SENSOR_WORKQ)
+	sensor_trigger_work_submit(&bmg160->trig_work);
 #endif
 }
 
@@ -161,9 +163,8 @@ static int bmg160_handle_dataready_int(struct device *dev)
 	return 0;
 }
 
-static void bmg160_handle_int(void *arg)
+static void bmg160_handle_int(struct device *dev)
 {
-	struct device *dev = (struct device *)arg;
 	uint8_t status_int[4];
 
 	if (bmg160_read(dev, BMG160_REG_INT_STATUS0, status_int, 4) < 0) {
@@ -248,6 +249,9 @@ int bmg160_trigger_init(struct device *dev)
 #elif defined(CONFIG_BMG160_TRIGGER_GLOBAL_FIBER)
 	bmg160->work.handler = bmg160_work_cb;
 	bmg160->dev = dev;
+#elif defined(CONFIG_BMG160_TRIGGER_SENSOR_WORKQ)
+	sensor_trigger_work_init(&bmg160->trig_work, dev, bmg160_handle_int,
+				 CONFIG_BMG160_TRIGGER_WORKQ_LEVEL);
 #endif
 
 	gpio_pin_configure(bmg160->gpio, cfg->int_pin,
@@ -23,6 +23,7 @@
 #include <spi.h>
 #include <misc/byteorder.h>
 #include <nanokernel.h>
+#include <string.h>
 #include <misc/__assert.h>
 
 #include "sensor_bmi160.h"
@@ -30,8 +31,8 @@
 struct bmi160_device_data bmi160_data;
 
 static int bmi160_transceive(struct device *dev, uint8_t *tx_buf,
-			     uint8_t tx_buf_len, uint8_t *rx_buf,
-			     uint8_t rx_buf_len)
+			     uint32_t tx_buf_len, uint8_t *rx_buf,
+			     uint32_t rx_buf_len)
 {
 	const struct bmi160_device_config *dev_cfg = dev->config->config_info;
 	struct bmi160_device_data *bmi160 = dev->driver_data;
@@ -239,10 +240,18 @@ static int bmi160_acc_odr_set(struct device *dev, uint16_t freq_int,
 		return -ENOTSUP;
 	}
 
-	return bmi160_reg_field_update(dev, BMI160_REG_ACC_CONF,
-				       BMI160_ACC_CONF_ODR_POS,
-				       BMI160_ACC_CONF_ODR_MASK,
-				       odr);
+	if (bmi160_reg_field_update(dev, BMI160_REG_ACC_CONF,
+				    BMI160_ACC_CONF_ODR_POS,
+				    BMI160_ACC_CONF_ODR_MASK,
+				    odr) < 0) {
+		return -EIO;
+	}
+
+#if defined(CONFIG_BMI160_FIFO) && defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+	bmi160->fifo_odr = odr;
+#endif
+
+	return 0;
 }
 #endif
 
@@ -482,6 +491,9 @@ static int bmi160_acc_config(struct device *dev, enum sensor_channel chan,
 static int bmi160_gyr_odr_set(struct device *dev, uint16_t freq_int,
 			      uint16_t freq_milli)
 {
+#ifdef CONFIG_BMI160_FIFO
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+#endif
 	uint8_t odr = bmi160_freq_to_odr_val(freq_int, freq_milli);
 
 	if (odr < 0) {
@@ -492,10 +504,18 @@ static int bmi160_gyr_odr_set(struct device *dev, uint16_t freq_int,
 		return -ENOTSUP;
 	}
 
-	return bmi160_reg_field_update(dev, BMI160_REG_GYR_CONF,
-				       BMI160_GYR_CONF_ODR_POS,
-				       BMI160_GYR_CONF_ODR_MASK,
-				       odr);
+	if (bmi160_reg_field_update(dev, BMI160_REG_GYR_CONF,
+				    BMI160_GYR_CONF_ODR_POS,
+				    BMI160_GYR_CONF_ODR_MASK,
+				    odr) < 0) {
+		return -EIO;
+	}
+
+#ifdef CONFIG_BMI160_FIFO
+	bmi160->fifo_odr = odr;
+#endif
+
+	return 0;
 }
 #endif
 
@@ -822,6 +842,86 @@ static int bmi160_channel_get(struct device *dev,
 	return 0;
 }
 
+#ifdef CONFIG_BMI160_FIFO
+static uint32_t bmi160_odr_to_cycles(uint8_t odr)
+{
+	/* every ODR step doubles the rate */
+	uint32_t cycles = sys_clock_hw_cycles_per_sec / 100;
+
+	if (odr >= BMI160_ODR_100) {
+		return cycles >> (odr - BMI160_ODR_100);
+	}
+
+	return cycles << (BMI160_ODR_100 - odr);
+}
+
+static int bmi160_fifo_read(struct device *dev, struct sensor_fifo *fifo)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	uint8_t *buf = (uint8_t *)fifo->frames;
+	uint16_t raw[BMI160_FIFO_FRAME_SIZE / sizeof(uint16_t)];
+	uint32_t now, period, len, start;
+	uint16_t fifo_len;
+	int i, j, n;
+
+	fifo->num_frames = 0;
+	fifo->accel_scale = bmi160->scale.acc;
+	fifo->gyro_scale = bmi160->scale.gyr;
+
+	if (bmi160_word_read(dev, BMI160_REG_FIFO_LENGTH0, &fifo_len) < 0) {
+		return -EIO;
+	}
+
+	n = min((fifo_len & BMI160_FIFO_LENGTH_MASK) / BMI160_FIFO_FRAME_SIZE,
+		fifo->max_frames);
+	if (!n) {
+		return 0;
+	}
+
+	/*
+	 * Clock the packed frames, behind the command byte, straight into the
+	 * tail of the caller's buffer. A frame is unpacked into a larger
+	 * struct sensor_fifo_frame, so going front to back never overwrites
+	 * packed data that has not been unpacked yet.
+	 */
+	len = n * BMI160_FIFO_FRAME_SIZE + 1;
+	start = n * sizeof(struct sensor_fifo_frame) - len;
+	buf[start] = BMI160_REG_FIFO_DATA | (1 << 7);
+
+	if (bmi160_transceive(dev, buf + start, len, buf + start, len) < 0) {
+		return -EIO;
+	}
+
+	now = sys_cycle_get_32();
+	period = bmi160_odr_to_cycles(bmi160->fifo_odr);
+
+	for (i = 0; i < n; i++) {
+		struct sensor_fifo_frame *frame = &fifo->frames[i];
+
+		memcpy(raw, buf + start + 1 + i * BMI160_FIFO_FRAME_SIZE,
+		       sizeof(raw));
+		memset(frame, 0, sizeof(*frame));
+
+		frame->timestamp = now - (n - 1 - i) * period;
+
+		for (j = 0; j < 3; j++) {
+#if defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+			frame->accel[j] = sys_le16_to_cpu(raw[j]);
+#elif defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+			frame->gyro[j] = sys_le16_to_cpu(raw[j]);
+#else
+			frame->gyro[j] = sys_le16_to_cpu(raw[j]);
+			frame->accel[j] = sys_le16_to_cpu(raw[3 + j]);
+#endif
+		}
+	}
+
+	fifo->num_frames = n;
+
+	return 0;
+}
+#endif
+
 struct sensor_driver_api bmi160_api = {
 	.attr_set = bmi160_attr_set,
 #ifdef CONFIG_BMI160_TRIGGER
@@ -829,6 +929,9 @@ struct sensor_driver_api bmi160_api = {
 #endif
 	.sample_fetch = bmi160_sample_fetch,
 	.channel_get = bmi160_channel_get,
+#ifdef CONFIG_BMI160_FIFO
+	.fifo_read = bmi160_fifo_read,
+#endif
 };
 
 int bmi160_init(struct device *dev)
@@ -926,6 +1029,18 @@ int bmi160_init(struct device *dev)
 		return -EIO;
 	}
 
+#ifdef CONFIG_BMI160_FIFO
+	bmi160->fifo_odr = BMI160_DEFAULT_FIFO_ODR;
+
+	if (bmi160_byte_write(dev, BMI160_REG_FIFO_CONFIG1,
+			      BMI160_FIFO_CONFIG) < 0 ||
+	    bmi160_byte_write(dev, BMI160_REG_CMD,
+			      BMI160_CMD_FIFO_FLUSH) < 0) {
+		SYS_LOG_DBG("Cannot set up the FIFO.");
+		return -EIO;
+	}
+#endif
+
 #ifdef CONFIG_BMI160_TRIGGER
 	if (bmi160_trigger_mode_init(dev) < 0) {
 		SYS_LOG_DBG("Cannot set up trigger mode.");
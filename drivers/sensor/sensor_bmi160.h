@@ -175,6 +175,15 @@
 #define BMI160_INT_STATUS3_ORIENT_2	BIT(6)
 #define BMI160_INT_STATUS3_FLAT		BIT(7)
 
+/* BMI160_REG_FIFO_LENGTH0/1 */
+#define BMI160_FIFO_LENGTH_MASK		0x7FF
+
+/* BMI160_REG_FIFO_CONFIG1 */
+#define BMI160_FIFO_GYR_EN		BIT(7)
+#define BMI160_FIFO_ACC_EN		BIT(6)
+#define BMI160_FIFO_MAG_EN		BIT(5)
+#define BMI160_FIFO_HEADER_EN		BIT(4)
+
 /* BMI160_REG_ACC_CONF */
 #define BMI160_ACC_CONF_ODR_POS		0
 #define BMI160_ACC_CONF_ODR_MASK	0xF
@@ -203,6 +212,7 @@
 #define BMI160_CMD_PMU_ACC		0x10
 #define BMI160_CMD_PMU_GYR		0x14
 #define BMI160_CMD_PMU_MAG		0x18
+#define BMI160_CMD_FIFO_FLUSH		0xB0
 #define BMI160_CMD_SOFT_RESET		0xB6
 
 /* BMI160_REG_FOC_CONF */
@@ -255,6 +265,7 @@
 /* other */
 #define BMI160_CHIP_ID			0xD1
 #define BMI160_TEMP_OFFSET		23
+#define BMI160_FIFO_SIZE		1024
 
 /* allowed ODR values */
 enum bmi160_odr {
@@ -420,6 +431,25 @@ union bmi160_pmu_status {
 #	define BMI160_SAMPLE_SIZE		(3 * sizeof(uint16_t))
 #endif
 
+#if defined(CONFIG_BMI160_FIFO)
+/*
+ * The FIFO is used in headerless mode, so every frame holds the gyro sample
+ * followed by the accelerometer one, for the sensors that are not suspended.
+ */
+#if defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+#	define BMI160_FIFO_CONFIG		BMI160_FIFO_ACC_EN
+#	define BMI160_DEFAULT_FIFO_ODR		BMI160_DEFAULT_ODR_ACC
+#elif defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+#	define BMI160_FIFO_CONFIG		BMI160_FIFO_GYR_EN
+#	define BMI160_DEFAULT_FIFO_ODR		BMI160_DEFAULT_ODR_GYR
+#else
+#	define BMI160_FIFO_CONFIG		(BMI160_FIFO_GYR_EN | \
+						 BMI160_FIFO_ACC_EN)
+#	define BMI160_DEFAULT_FIFO_ODR		BMI160_DEFAULT_ODR_GYR
+#endif
+#define BMI160_FIFO_FRAME_SIZE		BMI160_SAMPLE_SIZE
+#endif
+
 /* total buffer contains one dummy byte, needed by SPI */
 #define BMI160_BUF_SIZE			(BMI160_SAMPLE_SIZE + 1)
 #define BMI160_DATA_OFS			1
@@ -454,6 +484,11 @@ struct bmi160_device_data {
 	union bmi160_sample sample;
 	struct bmi160_scale scale;
 
+#ifdef CONFIG_BMI160_FIFO
+	/* ODR of the sensor pacing the FIFO, to timestamp its frames */
+	uint8_t fifo_odr;
+#endif
+
 #ifdef CONFIG_BMI160_TRIGGER_OWN_FIBER
 	struct nano_sem sem;
 #endif
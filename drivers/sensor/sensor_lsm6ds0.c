@@ -23,6 +23,7 @@
 #include <device.h>
 #include <init.h>
 #include <misc/byteorder.h>
+#include <misc/util.h>
 #include <misc/__assert.h>
 
 #include "sensor_lsm6ds0.h"
@@ -394,9 +395,106 @@ static int lsm6ds0_channel_get(struct device *dev,
 	return 0;
 }
 
+#if defined(CONFIG_LSM6DS0_FIFO)
+/* Output data rates in tenths of Hz, indexed by the ODR register value */
+static const uint16_t lsm6ds0_gyro_dhz[] = {
+	0, 149, 595, 1190, 2380, 4760, 9520
+};
+static const uint16_t lsm6ds0_accel_dhz[] = {
+	0, 100, 500, 1190, 2380, 4760, 9520
+};
+
+static inline int16_t lsm6ds0_le16(const uint8_t *buf)
+{
+	return (int16_t)((uint16_t)(buf[0]) | ((uint16_t)(buf[1]) << 8));
+}
+
+static int lsm6ds0_fifo_read(struct device *dev, struct sensor_fifo *fifo)
+{
+	struct lsm6ds0_data *data = dev->driver_data;
+	const struct lsm6ds0_config *config = dev->config->config_info;
+	uint8_t gyro_addr = LSM6DS0_REG_OUT_X_L_G;
+	uint8_t accel_addr = LSM6DS0_REG_OUT_X_L_XL;
+	struct i2c_msg msgs[4];
+	uint8_t buf[12];
+	uint32_t now, period;
+	uint16_t odr;
+	uint8_t fifo_src;
+	int i, j, n;
+
+	fifo->num_frames = 0;
+	fifo->accel_scale = LSM6DS0_FIFO_ACCEL_SCALE;
+	fifo->gyro_scale = LSM6DS0_FIFO_GYRO_SCALE;
+
+	if (i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
+			      LSM6DS0_REG_FIFO_SRC, &fifo_src) < 0) {
+		SYS_LOG_DBG("failed to read FIFO status");
+		return -EIO;
+	}
+
+	n = min((fifo_src & LSM6DS0_MASK_FIFO_SRC_FSS) >>
+		LSM6DS0_SHIFT_FIFO_SRC_FSS, fifo->max_frames);
+
+	/*
+	 * The gyroscope and accelerometer output registers are not adjacent,
+	 * so each FIFO level is read with one transfer of two register reads
+	 * joined by a repeated start.
+	 */
+	msgs[0].buf = &gyro_addr;
+	msgs[0].len = 1;
+	msgs[0].flags = I2C_MSG_WRITE;
+	msgs[1].buf = buf;
+	msgs[1].len = 6;
+	msgs[1].flags = I2C_MSG_RESTART | I2C_MSG_READ;
+	msgs[2].buf = &accel_addr;
+	msgs[2].len = 1;
+	msgs[2].flags = I2C_MSG_RESTART | I2C_MSG_WRITE;
+	msgs[3].buf = buf + 6;
+	msgs[3].len = 6;
+	msgs[3].flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP;
+
+	for (i = 0; i < n; i++) {
+		struct sensor_fifo_frame *frame = &fifo->frames[i];
+
+		if (i2c_transfer(data->i2c_master, msgs, ARRAY_SIZE(msgs),
+				 config->i2c_slave_addr) < 0) {
+			SYS_LOG_DBG("failed to read FIFO");
+			return -EIO;
+		}
+
+		for (j = 0; j < 3; j++) {
+			/* the gyroscope is not in the FIFO when powered down */
+			frame->gyro[j] = LSM6DS0_DEFAULT_GYRO_SAMPLING_RATE ?
+					 lsm6ds0_le16(&buf[2 * j]) : 0;
+			frame->accel[j] = lsm6ds0_le16(&buf[6 + 2 * j]);
+		}
+	}
+
+	now = sys_cycle_get_32();
+
+	if (LSM6DS0_DEFAULT_GYRO_SAMPLING_RATE) {
+		odr = lsm6ds0_gyro_dhz[LSM6DS0_DEFAULT_GYRO_SAMPLING_RATE];
+	} else {
+		odr = lsm6ds0_accel_dhz[LSM6DS0_DEFAULT_ACCEL_SAMPLING_RATE];
+	}
+	period = odr ? (uint64_t)sys_clock_hw_cycles_per_sec * 10 / odr : 0;
+
+	for (i = 0; i < n; i++) {
+		fifo->frames[i].timestamp = now - (n - 1 - i) * period;
+	}
+
+	fifo->num_frames = n;
+
+	return 0;
+}
+#endif
+
 static struct sensor_driver_api lsm6ds0_api_funcs = {
 	.sample_fetch = lsm6ds0_sample_fetch,
 	.channel_get = lsm6ds0_channel_get,
+#if defined(CONFIG_LSM6DS0_FIFO)
+	.fifo_read = lsm6ds0_fifo_read,
+#endif
 };
 
 static int lsm6ds0_init_chip(struct device *dev)
@@ -472,6 +570,20 @@ static int lsm6ds0_init_chip(struct device *dev)
 		return -EIO;
 	}
 
+#if defined(CONFIG_LSM6DS0_FIFO)
+	if (i2c_reg_update_byte(data->i2c_master, config->i2c_slave_addr,
+				LSM6DS0_REG_CTRL_REG9,
+				LSM6DS0_MASK_CTRL_REG9_FIFO_EN,
+				1 << LSM6DS0_SHIFT_CTRL_REG9_FIFO_EN) < 0 ||
+	    i2c_reg_write_byte(data->i2c_master, config->i2c_slave_addr,
+			       LSM6DS0_REG_FIFO_CTRL,
+			       LSM6DS0_FIFO_MODE_CONTINUOUS <<
+			       LSM6DS0_SHIFT_FIFO_CTRL_FMODE) < 0) {
+		SYS_LOG_DBG("failed to enable the FIFO");
+		return -EIO;
+	}
+#endif
+
 	return 0;
 }
 
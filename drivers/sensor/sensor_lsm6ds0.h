@@ -280,6 +280,7 @@
 #define LSM6DS0_MASK_FIFO_CTRL_FTH		(BIT(4) | BIT(3) | BIT(2) | \
 						 BIT(1) | BIT(0))
 #define LSM6DS0_SHIFT_FIFO_CTRL_FTH		0
+#define LSM6DS0_FIFO_MODE_CONTINUOUS		6
 
 #define LSM6DS0_REG_FIFO_SRC                    0x2F
 #define LSM6DS0_MASK_FIFO_SRC_FTH		BIT(7)
@@ -469,6 +470,16 @@
 	#define LSM6DS0_DEFAULT_GYRO_SAMPLING_RATE	6
 #endif
 
+#if defined(CONFIG_LSM6DS0_FIFO)
+/* FIFO sample scales, in micro m/s^2 and micro radians/s per count */
+	#define LSM6DS0_FIFO_ACCEL_SCALE	\
+		((uint32_t)(LSM6DS0_DEFAULT_ACCEL_FULLSCALE_FACTOR * \
+			    1000000.0 / 32767.0 + 0.5))
+	#define LSM6DS0_FIFO_GYRO_SCALE		\
+		((uint32_t)(LSM6DS0_DEFAULT_GYRO_FULLSCALE_FACTOR * \
+			    SENSOR_PI_DOUBLE / 180.0 * 1000.0 + 0.5))
+#endif
+
 struct lsm6ds0_config {
 	char *i2c_master_dev_name;
 	uint16_t i2c_slave_addr;
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Sensor trigger work queue
+ *
+ * One fiber runs the interrupt work of all the sensor drivers using it,
+ * from a FIFO per priority level. A counting semaphore tracks the number
+ * of queued work items so the fiber only scans the levels when there is
+ * something to run.
+ */
+
+#include <string.h>
+
+#include <nanokernel.h>
+#include <init.h>
+#include <sensor.h>
+#include <misc/util.h>
+
+static struct nano_fifo sensor_trigger_queues[
+	CONFIG_SENSOR_TRIGGER_WORKQ_LEVELS];
+static struct nano_sem sensor_trigger_queued;
+static sys_slist_t sensor_trigger_works;
+
+static char __stack sensor_trigger_stack[
+	CONFIG_SENSOR_TRIGGER_WORKQ_STACK_SIZE];
+
+void sensor_trigger_work_init(struct sensor_trigger_work *work,
+			      struct device *dev,
+			      sensor_trigger_work_handler_t handler,
+			      uint8_t level)
+{
+	int key;
+
+	work->handler = handler;
+	work->dev = dev;
+	work->level = min(level, CONFIG_SENSOR_TRIGGER_WORKQ_LEVELS - 1);
+	work->pending = 0;
+	work->latency_sum = 0;
+	memset(&work->stats, 0, sizeof(work->stats));
+
+	key = irq_lock();
+	sys_slist_append(&sensor_trigger_works, &work->node);
+	irq_unlock(key);
+}
+
+void sensor_trigger_work_submit(struct sensor_trigger_work *work)
+{
+	int key = irq_lock();
+
+	if (work->pending) {
+		work->stats.coalesced++;
+		irq_unlock(key);
+		return;
+	}
+
+	work->pending = 1;
+	work->submit_time = sys_cycle_get_32();
+
+	irq_unlock(key);
+
+	nano_fifo_put(&sensor_trigger_queues[work->level], work);
+	nano_sem_give(&sensor_trigger_queued);
+}
+
+int sensor_trigger_stats_get(struct device *dev,
+			     struct sensor_trigger_stats *stats)
+{
+	sys_snode_t *node;
+	int key;
+
+	SYS_SLIST_FOR_EACH_NODE(&sensor_trigger_works, node) {
+		struct sensor_trigger_work *work =
+			CONTAINER_OF(node, struct sensor_trigger_work, node);
+
+		if (work->dev != dev) {
+			continue;
+		}
+
+		key = irq_lock();
+
+		*stats = work->stats;
+		if (stats->count) {
+			stats->latency_avg = work->latency_sum / stats->count;
+		}
+
+		irq_unlock(key);
+
+		return 0;
+	}
+
+	return -ENODEV;
+}
+
+static struct sensor_trigger_work *sensor_trigger_next(void)
+{
+	struct sensor_trigger_work *work;
+	int level;
+
+	for (level = 0; level < CONFIG_SENSOR_TRIGGER_WORKQ_LEVELS; level++) {
+		work = nano_fiber_fifo_get(&sensor_trigger_queues[level],
+					   TICKS_NONE);
+		if (work) {
+			return work;
+		}
+	}
+
+	return NULL;
+}
+
+static void sensor_trigger_fiber(int arg1, int arg2)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	while (1) {
+		struct sensor_trigger_work *work;
+		uint32_t latency;
+		int key;
+
+		nano_fiber_sem_take(&sensor_trigger_queued, TICKS_UNLIMITED);
+
+		work = sensor_trigger_next();
+		if (!work) {
+			continue;
+		}
+
+		/* clear pending first so the handler can be resubmitted */
+		key = irq_lock();
+
+		latency = sys_cycle_get_32() - work->submit_time;
+		work->pending = 0;
+
+		if (!work->stats.count || latency < work->stats.latency_min) {
+			work->stats.latency_min = latency;
+		}
+
+		if (latency > work->stats.latency_max) {
+			work->stats.latency_max = latency;
+		}
+
+		work->stats.count++;
+		work->latency_sum += latency;
+
+		irq_unlock(key);
+
+		work->handler(work->dev);
+	}
+}
+
+static int sensor_trigger_workq_init(struct device *dev)
+{
+	int i;
+
+	ARG_UNUSED(dev);
+
+	for (i = 0; i < CONFIG_SENSOR_TRIGGER_WORKQ_LEVELS; i++) {
+		nano_fifo_init(&sensor_trigger_queues[i]);
+	}
+
+	nano_sem_init(&sensor_trigger_queued);
+
+	fiber_start(sensor_trigger_stack, sizeof(sensor_trigger_stack),
+		    sensor_trigger_fiber, 0, 0,
+		    CONFIG_SENSOR_TRIGGER_WORKQ_PRIORITY, 0);
+
+	return 0;
+}
+
+SYS_INIT(sensor_trigger_workq_init, PRIMARY,
+	 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -42,6 +42,7 @@
 #include <sections.h>
 #include <uart.h>
 #include <sys_io.h>
+#include <misc/util.h>
 
 #ifdef CONFIG_PCI
 #include <pci/pci.h>
@@ -79,8 +80,10 @@
 #define IIR_THRE  0x02 /* transmit holding register empty interrupt */
 #define IIR_RBRF  0x04 /* receiver buffer register full interrupt */
 #define IIR_LS    0x06 /* receiver line status interrupt */
+#define IIR_RXTO  0x0C /* receiver timeout interrupt */
 #define IIR_MASK  0x07 /* interrupt id bits mask  */
 #define IIR_ID    0x06 /* interrupt ID mask without NIP */
+#define IIR_ID_TO 0x0E /* interrupt ID mask with timeout, without NIP */
 
 /* equates for FIFO control register */
 
@@ -125,6 +128,19 @@
 #define FCR_FIFO_8 0x80  /* 8 bytes in RCVR FIFO */
 #define FCR_FIFO_14 0xC0 /* 14 bytes in RCVR FIFO */
 
+#if defined(CONFIG_UART_NS16550_RX_TRIGGER_1)
+#define FCR_RX_TRIGGER FCR_FIFO_1
+#elif defined(CONFIG_UART_NS16550_RX_TRIGGER_4)
+#define FCR_RX_TRIGGER FCR_FIFO_4
+#elif defined(CONFIG_UART_NS16550_RX_TRIGGER_14)
+#define FCR_RX_TRIGGER FCR_FIFO_14
+#else
+#define FCR_RX_TRIGGER FCR_FIFO_8
+#endif
+
+/* bytes that can be written to the XMIT FIFO once it is empty */
+#define TX_FIFO_SIZE 16
+
 /* constants for line control register */
 
 #define LCR_CS5 0x00   /* 5 bits data size */
@@ -213,6 +229,19 @@ struct uart_ns16550_dev_data_t {
 	uart_irq_callback_t	cb;	/**< Callback function pointer */
 #endif
 
+#ifdef CONFIG_UART_ASYNC
+	uart_async_callback_t async_cb;	/**< Asynchronous API callback */
+	uint8_t *rx_buf;	/**< RX ring buffer */
+	uint32_t rx_size;	/**< RX ring size, a power of two */
+	uint32_t rx_threshold;	/**< RX_READY threshold */
+	uint32_t rx_head;	/**< RX ring write count */
+	uint32_t rx_tail;	/**< RX ring read count */
+	const uint8_t *tx_buf;	/**< Buffer being sent */
+	uint32_t tx_len;	/**< Bytes left to send */
+	uint8_t errors;		/**< Line errors seen by the ISR */
+	struct uart_async_stats stats;
+#endif
+
 #ifdef CONFIG_UART_NS16550_DLF
 	uint8_t dlf;		/**< DLF value */
 #endif
@@ -329,11 +358,11 @@ static int uart_ns16550_init(struct device *dev)
 
 	/*
 	 * Program FIFO: enabled, mode 0 (set for compatibility with quark),
-	 * generate the interrupt at 8th byte
+	 * generate the interrupt at the configured trigger level
 	 * Clear TX and RX FIFO
 	 */
-	OUTBYTE(FCR(dev),
-		FCR_FIFO | FCR_MODE0 | FCR_FIFO_8 | FCR_RCVRCLR | FCR_XMITCLR);
+	OUTBYTE(FCR(dev), FCR_FIFO | FCR_MODE0 | FCR_RX_TRIGGER |
+		FCR_RCVRCLR | FCR_XMITCLR);
 
 	/* clear the port */
 	INBYTE(RDR(dev));
@@ -405,7 +434,21 @@ static unsigned char uart_ns16550_poll_out(struct device *dev,
  */
 static int uart_ns16550_err_check(struct device *dev)
 {
+#ifdef CONFIG_UART_ASYNC
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	int errors;
+	int key;
+
+	/* reading LSR clears the errors, the ISR keeps the ones it saw */
+	key = irq_lock();
+	errors = dev_data->errors | ((INBYTE(LSR(dev)) & LSR_EOB_MASK) >> 1);
+	dev_data->errors = 0;
+	irq_unlock(key);
+
+	return errors;
+#else
 	return (INBYTE(LSR(dev)) & LSR_EOB_MASK) >> 1;
+#endif
 }
 
 #if CONFIG_UART_INTERRUPT_DRIVEN
@@ -601,6 +644,284 @@ static void uart_ns16550_irq_callback_set(struct device *dev,
 	dev_data->cb = cb;
 }
 
+#ifdef CONFIG_UART_ASYNC
+
+/**
+ * @brief Set the asynchronous API callback
+ *
+ * @param dev UART device struct
+ * @param cb Callback function pointer, NULL to go back to the IRQ callback
+ *
+ * @return N/A
+ */
+static void uart_ns16550_async_callback_set(struct device *dev,
+					    uart_async_callback_t cb)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+
+	dev_data->async_cb = cb;
+}
+
+/**
+ * @brief Start receiving into a ring buffer
+ *
+ * @param dev UART device struct
+ * @param buf Ring buffer
+ * @param size Ring buffer size, a power of two
+ * @param threshold Buffered bytes reported with UART_ASYNC_RX_READY
+ *
+ * @return 0 if successful, failed otherwise
+ */
+static int uart_ns16550_async_rx_enable(struct device *dev, uint8_t *buf,
+					uint32_t size, uint32_t threshold)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	int key;
+
+	if (!buf || !size || (size & (size - 1)) ||
+	    !threshold || threshold > size) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	dev_data->rx_buf = buf;
+	dev_data->rx_size = size;
+	dev_data->rx_threshold = threshold;
+	dev_data->rx_head = 0;
+	dev_data->rx_tail = 0;
+
+	OUTBYTE(IER(dev), INBYTE(IER(dev)) | IER_RXRDY | IER_LSR);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+/**
+ * @brief Stop receiving into the ring buffer
+ *
+ * @param dev UART device struct
+ *
+ * @return 0
+ */
+static int uart_ns16550_async_rx_disable(struct device *dev)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	int key;
+
+	key = irq_lock();
+
+	OUTBYTE(IER(dev), INBYTE(IER(dev)) & ~(IER_RXRDY | IER_LSR));
+	dev_data->rx_buf = NULL;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+/**
+ * @brief Take received bytes out of the ring buffer
+ *
+ * @param dev UART device struct
+ * @param buf Buffer to copy to
+ * @param len Buffer size
+ *
+ * @return Number of bytes read
+ */
+static int uart_ns16550_async_read(struct device *dev, uint8_t *buf,
+				   uint32_t len)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	uint32_t mask = dev_data->rx_size - 1;
+	uint32_t i;
+	int key;
+
+	key = irq_lock();
+
+	for (i = 0; i < len && dev_data->rx_tail != dev_data->rx_head; i++) {
+		buf[i] = dev_data->rx_buf[dev_data->rx_tail++ & mask];
+	}
+
+	irq_unlock(key);
+
+	return i;
+}
+
+/**
+ * @brief Start sending a buffer from the TX interrupt
+ *
+ * @param dev UART device struct
+ * @param buf Data to send
+ * @param len Number of bytes to send
+ *
+ * @return 0 if successful, -EINVAL if there is nothing to send, -EBUSY if
+ * a buffer is being sent
+ */
+static int uart_ns16550_async_tx(struct device *dev, const uint8_t *buf,
+				 uint32_t len)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	int key;
+
+	/* tx_len doubles as the busy flag, and TX_DONE needs a byte sent */
+	if (!len) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (dev_data->tx_len) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	dev_data->tx_buf = buf;
+	dev_data->tx_len = len;
+
+	/* THRE is raised right away if the FIFO is already empty */
+	OUTBYTE(IER(dev), INBYTE(IER(dev)) | IER_TBE);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+/**
+ * @brief Get the asynchronous API counters
+ *
+ * @param dev UART device struct
+ * @param stats Filled with the counters
+ *
+ * @return 0
+ */
+static int uart_ns16550_async_stats_get(struct device *dev,
+					struct uart_async_stats *stats)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	int key;
+
+	key = irq_lock();
+	*stats = dev_data->stats;
+	irq_unlock(key);
+
+	return 0;
+}
+
+/* Move the RCVR FIFO to the ring buffer, returns the events */
+static uint32_t async_rx_drain(struct device *dev)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	uint32_t mask = dev_data->rx_size - 1;
+	uint32_t events = 0;
+	uint8_t lsr, c;
+
+	while ((lsr = INBYTE(LSR(dev))) & LSR_RXRDY) {
+		if (lsr & LSR_EOB_MASK) {
+			dev_data->errors |= (lsr & LSR_EOB_MASK) >> 1;
+			events |= UART_ASYNC_RX_ERROR;
+		}
+
+		c = INBYTE(RDR(dev));
+
+		if (!dev_data->rx_buf) {
+			continue;
+		}
+
+		if (dev_data->rx_head - dev_data->rx_tail ==
+		    dev_data->rx_size) {
+			dev_data->stats.rx_dropped++;
+			events |= UART_ASYNC_RX_OVERFLOW;
+			continue;
+		}
+
+		dev_data->rx_buf[dev_data->rx_head++ & mask] = c;
+		dev_data->stats.rx_bytes++;
+	}
+
+	return events;
+}
+
+/* Refill the empty XMIT FIFO, returns the events */
+static uint32_t async_tx_fill(struct device *dev)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	uint32_t n = min(dev_data->tx_len, TX_FIFO_SIZE);
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		OUTBYTE(THR(dev), dev_data->tx_buf[i]);
+	}
+
+	dev_data->tx_buf += n;
+	dev_data->tx_len -= n;
+	dev_data->stats.tx_bytes += n;
+
+	if (dev_data->tx_len) {
+		return 0;
+	}
+
+	OUTBYTE(IER(dev), INBYTE(IER(dev)) & (~IER_TBE));
+
+	return n ? UART_ASYNC_TX_DONE : 0;
+}
+
+/**
+ * @brief Interrupt service routine for the asynchronous API
+ *
+ * Services every pending interrupt source, then calls the callback once
+ * with the events they brought.
+ *
+ * @param dev UART device struct
+ *
+ * @return N/A
+ */
+static void uart_ns16550_async_isr(struct device *dev)
+{
+	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
+	uint32_t events = 0;
+	uint32_t buffered;
+	uint8_t iir, lsr;
+
+	dev_data->stats.interrupts++;
+
+	while (!((iir = INBYTE(IIR(dev))) & IIR_NIP)) {
+		switch (iir & IIR_ID_TO) {
+		case IIR_LS:
+			lsr = INBYTE(LSR(dev));
+			dev_data->errors |= (lsr & LSR_EOB_MASK) >> 1;
+			events |= UART_ASYNC_RX_ERROR;
+			break;
+		case IIR_RXTO:
+			events |= async_rx_drain(dev);
+			events |= UART_ASYNC_RX_IDLE;
+			break;
+		case IIR_RBRF:
+			events |= async_rx_drain(dev);
+			break;
+		case IIR_THRE:
+			events |= async_tx_fill(dev);
+			break;
+		default:
+			/* modem status, cleared by reading MSR */
+			INBYTE(MSR(dev));
+			break;
+		}
+	}
+
+	buffered = dev_data->rx_head - dev_data->rx_tail;
+	if (dev_data->rx_buf && buffered >= dev_data->rx_threshold) {
+		events |= UART_ASYNC_RX_READY;
+	}
+
+	if (events && dev_data->async_cb) {
+		dev_data->stats.callbacks++;
+		dev_data->async_cb(dev, events);
+	}
+}
+
+#endif /* CONFIG_UART_ASYNC */
+
 /**
  * @brief Interrupt service routine.
  *
@@ -615,6 +936,13 @@ static void uart_ns16550_isr(void *arg)
 	struct device *dev = arg;
 	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
 
+#ifdef CONFIG_UART_ASYNC
+	if (dev_data->async_cb) {
+		uart_ns16550_async_isr(dev);
+		return;
+	}
+#endif
+
 	if (dev_data->cb) {
 		dev_data->cb(dev);
 	}
@@ -719,6 +1047,15 @@ static struct uart_driver_api uart_ns16550_driver_api = {
 
 #endif
 
+#ifdef CONFIG_UART_ASYNC
+	.async_callback_set = uart_ns16550_async_callback_set,
+	.async_rx_enable = uart_ns16550_async_rx_enable,
+	.async_rx_disable = uart_ns16550_async_rx_disable,
+	.async_read = uart_ns16550_async_read,
+	.async_tx = uart_ns16550_async_tx,
+	.async_stats_get = uart_ns16550_async_stats_get,
+#endif
+
 #ifdef CONFIG_UART_NS16550_LINE_CTRL
 	.line_ctrl_set = uart_ns16550_line_ctrl_set,
 #endif
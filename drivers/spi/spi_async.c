@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Queued SPI transactions for drivers without their own queue
+ *
+ * Transactions are run one at a time with the synchronous transfer call
+ * of the driver, by a fiber of their own so that the submitter does not
+ * wait and the system workqueue is not held up by slow buses. Drivers
+ * with their own queue use the same fiber to start the next message when
+ * their completion interrupt can not do it.
+ */
+
+#include <nanokernel.h>
+#include <init.h>
+#include <spi.h>
+#include <misc/nano_work.h>
+#include <misc/util.h>
+
+static char __stack spi_async_stack[CONFIG_SPI_ASYNC_STACK_SIZE];
+
+static const struct fiber_config spi_async_config = {
+	.stack = spi_async_stack,
+	.stack_size = sizeof(spi_async_stack),
+	.prio = CONFIG_SPI_ASYNC_PRIORITY,
+};
+
+static struct nano_workqueue spi_async_wq;
+
+static void spi_async_run(struct nano_work *work)
+{
+	struct spi_transaction *trans =
+		CONTAINER_OF(work, struct spi_transaction, work);
+	struct spi_msg *msg;
+	int ret = 0;
+	int i;
+
+	if (trans->config) {
+		ret = spi_configure(trans->dev, trans->config);
+	}
+
+	if (!ret && trans->slave) {
+		ret = spi_slave_select(trans->dev, trans->slave);
+	}
+
+	for (i = 0; !ret && i < trans->num_msgs; i++) {
+		msg = &trans->msgs[i];
+		ret = spi_transceive(trans->dev, msg->tx_buf, msg->tx_len,
+				     msg->rx_buf, msg->rx_len);
+	}
+
+	trans->callback(trans->dev, ret, trans->user_data);
+}
+
+int _spi_async_submit(struct device *dev, struct spi_transaction *trans)
+{
+	trans->dev = dev;
+
+	nano_work_init(&trans->work, spi_async_run);
+	_spi_async_work_submit(&trans->work);
+
+	return 0;
+}
+
+void _spi_async_work_submit(struct nano_work *work)
+{
+	nano_work_submit_to_queue(&spi_async_wq, work);
+}
+
+static int spi_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	nano_workqueue_start(&spi_async_wq, &spi_async_config);
+
+	return 0;
+}
+
+SYS_INIT(spi_async_init, PRIMARY, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
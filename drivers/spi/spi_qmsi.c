@@ -23,6 +23,7 @@
 #include <spi.h>
 #include <gpio.h>
 #include <power.h>
+#include <misc/util.h>
 
 #include "qm_spi.h"
 #include "clk.h"
@@ -35,10 +36,17 @@ struct pending_transfer {
 
 static struct pending_transfer pending_transfers[QM_SPI_NUM];
 
+/* Largest DMA block, in frames */
+#define SPI_QMSI_DMA_MAX_FRAMES 4095
+
 struct spi_qmsi_config {
 	qm_spi_t spi;
 	char *cs_port;
 	uint32_t cs_pin;
+#ifdef CONFIG_SPI_QMSI_DMA
+	qm_dma_channel_id_t dma_tx_channel;
+	qm_dma_channel_id_t dma_rx_channel;
+#endif
 };
 
 struct spi_context_t {
@@ -59,6 +67,14 @@ struct spi_qmsi_runtime {
 	int rc;
 	bool loopback;
 	struct nano_sem sem;
+#ifdef CONFIG_SPI_ASYNC
+	struct device *dev;
+	/* Queued transactions, the head one is on the bus */
+	sys_slist_t queue;
+	/* Index of the next message of the head transaction */
+	uint8_t msg_index;
+	struct nano_work next_work;
+#endif
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	struct spi_context_t ctx_save;
 	uint32_t device_power_state;
@@ -96,8 +112,14 @@ static int spi_qmsi_configure(struct device *dev,
 {
 	struct spi_qmsi_runtime *context = dev->driver_data;
 	qm_spi_config_t *cfg = &context->cfg;
+	uint32_t word_size = SPI_WORD_SIZE_GET(config->config);
+
+	if (word_size < QM_SPI_FRAME_SIZE_4_BIT + 1 ||
+	    word_size > QM_SPI_FRAME_SIZE_32_BIT + 1) {
+		return -EINVAL;
+	}
 
-	cfg->frame_size = SPI_WORD_SIZE_GET(config->config) - 1;
+	cfg->frame_size = word_size - 1;
 	cfg->bus_mode = config_to_bmode(SPI_MODE(config->config));
 	/* As loopback is implemented inside the controller,
 	 * the bus mode doesn't matter.
@@ -124,11 +146,18 @@ static void transfer_complete(void *data, int error, qm_spi_status_t status,
 
 	context = dev->driver_data;
 
-	spi_control_cs(dev, false);
-
 	pending->dev = NULL;
 	context->rc = error;
+
+#ifdef CONFIG_SPI_ASYNC
+	/* The QMSI interrupt handler keeps using the transfer after this
+	 * callback, so the next message is started from the SPI fiber.
+	 */
+	_spi_async_work_submit(&context->next_work);
+#else
+	spi_control_cs(dev, false);
 	device_sync_call_complete(&context->sync);
+#endif
 }
 
 static int spi_qmsi_slave_select(struct device *dev, uint32_t slave)
@@ -152,9 +181,36 @@ static inline uint8_t frame_size_to_dfs(qm_spi_frame_size_t frame_size)
 	return 0;
 }
 
-static int spi_qmsi_transceive(struct device *dev,
-			       const void *tx_buf, uint32_t tx_buf_len,
-			       void *rx_buf, uint32_t rx_buf_len)
+#ifdef CONFIG_SPI_QMSI_DMA
+static int spi_qmsi_dma_transfer(struct device *dev,
+				 qm_spi_async_transfer_t *xfer)
+{
+	const struct spi_qmsi_config *spi_config = dev->config->config_info;
+	qm_spi_t spi = spi_config->spi;
+
+	/* The channel setup depends on the frame size of the transfer */
+	if (xfer->tx_len &&
+	    qm_spi_dma_channel_config(spi, QM_DMA_0,
+				      spi_config->dma_tx_channel,
+				      QM_DMA_MEMORY_TO_PERIPHERAL) != 0) {
+		return -EIO;
+	}
+
+	if (xfer->rx_len &&
+	    qm_spi_dma_channel_config(spi, QM_DMA_0,
+				      spi_config->dma_rx_channel,
+				      QM_DMA_PERIPHERAL_TO_MEMORY) != 0) {
+		return -EIO;
+	}
+
+	return qm_spi_dma_transfer(spi, xfer);
+}
+#endif
+
+/* Start one transfer, transfer_complete() is called when it is done */
+static int spi_qmsi_start(struct device *dev,
+			  const void *tx_buf, uint32_t tx_buf_len,
+			  void *rx_buf, uint32_t rx_buf_len)
 {
 	const struct spi_qmsi_config *spi_config = dev->config->config_info;
 	qm_spi_t spi = spi_config->spi;
@@ -172,8 +228,6 @@ static int spi_qmsi_transceive(struct device *dev,
 	pending_transfers[spi].dev = dev;
 	nano_sem_give(&context->sem);
 
-	device_busy_set(dev);
-
 	xfer = &pending_transfers[spi].xfer;
 
 	xfer->rx = rx_buf;
@@ -202,29 +256,200 @@ static int spi_qmsi_transceive(struct device *dev,
 
 	rc = qm_spi_set_config(spi, cfg);
 	if (rc != 0) {
-		device_busy_clear(dev);
+		pending_transfers[spi].dev = NULL;
 		return -EINVAL;
 	}
 
+#ifdef CONFIG_SPI_QMSI_DMA
+	if (max(tx_buf_len, rx_buf_len) >= CONFIG_SPI_QMSI_DMA_THRESHOLD &&
+	    max(xfer->tx_len, xfer->rx_len) <= SPI_QMSI_DMA_MAX_FRAMES) {
+		rc = spi_qmsi_dma_transfer(dev, xfer);
+	} else
+#endif
+	{
+		rc = qm_spi_irq_transfer(spi, xfer);
+	}
+
+	if (rc != 0) {
+		pending_transfers[spi].dev = NULL;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_SPI_ASYNC
+/* Move the queue forward after the last message ended with status, 0 or
+ * a negative errno code handed to the callback: start the next message
+ * of the head transaction, or complete it and start the next transaction.
+ * Only one context runs this at a time, either the submitter that found
+ * the queue idle or the SPI fiber.
+ */
+static void spi_qmsi_process(struct device *dev, int status)
+{
+	struct spi_qmsi_runtime *context = dev->driver_data;
+	struct spi_transaction *trans;
+	struct spi_msg *msg;
+	unsigned int key;
+	bool idle;
+
+	for (;;) {
+		trans = CONTAINER_OF(sys_slist_peek_head(&context->queue),
+				     struct spi_transaction, node);
+
+		if (!status && context->msg_index == 0) {
+			if (trans->config) {
+				status = spi_qmsi_configure(dev,
+							    trans->config);
+			}
+
+			if (!status && trans->slave) {
+				status = spi_qmsi_slave_select(dev,
+							       trans->slave);
+			}
+
+			if (!status) {
+				spi_control_cs(dev, true);
+			}
+		}
+
+		if (!status && context->msg_index < trans->num_msgs) {
+			msg = &trans->msgs[context->msg_index++];
+
+			status = spi_qmsi_start(dev, msg->tx_buf, msg->tx_len,
+						msg->rx_buf, msg->rx_len);
+			if (!status) {
+				return;
+			}
+		}
+
+		spi_control_cs(dev, false);
+
+		key = irq_lock();
+		sys_slist_get_not_empty(&context->queue);
+		idle = sys_slist_is_empty(&context->queue);
+		irq_unlock(key);
+
+		context->msg_index = 0;
+		if (idle) {
+			device_busy_clear(dev);
+		}
+
+		trans->callback(dev, status, trans->user_data);
+
+		if (idle) {
+			return;
+		}
+
+		status = 0;
+	}
+}
+
+static void spi_qmsi_next(struct nano_work *work)
+{
+	struct spi_qmsi_runtime *context =
+		CONTAINER_OF(work, struct spi_qmsi_runtime, next_work);
+
+	spi_qmsi_process(context->dev, context->rc ? -EIO : 0);
+}
+
+static int spi_qmsi_transceive_async(struct device *dev,
+				     struct spi_transaction *trans)
+{
+	struct spi_qmsi_runtime *context = dev->driver_data;
+	unsigned int key;
+	bool idle;
+
+	trans->dev = dev;
+
+	key = irq_lock();
+	idle = sys_slist_is_empty(&context->queue);
+	sys_slist_append(&context->queue, &trans->node);
+	irq_unlock(key);
+
+	if (idle) {
+		device_busy_set(dev);
+		spi_qmsi_process(dev, 0);
+	}
+
+	return 0;
+}
+
+struct spi_qmsi_sync {
+	struct nano_sem sem;
+	int status;
+};
+
+static void spi_qmsi_sync_done(struct device *dev, int status,
+			       void *user_data)
+{
+	struct spi_qmsi_sync *sync = user_data;
+
+	sync->status = status;
+	nano_sem_give(&sync->sem);
+}
+
+/* Synchronous transfers wait for their turn in the queue */
+static int spi_qmsi_transceive(struct device *dev,
+			       const void *tx_buf, uint32_t tx_buf_len,
+			       void *rx_buf, uint32_t rx_buf_len)
+{
+	struct spi_qmsi_sync sync;
+	struct spi_msg msg = {
+		.tx_buf = tx_buf,
+		.tx_len = tx_buf_len,
+		.rx_buf = rx_buf,
+		.rx_len = rx_buf_len,
+	};
+	struct spi_transaction trans = {
+		.msgs = &msg,
+		.num_msgs = 1,
+		.callback = spi_qmsi_sync_done,
+		.user_data = &sync,
+	};
+
+	nano_sem_init(&sync.sem);
+
+	spi_qmsi_transceive_async(dev, &trans);
+
+	nano_sem_take(&sync.sem, TICKS_UNLIMITED);
+
+	return sync.status;
+}
+#else
+static int spi_qmsi_transceive(struct device *dev,
+			       const void *tx_buf, uint32_t tx_buf_len,
+			       void *rx_buf, uint32_t rx_buf_len)
+{
+	struct spi_qmsi_runtime *context = dev->driver_data;
+	int rc;
+
+	device_busy_set(dev);
+
 	spi_control_cs(dev, true);
 
-	rc = qm_spi_irq_transfer(spi, xfer);
+	rc = spi_qmsi_start(dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
 	if (rc != 0) {
 		spi_control_cs(dev, false);
 		device_busy_clear(dev);
-		return -EIO;
+		return rc;
 	}
+
 	device_sync_call_wait(&context->sync);
 
 	device_busy_clear(dev);
 
 	return context->rc ? -EIO : 0;
 }
+#endif /* CONFIG_SPI_ASYNC */
 
 static struct spi_driver_api spi_qmsi_api = {
 	.configure = spi_qmsi_configure,
 	.slave_select = spi_qmsi_slave_select,
 	.transceive = spi_qmsi_transceive,
+#ifdef CONFIG_SPI_ASYNC
+	.transceive_async = spi_qmsi_transceive_async,
+#endif
 };
 
 static struct device *gpio_cs_init(const struct spi_qmsi_config *config)
@@ -297,6 +522,12 @@ static int spi_qmsi_init(struct device *dev)
 	nano_sem_init(&context->sem);
 	nano_sem_give(&context->sem);
 
+#ifdef CONFIG_SPI_ASYNC
+	context->dev = dev;
+	sys_slist_init(&context->queue);
+	nano_work_init(&context->next_work, spi_qmsi_next);
+#endif
+
 	spi_master_set_power_state(dev, DEVICE_PM_ACTIVE_STATE);
 
 	dev->driver_api = &spi_qmsi_api;
@@ -377,6 +608,10 @@ static struct spi_qmsi_config spi_qmsi_mst_0_config = {
 	.cs_port = CONFIG_SPI_0_CS_GPIO_PORT,
 	.cs_pin = CONFIG_SPI_0_CS_GPIO_PIN,
 #endif
+#ifdef CONFIG_SPI_QMSI_DMA
+	.dma_tx_channel = CONFIG_SPI_0_DMA_TX_CHANNEL,
+	.dma_rx_channel = CONFIG_SPI_0_DMA_RX_CHANNEL,
+#endif
 };
 
 static struct spi_qmsi_runtime spi_qmsi_mst_0_runtime;
@@ -394,6 +629,10 @@ static struct spi_qmsi_config spi_qmsi_mst_1_config = {
 	.cs_port = CONFIG_SPI_1_CS_GPIO_PORT,
 	.cs_pin = CONFIG_SPI_1_CS_GPIO_PIN,
 #endif
+#ifdef CONFIG_SPI_QMSI_DMA
+	.dma_tx_channel = CONFIG_SPI_1_DMA_TX_CHANNEL,
+	.dma_rx_channel = CONFIG_SPI_1_DMA_RX_CHANNEL,
+#endif
 };
 
 static struct spi_qmsi_runtime spi_qmsi_mst_1_runtime;
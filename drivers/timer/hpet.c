@@ -49,6 +49,11 @@
  * it expires on the next tick, and announces the number of elapsed ticks (if
  * any) to the microkernel.
  *
+ * When configured for the tickless kernel timer0 stays in one-shot mode and
+ * is programmed by the kernel to expire when the next timeout is due. The
+ * timer interrupt handler announces the complete ticks elapsed since the
+ * last announced tick, as read from the main counter.
+ *
  * In a nanokernel-only system this device driver omits more complex
  * capabilities (such as tickless idle support) that are only used with a
  * microkernel.
@@ -190,6 +195,10 @@ static uint32_t main_count_expected_value;
 extern uint32_t _hw_irq_to_c_handler_latency;
 #endif
 
+#ifdef CONFIG_INT_LATENCY_STATS
+extern void _int_latency_entry_record(uint32_t cycles);
+#endif
+
 #ifdef CONFIG_HPET_TIMER_DEBUG
 #include <misc/printk.h>
 #define PRINTK(...) printk(__VA_ARGS__)
@@ -209,6 +218,8 @@ static uint32_t __noinit counter_load_value;
 static uint64_t counter_last_value;
 /* # ticks timer is programmed for */
 static int32_t programmed_ticks = 1;
+/* most ticks timer is programmed for, less than a wrap of the 32-bit count */
+static int32_t __noinit max_programmed_ticks;
 /* is stale interrupt possible? */
 static int stale_irq_check;
 
@@ -263,12 +274,15 @@ void _timer_int_handler(void *unused)
 		/* keep the lowest value observed */
 		_hw_irq_to_c_handler_latency = delta;
 	}
+#ifdef CONFIG_INT_LATENCY_STATS
+	_int_latency_entry_record(delta);
+#endif
 	/* compute the next expected main counter value */
 	main_count_expected_value += main_count_first_irq_value;
 #endif
 
 
-#ifndef CONFIG_TICKLESS_IDLE
+#if !defined(CONFIG_TICKLESS_IDLE)
 
 	/*
 	 * one more tick has occurred -- don't need to do anything special since
@@ -277,6 +291,22 @@ void _timer_int_handler(void *unused)
 
 	_sys_clock_tick_announce();
 
+#elif defined(CONFIG_TICKLESS_KERNEL)
+
+	/*
+	 * announce the ticks elapsed since the last announced one, the kernel
+	 * then programs the timer for the next timeout; nothing has elapsed
+	 * on a stale interrupt, the timer is already programmed
+	 */
+
+	_sys_idle_elapsed_ticks = _timer_elapsed_get();
+	counter_last_value +=
+		(uint64_t)_sys_idle_elapsed_ticks * counter_load_value;
+
+	if (_sys_idle_elapsed_ticks) {
+		_sys_clock_tick_announce();
+	}
+
 #else
 
 	/* see if interrupt was triggered while timer was being reprogrammed */
@@ -318,7 +348,7 @@ void _timer_int_handler(void *unused)
  * @brief Place system timer into idle state
  *
  * Re-program the timer to enter into the idle state for the given number of
- * ticks (-1 means infinite number of ticks).
+ * ticks (-1 means as many as the timer can idle for).
  *
  * @return N/A
  *
@@ -329,6 +359,15 @@ void _timer_int_handler(void *unused)
 void _timer_idle_enter(int32_t ticks /* system ticks */
 				)
 {
+	/*
+	 * the kernel extends the 32-bit cycle count to 64 bits on each tick,
+	 * so the timer must not idle past a wrap of it
+	 */
+
+	if (ticks < 0 || ticks > max_programmed_ticks) {
+		ticks = max_programmed_ticks;
+	}
+
 	/*
 	 * reprogram timer to expire at the desired time (which is guaranteed
 	 * to be at least one full tick from the current counter value)
@@ -336,8 +375,7 @@ void _timer_idle_enter(int32_t ticks /* system ticks */
 
 	*_HPET_TIMER0_CONFIG_CAPS |= HPET_Tn_VAL_SET_CNF;
 	*_HPET_TIMER0_COMPARATOR =
-		(ticks >= 0) ? counter_last_value + ticks * counter_load_value
-			     : ~(uint64_t)0;
+		counter_last_value + (uint64_t)ticks * counter_load_value;
 	stale_irq_check = 1;
 	programmed_ticks = ticks;
 }
@@ -445,6 +483,60 @@ void _timer_idle_exit(void)
 
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+
+/**
+ *
+ * @brief Program the timer to expire on a given tick
+ *
+ * Program the timer to interrupt the given number of ticks after the last
+ * announced tick, but before the 32-bit cycle count wraps, which is also the
+ * expiry for K_FOREVER. If that tick is too close, or already past, it
+ * interrupts on the first tick that can be programmed safely instead.
+ *
+ * @return N/A
+ *
+ * \INTERNAL IMPLEMENTATION DETAILS
+ * Called while interrupts are locked.
+ */
+
+void _timer_expiry_set(int32_t ticks)
+{
+	uint64_t currTime = _hpetMainCounterAtomic();
+	uint64_t expiry;
+
+	if (ticks == K_FOREVER || ticks > max_programmed_ticks) {
+		ticks = max_programmed_ticks;
+	}
+
+	expiry = counter_last_value + (uint64_t)ticks * counter_load_value;
+
+	if (expiry <= currTime + HPET_COMP_DELAY) {
+		expiry = counter_last_value +
+			 ((currTime + HPET_COMP_DELAY - counter_last_value) /
+			  counter_load_value + 1) * counter_load_value;
+	}
+
+	*_HPET_TIMER0_CONFIG_CAPS |= HPET_Tn_VAL_SET_CNF;
+	*_HPET_TIMER0_COMPARATOR = expiry;
+	programmed_ticks = ticks;
+}
+
+/**
+ *
+ * @brief Get the number of ticks elapsed since the last announced tick
+ *
+ * @return number of whole ticks
+ */
+
+int32_t _timer_elapsed_get(void)
+{
+	return (int32_t)((_hpetMainCounterAtomic() - counter_last_value) /
+			 counter_load_value);
+}
+
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 /**
  *
  * @brief Initialize and enable the system clock
@@ -517,6 +609,10 @@ int _sys_clock_driver_init(struct device *device)
 									sys_clock_ticks_per_sec;
 
 
+#ifdef CONFIG_TICKLESS_IDLE
+	max_programmed_ticks = 0x7fffffff / counter_load_value;
+#endif
+
 #ifdef CONFIG_INT_LATENCY_BENCHMARK
 	main_count_first_irq_value = counter_load_value;
 	main_count_expected_value = main_count_first_irq_value;
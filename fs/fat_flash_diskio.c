@@ -16,18 +16,27 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <toolchain.h>
 #include <misc/__assert.h>
 #include <misc/util.h>
 #include <diskio.h>
 #include <ff.h>
 #include <device.h>
 #include <flash.h>
+#include <fs/fat_diskio.h>
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+#include "fat_flash_ftl.h"
+#endif
 
 static struct device *flash_dev;
 
+#ifndef CONFIG_FS_FAT_FLASH_FTL
 /* flash read-copy-erase-write operation */
 static uint8_t read_copy_buf[CONFIG_FS_BLOCK_SIZE];
 static uint8_t *fs_buff = read_copy_buf;
+#endif
 
 /* calculate number of blocks required for a given size */
 #define GET_NUM_BLOCK(total_size, block_size) \
@@ -36,6 +45,7 @@ static uint8_t *fs_buff = read_copy_buf;
 #define GET_SIZE_TO_BOUNDARY(start, block_size) \
 	(block_size - (start & (block_size - 1)))
 
+#ifndef CONFIG_FS_FAT_FLASH_FTL
 static off_t lba_to_address(uint32_t sector_num)
 {
 	off_t flash_addr;
@@ -45,6 +55,7 @@ static off_t lba_to_address(uint32_t sector_num)
 		 "FS bound error");
 	return flash_addr;
 }
+#endif
 
 DSTATUS fat_disk_status(void)
 {
@@ -66,11 +77,40 @@ DSTATUS fat_disk_initialize(void)
 		return STA_NOINIT;
 	}
 
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+	if (fat_flash_ftl_init(flash_dev) != 0) {
+		flash_dev = NULL;
+		return STA_NOINIT;
+	}
+#endif
+
 	return RES_OK;
 }
 
-DRESULT fat_disk_read(void *buff, uint32_t start_sector,
-		      uint32_t sector_count)
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+static DRESULT flash_disk_read(void *buff, uint32_t start_sector,
+			       uint32_t sector_count)
+{
+	if (fat_flash_ftl_read(buff, start_sector, sector_count) != 0) {
+		return RES_ERROR;
+	}
+
+	return RES_OK;
+}
+
+static DRESULT flash_disk_write(const void *buff, uint32_t start_sector,
+				uint32_t sector_count)
+{
+	if (fat_flash_ftl_write(buff, start_sector, sector_count) != 0) {
+		return RES_ERROR;
+	}
+
+	return RES_OK;
+}
+#else
+
+static DRESULT flash_disk_read(void *buff, uint32_t start_sector,
+			       uint32_t sector_count)
 {
 	off_t fl_addr;
 	uint32_t remaining;
@@ -184,8 +224,8 @@ static DRESULT update_flash_block(off_t start_addr, uint32_t size,
 	return RES_OK;
 }
 
-DRESULT fat_disk_write(const void *buff, uint32_t start_sector,
-		       uint32_t sector_count)
+static DRESULT flash_disk_write(const void *buff, uint32_t start_sector,
+				uint32_t sector_count)
 {
 	off_t fl_addr;
 	uint32_t remaining;
@@ -247,18 +287,299 @@ DRESULT fat_disk_write(const void *buff, uint32_t start_sector,
 
 	return RES_OK;
 }
+#endif /* CONFIG_FS_FAT_FLASH_FTL */
+
+#ifdef CONFIG_FS_FAT_FLASH_CACHE
+/*
+ * Write-back sector cache. Sectors map to a set by sector number and
+ * the least recently used entry of the set is replaced. Dirty sectors
+ * are written back an erase block at a time, together with all other
+ * dirty sectors of the same erase block.
+ */
+
+#define CACHE_SETS (CONFIG_FS_FAT_FLASH_CACHE_SECTORS / \
+		    CONFIG_FS_FAT_FLASH_CACHE_WAYS)
+#define SECTORS_PER_BLOCK (CONFIG_FS_BLOCK_SIZE / _MIN_SS)
+
+BUILD_ASSERT(CONFIG_FS_FAT_FLASH_CACHE_SECTORS %
+	     CONFIG_FS_FAT_FLASH_CACHE_WAYS == 0);
+
+struct cache_entry {
+	uint32_t sector;
+	uint32_t last_used;
+	bool valid;
+	bool dirty;
+};
+
+static struct cache_entry cache[CONFIG_FS_FAT_FLASH_CACHE_SECTORS];
+static uint8_t cache_data[CONFIG_FS_FAT_FLASH_CACHE_SECTORS][_MIN_SS];
+static uint32_t cache_clock;
+
+static struct fat_flash_cache_stats cache_stats;
+
+static inline struct cache_entry *cache_set(uint32_t sector)
+{
+	return &cache[(sector % CACHE_SETS) * CONFIG_FS_FAT_FLASH_CACHE_WAYS];
+}
+
+static inline uint8_t *entry_data(struct cache_entry *entry)
+{
+	return cache_data[entry - cache];
+}
+
+static struct cache_entry *cache_lookup(uint32_t sector)
+{
+	struct cache_entry *entry = cache_set(sector);
+	int i;
+
+	for (i = 0; i < CONFIG_FS_FAT_FLASH_CACHE_WAYS; i++, entry++) {
+		if (entry->valid && entry->sector == sector) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/* Write back the dirty sectors in the erase block of a sector */
+static DRESULT cache_flush_block(uint32_t sector)
+{
+	uint32_t first = ROUND_DOWN(sector, SECTORS_PER_BLOCK);
+	struct cache_entry *entry;
+	int i;
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+	/* The FTL does not erase per write, no need to merge the block */
+	for (i = 0, entry = cache; i < ARRAY_SIZE(cache); i++, entry++) {
+		if (!entry->dirty || entry->sector < first ||
+		    entry->sector >= first + SECTORS_PER_BLOCK) {
+			continue;
+		}
+
+		if (flash_disk_write(entry_data(entry), entry->sector,
+				     1) != RES_OK) {
+			return RES_ERROR;
+		}
+
+		entry->dirty = false;
+	}
+#else
+	/* Merge the dirty sectors into the block and program it once */
+	if (flash_disk_read(fs_buff, first, SECTORS_PER_BLOCK) != RES_OK) {
+		return RES_ERROR;
+	}
+
+	for (i = 0, entry = cache; i < ARRAY_SIZE(cache); i++, entry++) {
+		if (!entry->dirty || entry->sector < first ||
+		    entry->sector >= first + SECTORS_PER_BLOCK) {
+			continue;
+		}
+
+		memcpy(fs_buff + (entry->sector - first) * _MIN_SS,
+		       entry_data(entry), _MIN_SS);
+	}
+
+	if (flash_disk_write(fs_buff, first, SECTORS_PER_BLOCK) != RES_OK) {
+		return RES_ERROR;
+	}
+
+	for (i = 0, entry = cache; i < ARRAY_SIZE(cache); i++, entry++) {
+		if (entry->sector >= first &&
+		    entry->sector < first + SECTORS_PER_BLOCK) {
+			entry->dirty = false;
+		}
+	}
+#endif
+
+	cache_stats.block_writes++;
+
+	return RES_OK;
+}
+
+static DRESULT cache_flush(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].dirty && cache_flush_block(cache[i].sector)) {
+			return RES_ERROR;
+		}
+	}
+
+	return RES_OK;
+}
+
+/* Get an entry for a sector, replacing the least recently used one */
+static struct cache_entry *cache_alloc(uint32_t sector)
+{
+	struct cache_entry *entry = cache_set(sector);
+	struct cache_entry *victim = entry;
+	int i;
+
+	for (i = 0; i < CONFIG_FS_FAT_FLASH_CACHE_WAYS; i++, entry++) {
+		if (!entry->valid) {
+			victim = entry;
+			break;
+		}
+
+		if (entry->last_used < victim->last_used) {
+			victim = entry;
+		}
+	}
+
+	if (victim->dirty) {
+		if (cache_flush_block(victim->sector) != RES_OK) {
+			return NULL;
+		}
+	}
+
+	if (victim->valid) {
+		cache_stats.evictions++;
+	}
+
+	victim->sector = sector;
+	victim->valid = true;
+	victim->dirty = false;
+
+	return victim;
+}
+
+static DRESULT cache_read(uint8_t *buff, uint32_t start_sector,
+			  uint32_t sector_count)
+{
+	struct cache_entry *entry;
+	uint32_t i;
+
+	if (sector_count > 1) {
+		/* Large reads are file data, do not let them flush the cache */
+		if (flash_disk_read(buff, start_sector,
+				    sector_count) != RES_OK) {
+			return RES_ERROR;
+		}
+
+		for (i = 0; i < sector_count; i++) {
+			entry = cache_lookup(start_sector + i);
+			if (entry && entry->dirty) {
+				memcpy(buff + i * _MIN_SS, entry_data(entry),
+				       _MIN_SS);
+			}
+		}
+
+		return RES_OK;
+	}
+
+	entry = cache_lookup(start_sector);
+	if (entry) {
+		cache_stats.hits++;
+	} else {
+		cache_stats.misses++;
+
+		entry = cache_alloc(start_sector);
+		if (!entry) {
+			return RES_ERROR;
+		}
+
+		if (flash_disk_read(entry_data(entry), start_sector,
+				    1) != RES_OK) {
+			entry->valid = false;
+			return RES_ERROR;
+		}
+	}
+
+	entry->last_used = ++cache_clock;
+	memcpy(buff, entry_data(entry), _MIN_SS);
+
+	return RES_OK;
+}
+
+static DRESULT cache_write(const uint8_t *buff, uint32_t start_sector,
+			   uint32_t sector_count)
+{
+	struct cache_entry *entry;
+	uint32_t i;
+
+	if (sector_count > 1) {
+		/* Written through, cached copies are stale now */
+		for (i = 0; i < sector_count; i++) {
+			entry = cache_lookup(start_sector + i);
+			if (entry) {
+				entry->valid = false;
+				entry->dirty = false;
+			}
+		}
+
+		return flash_disk_write(buff, start_sector, sector_count);
+	}
+
+	entry = cache_lookup(start_sector);
+	if (entry) {
+		cache_stats.hits++;
+	} else {
+		cache_stats.misses++;
+
+		entry = cache_alloc(start_sector);
+		if (!entry) {
+			return RES_ERROR;
+		}
+	}
+
+	entry->last_used = ++cache_clock;
+	entry->dirty = true;
+	memcpy(entry_data(entry), buff, _MIN_SS);
+
+	return RES_OK;
+}
+
+void fat_flash_cache_get_stats(struct fat_flash_cache_stats *stats)
+{
+	*stats = cache_stats;
+}
+#endif /* CONFIG_FS_FAT_FLASH_CACHE */
+
+DRESULT fat_disk_read(uint8_t *buff, unsigned long start_sector,
+		      uint32_t sector_count)
+{
+#ifdef CONFIG_FS_FAT_FLASH_CACHE
+	return cache_read(buff, start_sector, sector_count);
+#else
+	return flash_disk_read(buff, start_sector, sector_count);
+#endif
+}
+
+DRESULT fat_disk_write(const uint8_t *buff, unsigned long start_sector,
+		       uint32_t sector_count)
+{
+#ifdef CONFIG_FS_FAT_FLASH_CACHE
+	return cache_write(buff, start_sector, sector_count);
+#else
+	return flash_disk_write(buff, start_sector, sector_count);
+#endif
+}
 
 DRESULT fat_disk_ioctl(uint8_t cmd, void *buff)
 {
 	switch (cmd) {
 	case CTRL_SYNC:
+#ifdef CONFIG_FS_FAT_FLASH_CACHE
+		return cache_flush();
+#else
+		return RES_OK;
+#endif
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+	case GET_SECTOR_COUNT:
+		*(uint32_t *)buff = fat_flash_ftl_sector_count();
+		return RES_OK;
+	case GET_BLOCK_SIZE: /* sectors are remapped, no erase alignment */
+		*(uint32_t *)buff = 1;
 		return RES_OK;
+#else
 	case GET_SECTOR_COUNT:
 		*(uint32_t *)buff = CONFIG_FS_VOLUME_SIZE / _MIN_SS;
 		return RES_OK;
 	case GET_BLOCK_SIZE: /* in sectors */
 		*(uint32_t *)buff = CONFIG_FS_BLOCK_SIZE / _MIN_SS;
 		return RES_OK;
+#endif
 	case CTRL_TRIM:
 		break;
 	}
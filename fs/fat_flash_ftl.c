@@ -0,0 +1,692 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Log-structured flash translation layer.
+ *
+ * Every erase block is split in sector sized slots. The first slot holds a
+ * header with the erase count of the block, a sequence number and the
+ * logical sector number of each data slot. Sectors are always written to
+ * the next free slot of the active block and the old copy becomes stale.
+ * The sector map is rebuilt from the headers at init, the copy in the
+ * block with the highest sequence number wins.
+ *
+ * Garbage collection copies the valid sectors of a full block to the
+ * active block, after which the block is free and is erased when it is
+ * allocated again. Free blocks are allocated by lowest erase count, and
+ * blocks holding static data are collected when they fall too far behind
+ * the most worn block.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <misc/util.h>
+#include <nanokernel.h>
+#include <toolchain.h>
+#include <ff.h>
+#include <device.h>
+#include <flash.h>
+#include <fs/fat_diskio.h>
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL_BACKGROUND_GC
+#include <misc/nano_work.h>
+#endif
+
+#include "fat_flash_ftl.h"
+
+#define FTL_MAGIC 0x314c5446 /* "FTL1" */
+
+#define FTL_BLOCKS (CONFIG_FS_VOLUME_SIZE / CONFIG_FS_BLOCK_SIZE)
+#define FTL_SLOTS (CONFIG_FS_BLOCK_SIZE / _MIN_SS)
+#define FTL_DATA_SLOTS (FTL_SLOTS - 1)
+#define FTL_SECTORS \
+	((FTL_BLOCKS - CONFIG_FS_FAT_FLASH_FTL_SPARE_BLOCKS) * FTL_DATA_SLOTS)
+
+#define FTL_UNMAPPED 0xffff
+#define FTL_TAG_FREE 0xffffffff
+
+/* One free block is kept for garbage collection to write to */
+#define FTL_MIN_FREE_BLOCKS 1
+
+BUILD_ASSERT(FTL_BLOCKS > CONFIG_FS_FAT_FLASH_FTL_SPARE_BLOCKS);
+BUILD_ASSERT(FTL_BLOCKS * FTL_SLOTS < FTL_UNMAPPED);
+BUILD_ASSERT(FTL_SLOTS >= 2 && FTL_SLOTS <= 256);
+
+struct ftl_header {
+	uint32_t magic;
+	uint32_t erase_count;
+	uint32_t seq;
+	/* Logical sector stored in each data slot */
+	uint32_t tags[FTL_DATA_SLOTS];
+};
+
+BUILD_ASSERT(sizeof(struct ftl_header) <= _MIN_SS);
+
+enum ftl_block_state {
+	FTL_BLOCK_DIRTY,	/* no valid data, needs an erase */
+	FTL_BLOCK_ERASED,	/* no valid data, erased */
+	FTL_BLOCK_ACTIVE,	/* sectors are being written to it */
+	FTL_BLOCK_FULL,
+};
+
+struct ftl_block {
+	uint32_t erase_count;
+	uint32_t seq;
+	uint8_t state;
+	/* Data slots programmed */
+	uint8_t used;
+	/* Data slots holding the current copy of a sector */
+	uint8_t valid;
+};
+
+static struct device *flash_dev;
+static struct nano_sem ftl_lock;
+
+/* Logical sector to physical slot */
+static uint16_t sector_map[FTL_SECTORS];
+static struct ftl_block blocks[FTL_BLOCKS];
+static int active_block = -1;
+static uint32_t free_blocks;
+static uint32_t next_seq;
+
+static struct ftl_header header_buf;
+static uint8_t gc_buf[_MIN_SS];
+
+static struct fat_flash_ftl_stats ftl_stats;
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL_BACKGROUND_GC
+static struct nano_work gc_work;
+#endif
+
+static inline off_t block_address(int block)
+{
+	return CONFIG_FS_FLASH_START + (off_t)block * CONFIG_FS_BLOCK_SIZE;
+}
+
+static inline off_t slot_address(uint16_t slot)
+{
+	return CONFIG_FS_FLASH_START + (off_t)slot * _MIN_SS;
+}
+
+static inline uint16_t data_slot(int block, int index)
+{
+	return block * FTL_SLOTS + 1 + index;
+}
+
+static int ftl_flash_read(off_t addr, void *buff, uint32_t len)
+{
+	uint8_t *dst = buff;
+	uint32_t size;
+
+	while (len) {
+		size = min(len, CONFIG_FS_FLASH_MAX_RW_SIZE);
+
+		if (flash_read(flash_dev, addr, dst, size) != 0) {
+			return -EIO;
+		}
+
+		addr += size;
+		dst += size;
+		len -= size;
+	}
+
+	return 0;
+}
+
+static int ftl_flash_write(off_t addr, const void *buff, uint32_t len)
+{
+	const uint8_t *src = buff;
+	uint32_t size;
+
+	while (len) {
+		size = min(len, CONFIG_FS_FLASH_MAX_RW_SIZE);
+
+		/* flash_write reenables write-protection */
+		flash_write_protection_set(flash_dev, false);
+
+		if (flash_write(flash_dev, addr, src, size) != 0) {
+			return -EIO;
+		}
+
+		addr += size;
+		src += size;
+		len -= size;
+	}
+
+	return 0;
+}
+
+static int read_header(int block)
+{
+	return ftl_flash_read(block_address(block), &header_buf,
+			      sizeof(header_buf));
+}
+
+/* Pick the free block with the lowest erase count and make it active */
+static int allocate_block(void)
+{
+	struct ftl_header hdr;
+	int block = -1;
+	int i;
+
+	for (i = 0; i < FTL_BLOCKS; i++) {
+		if (blocks[i].state != FTL_BLOCK_DIRTY &&
+		    blocks[i].state != FTL_BLOCK_ERASED) {
+			continue;
+		}
+
+		if (block < 0 ||
+		    blocks[i].erase_count < blocks[block].erase_count) {
+			block = i;
+		}
+	}
+
+	if (block < 0) {
+		return -ENOSPC;
+	}
+
+	if (blocks[block].state == FTL_BLOCK_DIRTY) {
+		flash_write_protection_set(flash_dev, false);
+		if (flash_erase(flash_dev, block_address(block),
+				CONFIG_FS_BLOCK_SIZE) != 0) {
+			return -EIO;
+		}
+
+		blocks[block].erase_count++;
+		blocks[block].state = FTL_BLOCK_ERASED;
+		ftl_stats.erases++;
+	}
+
+	memset(&hdr, 0xff, sizeof(hdr));
+	hdr.magic = FTL_MAGIC;
+	hdr.erase_count = blocks[block].erase_count;
+	hdr.seq = next_seq;
+
+	if (ftl_flash_write(block_address(block), &hdr,
+			    offsetof(struct ftl_header, tags)) != 0) {
+		/* Try another block next time */
+		blocks[block].state = FTL_BLOCK_DIRTY;
+		return -EIO;
+	}
+
+	blocks[block].seq = next_seq++;
+	blocks[block].state = FTL_BLOCK_ACTIVE;
+	blocks[block].used = 0;
+	blocks[block].valid = 0;
+	free_blocks--;
+
+	active_block = block;
+
+	return 0;
+}
+
+static void invalidate_slot(uint16_t slot)
+{
+	struct ftl_block *blk = &blocks[slot / FTL_SLOTS];
+
+	blk->valid--;
+
+	if (blk->state == FTL_BLOCK_FULL && !blk->valid) {
+		blk->state = FTL_BLOCK_DIRTY;
+		free_blocks++;
+	}
+}
+
+/* Write a sector to the next free slot and remap it */
+static int program_sector(uint32_t sector, const uint8_t *buff)
+{
+	struct ftl_block *blk;
+	uint32_t tag = sector;
+	uint16_t slot;
+	int index;
+	int ret;
+
+	if (active_block < 0 ||
+	    blocks[active_block].used == FTL_DATA_SLOTS) {
+		if (active_block >= 0) {
+			blocks[active_block].state = FTL_BLOCK_FULL;
+
+			if (!blocks[active_block].valid) {
+				blocks[active_block].state = FTL_BLOCK_DIRTY;
+				free_blocks++;
+			}
+		}
+
+		active_block = -1;
+
+		ret = allocate_block();
+		if (ret) {
+			return ret;
+		}
+	}
+
+	blk = &blocks[active_block];
+	index = blk->used;
+	slot = data_slot(active_block, index);
+
+	/* The slot is consumed even if programming fails */
+	blk->used++;
+
+	if (ftl_flash_write(slot_address(slot), buff, _MIN_SS) != 0) {
+		return -EIO;
+	}
+
+	/* The tag is written last, a sector is only valid with its data */
+	if (ftl_flash_write(block_address(active_block) +
+			    offsetof(struct ftl_header, tags[index]),
+			    &tag, sizeof(tag)) != 0) {
+		return -EIO;
+	}
+
+	if (sector_map[sector] != FTL_UNMAPPED) {
+		invalidate_slot(sector_map[sector]);
+	}
+
+	sector_map[sector] = slot;
+	blk->valid++;
+
+	ftl_stats.flash_writes++;
+
+	return 0;
+}
+
+/* The full block with the fewest valid sectors is the cheapest to collect */
+static int select_victim(void)
+{
+	int victim = -1;
+	int i;
+
+	for (i = 0; i < FTL_BLOCKS; i++) {
+		if (blocks[i].state != FTL_BLOCK_FULL) {
+			continue;
+		}
+
+		if (victim < 0 || blocks[i].valid < blocks[victim].valid) {
+			victim = i;
+		}
+	}
+
+	return victim;
+}
+
+/* The full block that was erased least, if it lags too far behind */
+static int select_cold_block(void)
+{
+	uint32_t max_erase_count = 0;
+	int cold = -1;
+	int i;
+
+	for (i = 0; i < FTL_BLOCKS; i++) {
+		max_erase_count = max(max_erase_count, blocks[i].erase_count);
+
+		if (blocks[i].state != FTL_BLOCK_FULL) {
+			continue;
+		}
+
+		if (cold < 0 ||
+		    blocks[i].erase_count < blocks[cold].erase_count) {
+			cold = i;
+		}
+	}
+
+	if (cold < 0 || max_erase_count - blocks[cold].erase_count <=
+	    CONFIG_FS_FAT_FLASH_FTL_WEAR_LEVEL_THRESHOLD) {
+		return -1;
+	}
+
+	return cold;
+}
+
+/* Move the valid sectors of one full block so that it can be reused */
+static int collect_block(int victim)
+{
+	uint32_t tags[FTL_DATA_SLOTS];
+	uint16_t slot;
+	int used;
+	int i;
+
+	if (read_header(victim) != 0) {
+		return -EIO;
+	}
+
+	memcpy(tags, header_buf.tags, sizeof(tags));
+	used = blocks[victim].used;
+
+	for (i = 0; i < used && blocks[victim].valid; i++) {
+		slot = data_slot(victim, i);
+
+		if (tags[i] >= FTL_SECTORS || sector_map[tags[i]] != slot) {
+			continue;
+		}
+
+		if (ftl_flash_read(slot_address(slot), gc_buf,
+				   _MIN_SS) != 0) {
+			return -EIO;
+		}
+
+		if (program_sector(tags[i], gc_buf) != 0) {
+			return -EIO;
+		}
+
+		ftl_stats.gc_moves++;
+	}
+
+	return 0;
+}
+
+static int collect_garbage(void)
+{
+	int victim;
+
+	victim = select_victim();
+	if (victim < 0) {
+		return -ENOSPC;
+	}
+
+	return collect_block(victim);
+}
+
+/*
+ * Move the data of a block that is rarely rewritten so that the block
+ * takes its share of erases.
+ */
+static int level_wear(void)
+{
+	int cold;
+
+	cold = select_cold_block();
+	if (cold < 0) {
+		return 0;
+	}
+
+	return collect_block(cold);
+}
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL_BACKGROUND_GC
+static void gc_work_handler(struct nano_work *work)
+{
+	uint32_t prev_free;
+
+	nano_sem_take(&ftl_lock, TICKS_UNLIMITED);
+
+	prev_free = free_blocks;
+
+	/* One block per run so that file system calls are not held off */
+	if (free_blocks < CONFIG_FS_FAT_FLASH_FTL_GC_FREE_BLOCKS &&
+	    !collect_garbage() && free_blocks > prev_free &&
+	    free_blocks < CONFIG_FS_FAT_FLASH_FTL_GC_FREE_BLOCKS) {
+		nano_work_submit(&gc_work);
+	}
+
+	nano_sem_give(&ftl_lock);
+}
+#endif
+
+/* Returns true if the copy in slot a is newer than the one in slot b */
+static bool slot_is_newer(uint16_t a, uint16_t b)
+{
+	struct ftl_block *blk_a = &blocks[a / FTL_SLOTS];
+	struct ftl_block *blk_b = &blocks[b / FTL_SLOTS];
+
+	if (blk_a == blk_b) {
+		return a > b;
+	}
+
+	return (int32_t)(blk_a->seq - blk_b->seq) > 0;
+}
+
+static int scan_block(int block)
+{
+	struct ftl_block *blk = &blocks[block];
+	uint32_t sector;
+	uint16_t slot;
+	int i;
+
+	if (read_header(block) != 0) {
+		return -EIO;
+	}
+
+	if (header_buf.magic != FTL_MAGIC) {
+		/* Blank or not written by the FTL */
+		blk->state = FTL_BLOCK_DIRTY;
+		return 0;
+	}
+
+	blk->erase_count = header_buf.erase_count;
+	blk->seq = header_buf.seq;
+	blk->state = FTL_BLOCK_FULL;
+
+	if (!next_seq || (int32_t)(blk->seq - next_seq) >= 0) {
+		next_seq = blk->seq + 1;
+	}
+
+	blk->used = 0;
+
+	for (i = 0; i < FTL_DATA_SLOTS; i++) {
+		sector = header_buf.tags[i];
+		if (sector == FTL_TAG_FREE) {
+			/* Unused, or programming failed before the tag */
+			continue;
+		}
+
+		blk->used = i + 1;
+
+		if (sector >= FTL_SECTORS) {
+			continue;
+		}
+
+		slot = data_slot(block, i);
+
+		if (sector_map[sector] != FTL_UNMAPPED) {
+			if (!slot_is_newer(slot, sector_map[sector])) {
+				continue;
+			}
+
+			blocks[sector_map[sector] / FTL_SLOTS].valid--;
+		}
+
+		sector_map[sector] = slot;
+		blk->valid++;
+	}
+
+	return 0;
+}
+
+/* Continue writing to the newest block if its next slot is still erased */
+static void resume_active_block(void)
+{
+	int block = -1;
+	int i;
+
+	for (i = 0; i < FTL_BLOCKS; i++) {
+		if (blocks[i].state != FTL_BLOCK_FULL) {
+			continue;
+		}
+
+		if (block < 0 ||
+		    (int32_t)(blocks[i].seq - blocks[block].seq) > 0) {
+			block = i;
+		}
+	}
+
+	if (block < 0 || blocks[block].used == FTL_DATA_SLOTS) {
+		return;
+	}
+
+	/* A slot may have been programmed without its tag */
+	if (ftl_flash_read(slot_address(data_slot(block, blocks[block].used)),
+			   gc_buf, _MIN_SS) != 0) {
+		return;
+	}
+
+	for (i = 0; i < _MIN_SS; i++) {
+		if (gc_buf[i] != 0xff) {
+			return;
+		}
+	}
+
+	blocks[block].state = FTL_BLOCK_ACTIVE;
+	active_block = block;
+}
+
+int fat_flash_ftl_init(struct device *dev)
+{
+	int i;
+
+	flash_dev = dev;
+
+	nano_sem_init(&ftl_lock);
+	nano_sem_give(&ftl_lock);
+
+	memset(sector_map, 0xff, sizeof(sector_map));
+	memset(blocks, 0, sizeof(blocks));
+	memset(&ftl_stats, 0, sizeof(ftl_stats));
+	next_seq = 0;
+
+	for (i = 0; i < FTL_BLOCKS; i++) {
+		if (scan_block(i) != 0) {
+			return -EIO;
+		}
+	}
+
+	active_block = -1;
+	free_blocks = 0;
+
+	resume_active_block();
+
+	for (i = 0; i < FTL_BLOCKS; i++) {
+		if (blocks[i].state == FTL_BLOCK_FULL && !blocks[i].valid) {
+			blocks[i].state = FTL_BLOCK_DIRTY;
+		}
+
+		if (blocks[i].state == FTL_BLOCK_DIRTY) {
+			free_blocks++;
+		}
+	}
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL_BACKGROUND_GC
+	nano_work_init(&gc_work, gc_work_handler);
+#endif
+
+	return 0;
+}
+
+int fat_flash_ftl_read(uint8_t *buff, uint32_t sector, uint32_t count)
+{
+	int ret = 0;
+
+	if (sector + count > FTL_SECTORS) {
+		return -EINVAL;
+	}
+
+	nano_sem_take(&ftl_lock, TICKS_UNLIMITED);
+
+	for (; count; count--, sector++, buff += _MIN_SS) {
+		if (sector_map[sector] == FTL_UNMAPPED) {
+			/* Never written, read it as erased flash */
+			memset(buff, 0xff, _MIN_SS);
+			continue;
+		}
+
+		ret = ftl_flash_read(slot_address(sector_map[sector]), buff,
+				     _MIN_SS);
+		if (ret) {
+			break;
+		}
+	}
+
+	nano_sem_give(&ftl_lock);
+
+	return ret;
+}
+
+int fat_flash_ftl_write(const uint8_t *buff, uint32_t sector,
+			uint32_t count)
+{
+	uint32_t erases;
+	int ret = 0;
+
+	if (sector + count > FTL_SECTORS) {
+		return -EINVAL;
+	}
+
+	nano_sem_take(&ftl_lock, TICKS_UNLIMITED);
+
+	erases = ftl_stats.erases;
+
+	for (; count; count--, sector++, buff += _MIN_SS) {
+		/* Make room before the last free block would be taken */
+		while ((active_block < 0 ||
+			blocks[active_block].used == FTL_DATA_SLOTS) &&
+		       free_blocks <= FTL_MIN_FREE_BLOCKS) {
+			ret = collect_garbage();
+			if (ret) {
+				goto out;
+			}
+		}
+
+		ret = program_sector(sector, buff);
+		if (ret) {
+			goto out;
+		}
+
+		ftl_stats.host_writes++;
+	}
+
+	/* Only erases can make the wear uneven */
+	if (ftl_stats.erases != erases) {
+		ret = level_wear();
+	}
+
+out:
+#ifdef CONFIG_FS_FAT_FLASH_FTL_BACKGROUND_GC
+	if (free_blocks < CONFIG_FS_FAT_FLASH_FTL_GC_FREE_BLOCKS) {
+		nano_work_submit(&gc_work);
+	}
+#endif
+
+	nano_sem_give(&ftl_lock);
+
+	return ret;
+}
+
+uint32_t fat_flash_ftl_sector_count(void)
+{
+	return FTL_SECTORS;
+}
+
+void fat_flash_ftl_get_stats(struct fat_flash_ftl_stats *stats)
+{
+	int i;
+
+	nano_sem_take(&ftl_lock, TICKS_UNLIMITED);
+
+	*stats = ftl_stats;
+	stats->free_blocks = free_blocks;
+	stats->min_erase_count = blocks[0].erase_count;
+	stats->max_erase_count = blocks[0].erase_count;
+
+	for (i = 1; i < FTL_BLOCKS; i++) {
+		stats->min_erase_count = min(stats->min_erase_count,
+					     blocks[i].erase_count);
+		stats->max_erase_count = max(stats->max_erase_count,
+					     blocks[i].erase_count);
+	}
+
+	nano_sem_give(&ftl_lock);
+}
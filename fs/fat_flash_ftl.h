@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _FAT_FLASH_FTL_H_
+#define _FAT_FLASH_FTL_H_
+
+#include <stdint.h>
+#include <device.h>
+
+/* Flash translation layer used by fat_flash_diskio.c */
+
+int fat_flash_ftl_init(struct device *dev);
+int fat_flash_ftl_read(uint8_t *buff, uint32_t sector, uint32_t count);
+int fat_flash_ftl_write(const uint8_t *buff, uint32_t sector,
+			uint32_t count);
+uint32_t fat_flash_ftl_sector_count(void);
+
+#endif /* _FAT_FLASH_FTL_H_ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Emulated I2C and SPI masters and their device models
+ *
+ * The emulated masters implement the I2C and SPI driver APIs in software
+ * and forward the register accesses to the model attached at the slave
+ * address, or slave select, being talked to. They count the transfers and
+ * bytes that go over the bus.
+ */
+
+#ifndef __BUS_EMUL_H__
+#define __BUS_EMUL_H__
+
+#include <stdint.h>
+#include <device.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bus_emul_model;
+
+/**
+ * @brief Register accesses of a device model.
+ *
+ * @a reg is the register address byte as sent by the driver, minus the
+ * read bit on SPI. Models auto-increment the address over the @a len
+ * bytes the way the device does. @a reset, if set, puts the registers in
+ * their power-on state when the model is attached.
+ */
+struct bus_emul_model_api {
+	void (*reset)(struct bus_emul_model *model);
+	int (*read)(struct bus_emul_model *model, uint8_t reg, uint8_t *buf,
+		    uint32_t len);
+	int (*write)(struct bus_emul_model *model, uint8_t reg,
+		     const uint8_t *buf, uint32_t len);
+};
+
+struct bus_emul_model {
+	/** I2C slave address, or SPI slave select, the model answers to */
+	uint32_t addr;
+	const struct bus_emul_model_api *api;
+	/* private */
+	sys_snode_t node;
+};
+
+struct bus_emul_stats {
+	/** Calls of i2c_transfer() or spi_transceive() */
+	uint32_t transfers;
+	/** I2C messages, one per SPI transfer */
+	uint32_t messages;
+	/** Bytes clocked on the bus, including I2C address bytes */
+	uint32_t bytes;
+	/** Transfers to an address no model answers to */
+	uint32_t nacks;
+};
+
+/**
+ * @brief Attach a model to an emulated master.
+ *
+ * The models enabled in Kconfig are attached when the master is
+ * initialized, this adds one, e.g. from a test.
+ *
+ * @param dev Emulated I2C or SPI master.
+ * @param model Model, with its address set.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a model already answers to the address.
+ */
+int bus_emul_attach(struct device *dev, struct bus_emul_model *model);
+
+/**
+ * @brief Get the bus counters of an emulated master.
+ *
+ * @param dev Emulated I2C or SPI master.
+ * @param stats Filled with the current counters.
+ */
+void bus_emul_get_stats(struct device *dev, struct bus_emul_stats *stats);
+
+/**
+ * @brief Reset the bus counters of an emulated master.
+ *
+ * @param dev Emulated I2C or SPI master.
+ */
+void bus_emul_reset_stats(struct device *dev);
+
+#ifdef CONFIG_BUS_EMUL_BMI160
+/**
+ * @brief Set the sample in the data registers of the BMI160 model.
+ */
+void bus_emul_bmi160_set_sample(const int16_t gyro[3],
+				const int16_t accel[3]);
+
+/**
+ * @brief Queue samples in the FIFO of the BMI160 model.
+ *
+ * The axes of sample @a seq are set to bus_emul_bmi160_gyro() and
+ * bus_emul_bmi160_accel(), for the sensors enabled in FIFO_CONFIG1.
+ *
+ * @return Number of samples that fit in the FIFO.
+ */
+int bus_emul_bmi160_fifo_fill(int samples, int seq);
+
+static inline int16_t bus_emul_bmi160_gyro(int seq, int axis)
+{
+	return (int16_t)(seq * 3 + axis);
+}
+
+static inline int16_t bus_emul_bmi160_accel(int seq, int axis)
+{
+	return (int16_t)-(seq * 3 + axis);
+}
+#endif
+
+#ifdef CONFIG_BUS_EMUL_BME280
+/**
+ * @brief Set the raw ADC values read by the BME280 model.
+ *
+ * The model has the calibration of the compensation example of the Bosch
+ * datasheets, where @a temp 519888 reads as 25.08 degrees Celsius, and
+ * @a press 415148 as 100653 Pa.
+ */
+void bus_emul_bme280_set_adc(uint32_t temp, uint32_t press, uint16_t hum);
+#endif
+
+#ifdef CONFIG_BUS_EMUL_HTS221
+/**
+ * @brief Set the raw output values read by the HTS221 model.
+ *
+ * The calibration of the model maps @a hum_out 0 to 20 %RH and 6000 to
+ * 80 %RH, and @a temp_out 0 to 10 and 3000 to 40 degrees Celsius.
+ */
+void bus_emul_hts221_set_out(int16_t hum_out, int16_t temp_out);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BUS_EMUL_H__ */
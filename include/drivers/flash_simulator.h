@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Counters of the RAM backed flash simulator
+ */
+
+#ifndef __FLASH_SIMULATOR_H__
+#define __FLASH_SIMULATOR_H__
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct flash_simulator_stats {
+	/** Bytes returned by flash_read() */
+	uint32_t bytes_read;
+	/** Bytes programmed by flash_write() */
+	uint32_t bytes_written;
+	/** Erase units erased */
+	uint32_t erases;
+	/** Lowest and highest erase count of any erase unit */
+	uint32_t min_erase_count;
+	uint32_t max_erase_count;
+	/** Writes and erases rejected while write protected */
+	uint32_t protection_errors;
+	/** Writes rejected because the bytes were not erased */
+	uint32_t program_errors;
+};
+
+/**
+ * @brief Get the counters of a flash simulator device.
+ *
+ * @param dev Flash simulator device.
+ * @param stats Filled with the current counters.
+ */
+void flash_simulator_get_stats(struct device *dev,
+			       struct flash_simulator_stats *stats);
+
+/**
+ * @brief Get the number of times an erase unit was erased.
+ *
+ * @param dev Flash simulator device.
+ * @param offset Any offset inside the erase unit.
+ *
+ * @return Erase count, 0 for an offset outside of the flash.
+ */
+uint32_t flash_simulator_erase_count(struct device *dev, off_t offset);
+
+/**
+ * @brief Reset all counters, including the erase counts.
+ *
+ * @param dev Flash simulator device.
+ */
+void flash_simulator_reset_stats(struct device *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_SIMULATOR_H__ */
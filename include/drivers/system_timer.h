@@ -55,6 +55,18 @@ extern void _timer_idle_enter(int32_t ticks);
 extern void _timer_idle_exit(void);
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * Program the timer to interrupt 'ticks' after the last announced tick,
+ * or as late as it can for K_FOREVER. On interrupt the driver announces
+ * the ticks elapsed since, and the kernel programs the next expiry.
+ */
+extern void _timer_expiry_set(int32_t ticks);
+
+/* number of whole ticks elapsed since the last announced tick */
+extern int32_t _timer_elapsed_get(void);
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 #ifndef CONFIG_KERNEL_V2
 extern uint32_t _nano_get_earliest_deadline(void);
 #endif /* CONFIG_KERNEL_V2 */
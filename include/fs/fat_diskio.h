@@ -27,4 +27,41 @@ DRESULT fat_disk_write(const uint8_t *buff, unsigned long sector,
 		       uint32_t count);
 DRESULT fat_disk_ioctl(uint8_t cmd, void *buff);
 
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+/** Flash translation layer counters */
+struct fat_flash_ftl_stats {
+	/** Sectors written by the file system */
+	uint32_t host_writes;
+	/** Sectors programmed to flash, including garbage collection */
+	uint32_t flash_writes;
+	/** Sectors moved by garbage collection */
+	uint32_t gc_moves;
+	/** Erase blocks erased */
+	uint32_t erases;
+	/** Lowest and highest erase count of any erase block */
+	uint32_t min_erase_count;
+	uint32_t max_erase_count;
+	/** Erase blocks without valid data */
+	uint32_t free_blocks;
+};
+
+void fat_flash_ftl_get_stats(struct fat_flash_ftl_stats *stats);
+#endif
+
+#ifdef CONFIG_FS_FAT_FLASH_CACHE
+/** Sector cache counters */
+struct fat_flash_cache_stats {
+	/** Single sector accesses found in the cache */
+	uint32_t hits;
+	/** Single sector accesses that had to allocate an entry */
+	uint32_t misses;
+	/** Entries replaced to make room for another sector */
+	uint32_t evictions;
+	/** Erase blocks written back */
+	uint32_t block_writes;
+};
+
+void fat_flash_cache_get_stats(struct fat_flash_cache_stats *stats);
+#endif
+
 #endif /* _FAT_DISKIO_H_ */
@@ -35,6 +35,10 @@ extern "C" {
 
 #include <stdint.h>
 #include <device.h>
+#ifdef CONFIG_I2C_ASYNC
+#include <errno.h>
+#include <misc/nano_work.h>
+#endif
 
 /*
  * The following #defines are used to configure the I2C controller.
@@ -116,6 +120,46 @@ union dev_config {
 	} bits;
 };
 
+#ifdef CONFIG_I2C_ASYNC
+/**
+ * @brief Callback for a completed asynchronous I2C transaction.
+ *
+ * Called from the context the bus completes transactions in, which may be
+ * an ISR, so it must not block.
+ *
+ * @param dev Pointer to the device structure of the I2C controller.
+ * @param status 0 if all messages were transferred, negative errno code
+ * otherwise.
+ * @param user_data User data given with the transaction.
+ */
+typedef void (*i2c_callback_t)(struct device *dev, int status,
+			       void *user_data);
+
+/**
+ * @brief Queued I2C transaction.
+ *
+ * A chain of messages to one slave, transferred without releasing the
+ * bus, as with i2c_transfer(). The transaction and the messages it
+ * points to belong to the bus from submission until the callback runs.
+ */
+struct i2c_transaction {
+	/** Messages, in order */
+	struct i2c_msg *msgs;
+	/** Number of messages */
+	uint8_t num_msgs;
+	/** Address of the slave */
+	uint16_t addr;
+	/** Called once the transaction is done */
+	i2c_callback_t callback;
+	/** Passed to the callback */
+	void *user_data;
+
+	/* Private, used while the transaction is queued */
+	struct nano_work work;
+	struct device *dev;
+};
+#endif /* CONFIG_I2C_ASYNC */
+
 /**
  * @cond INTERNAL_HIDDEN
  *
@@ -128,10 +172,17 @@ typedef int (*i2c_api_full_io_t)(struct device *dev,
 				 struct i2c_msg *msgs,
 				 uint8_t num_msgs,
 				 uint16_t addr);
+#ifdef CONFIG_I2C_ASYNC
+typedef int (*i2c_api_transfer_async_t)(struct device *dev,
+					struct i2c_transaction *trans);
+#endif
 
 struct i2c_driver_api {
 	i2c_api_configure_t configure;
 	i2c_api_full_io_t transfer;
+#ifdef CONFIG_I2C_ASYNC
+	i2c_api_transfer_async_t transfer_async;
+#endif
 };
 /**
  * @endcond
@@ -379,6 +430,53 @@ static inline int i2c_reg_update_byte(struct device *dev, uint8_t dev_addr,
 	return i2c_reg_write_byte(dev, dev_addr, reg_addr, new_value);
 }
 
+#ifdef CONFIG_I2C_ASYNC
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+int _i2c_async_submit(struct device *dev, struct i2c_transaction *trans);
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Queue a transaction on an I2C controller.
+ *
+ * This routine queues the messages of @a trans on the controller and
+ * returns without waiting for them to be transferred. Transactions on
+ * one controller complete in the order they were submitted, and the
+ * callback of each is called when it is done.
+ *
+ * Controllers whose driver does not queue transactions itself have
+ * theirs run one at a time by the I2C fiber with i2c_transfer(). This
+ * fiber is shared by all these controllers, so a transaction waits for
+ * those queued before it on the other buses too.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Transaction to queue. It must stay valid until the
+ * callback runs.
+ *
+ * @retval 0 If the transaction was queued.
+ * @retval Negative errno code if failure, the callback is not called.
+ */
+static inline int i2c_transfer_async(struct device *dev,
+				     struct i2c_transaction *trans)
+{
+	struct i2c_driver_api *api;
+
+	if (!trans->msgs || !trans->num_msgs || !trans->callback) {
+		return -EINVAL;
+	}
+
+	api = (struct i2c_driver_api *)dev->driver_api;
+	if (api->transfer_async) {
+		return api->transfer_async(dev, trans);
+	}
+
+	return _i2c_async_submit(dev, trans);
+}
+#endif /* CONFIG_I2C_ASYNC */
+
 struct i2c_client_config {
 	char *i2c_master;
 	uint16_t i2c_addr;
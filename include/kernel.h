@@ -214,6 +214,128 @@ extern int k_am_in_isr(void);
 extern void k_thread_custom_data_set(void *value);
 extern void *k_thread_custom_data_get(void);
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/**
+ * @brief Thread runtime statistics
+ *
+ * Accounted at each context switch, the time spent in interrupt handlers
+ * counts for the interrupted thread.
+ */
+struct k_thread_runtime_stats {
+	/** Hardware cycles the thread has run */
+	uint64_t cycles;
+	/** Times the thread was switched out */
+	uint32_t switches;
+	/** Times the thread was switched out while still ready to run */
+	uint32_t preemptions;
+	/** Longest run without being switched out, in hardware cycles */
+	uint32_t max_run;
+};
+
+struct k_thread_runtime {
+	k_tid_t thread;
+	struct k_thread_runtime_stats stats;
+};
+
+/**
+ * @brief Get the runtime statistics of a thread.
+ *
+ * The statistics of the running thread include its current run.
+ */
+extern void k_thread_runtime_stats_get(k_tid_t thread,
+				       struct k_thread_runtime_stats *stats);
+
+/**
+ * @brief Get the runtime statistics of all threads at once.
+ *
+ * @param threads Filled with the threads and their statistics.
+ * @param max Size of @a threads.
+ *
+ * @return Number of threads, which can be more than @a max.
+ */
+extern int k_thread_runtime_stats_all_get(struct k_thread_runtime *threads,
+					  int max);
+
+/**
+ * @brief Get the share of time the idle thread ran.
+ *
+ * This includes the interrupts serviced while idle.
+ *
+ * @return Percentage of the time since the previous call.
+ */
+extern int k_thread_runtime_idle_percent_get(void);
+#endif
+
+#ifdef CONFIG_OBJECT_CONTENTION_STATS
+#define K_CONTENTION_MUTEX 1
+#define K_CONTENTION_SEM 2
+#define K_CONTENTION_FIFO 3
+
+/**
+ * @brief Contention statistics of a mutex, semaphore or fifo
+ *
+ * Times are in hardware cycles.
+ */
+struct k_contention_stats {
+	/** Successful locks, takes or gets */
+	uint32_t acquisitions;
+	/** Attempts that found the object unavailable */
+	uint32_t contended;
+	/** Time spent waiting, timeouts included */
+	uint64_t total_wait;
+	/** Longest wait */
+	uint32_t max_wait;
+	/** Longest time the mutex was held, mutexes only */
+	uint32_t max_hold;
+};
+
+struct _contention {
+	struct k_contention_stats stats;
+	uint32_t hold_start;
+	struct _contention *next;
+	int type;
+};
+
+struct k_contention {
+	/** Mutex, semaphore or fifo */
+	void *obj;
+	/** K_CONTENTION_MUTEX, K_CONTENTION_SEM or K_CONTENTION_FIFO */
+	int type;
+	struct k_contention_stats stats;
+};
+
+#define _CONTENTION_FIELD struct _contention contention
+
+/**
+ * @brief Get the contention statistics of all objects at once.
+ *
+ * Objects are listed when initialized, or on first use if statically
+ * defined.
+ *
+ * @param objs Filled with the objects and their statistics.
+ * @param max Size of @a objs.
+ *
+ * @return Number of objects, which can be more than @a max.
+ */
+extern int k_contention_stats_all_get(struct k_contention *objs, int max);
+
+/**
+ * @brief Reset the contention statistics of all objects.
+ */
+extern void k_contention_stats_reset(void);
+#else
+#define _CONTENTION_FIELD
+#endif
+
+#ifdef CONFIG_POLL
+struct k_poll_event;
+
+/* the event of the thread polling the object, see k_poll() */
+#define _POLL_EVENT struct k_poll_event *poll_event
+#else
+#define _POLL_EVENT
+#endif
+
 /**
  *  kernel timing
  */
@@ -352,6 +474,17 @@ extern uint32_t k_uptime_delta_32(int64_t *reftime);
 
 extern uint32_t k_cycle_get_32(void);
 
+/**
+ * @brief Read the 64-bit hardware cycle count.
+ *
+ * Extends k_cycle_get_32() across its wraps, without locking interrupts.
+ * Convert it with sys_clock_cycles_to_ns64() or sys_clock_cycles_to_us64()
+ * for a monotonic high-resolution time.
+ *
+ * @return The hardware cycles elapsed since the system clock started.
+ */
+extern uint64_t k_cycle_get_64(void);
+
 /**
  *  data transfers (basic)
  */
@@ -361,6 +494,8 @@ extern uint32_t k_cycle_get_32(void);
 struct k_fifo {
 	_wait_q_t wait_q;
 	sys_slist_t data_q;
+	_CONTENTION_FIELD;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_fifo);
 };
@@ -637,6 +772,7 @@ struct k_mutex {
 	int num_lock_state_changes;
 	int num_conflicts;
 #endif
+	_CONTENTION_FIELD;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_mutex);
 };
@@ -671,6 +807,8 @@ struct k_sem {
 	_wait_q_t wait_q;
 	unsigned int count;
 	unsigned int limit;
+	_CONTENTION_FIELD;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_sem);
 };
@@ -750,6 +888,276 @@ extern void k_sem_group_reset(struct k_sem *sem_array[]);
 	struct k_sem name = \
 		K_SEM_INITIALIZER(name, initial_count, count_limit)
 
+#ifdef CONFIG_PRIO_WORKQUEUE
+
+/* priority workqueues */
+
+/**
+ * @brief Statistics of a priority workqueue.
+ *
+ * Times are in hardware cycles. The wait of an item runs from its
+ * submission to the start of its handler.
+ */
+struct k_prio_work_q_stats {
+	uint32_t executed;
+	uint32_t deadline_misses;
+	uint64_t total_wait;
+	uint32_t max_wait;
+	uint64_t total_exec;
+	uint32_t max_exec;
+};
+
+/**
+ * A priority workqueue is a pool of threads that execute the
+ * @ref k_prio_work items queued to it, by priority and then by deadline,
+ * rather than in the order they were submitted. A slow handler only holds
+ * up the items queued behind it once all the threads of the pool are busy.
+ */
+struct k_prio_work_q {
+	sys_dlist_t queue;
+	struct k_sem sem;
+	struct k_prio_work_q_stats stats;
+};
+
+/**
+ * @brief An item which can be scheduled on a @ref k_prio_work_q.
+ *
+ * The handler is given the embedded @ref k_work, use CONTAINER_OF() to get
+ * back to the item.
+ */
+struct k_prio_work {
+	struct k_work work;
+	sys_dnode_t node;
+	int prio;
+	uint32_t deadline;
+	int has_deadline;
+	uint32_t submit_time;
+};
+
+/**
+ * @brief Statically initialize a priority work item
+ */
+#define K_PRIO_WORK_INITIALIZER(work_handler) \
+	{ \
+	.work = K_WORK_INITIALIZER(work_handler), \
+	}
+
+/**
+ * @brief Dynamically initialize a priority work item
+ */
+static inline void k_prio_work_init(struct k_prio_work *work,
+				    k_work_handler_t handler)
+{
+	k_work_init(&work->work, handler);
+}
+
+/**
+ * @brief Start a priority workqueue.
+ *
+ * Spawns @a workers threads at the priority of @a config. Their stacks are
+ * carved one after the other out of the stack of @a config, which must
+ * hold @a workers stacks of @a config->stack_size bytes each, e.g.
+ * char __stack stacks[workers][stack_size].
+ *
+ * @param work_q Workqueue to start
+ * @param config Stack and priority of the threads
+ * @param workers Number of threads
+ *
+ * @return N/A
+ */
+extern void k_prio_work_q_start(struct k_prio_work_q *work_q,
+				const struct k_thread_config *config,
+				int workers);
+
+/**
+ * @brief Submit a work item to a priority workqueue.
+ *
+ * Items are executed by increasing @a prio value, the same way as thread
+ * priorities, and at equal priority by earliest deadline, items without a
+ * deadline last. Items that compare equal execute in submission order.
+ * The deadline is only used for ordering, and to count missed deadlines
+ * in the statistics of the workqueue.
+ *
+ * Like k_work_submit_to_queue(), this is a no-op if the item is already
+ * pending. It can be called from an ISR.
+ *
+ * @param work_q Workqueue to schedule the work item on
+ * @param work Work item
+ * @param prio Priority of the work item
+ * @param deadline Milliseconds by which the handler should have started,
+ * or K_FOREVER for none
+ *
+ * @return N/A
+ */
+extern void k_prio_work_submit(struct k_prio_work_q *work_q,
+			       struct k_prio_work *work, int prio,
+			       int32_t deadline);
+
+/**
+ * @brief Cancel a pending priority work item.
+ *
+ * @param work_q Workqueue the work item was submitted to
+ * @param work Work item
+ *
+ * @retval 0 The work item was removed before its handler ran
+ * @retval -EINVAL The work item is not pending
+ */
+extern int k_prio_work_cancel(struct k_prio_work_q *work_q,
+			      struct k_prio_work *work);
+
+/**
+ * @brief Get the statistics of a priority workqueue.
+ *
+ * @param work_q Workqueue
+ * @param stats Filled with the statistics since the workqueue started, or
+ * since they were last reset
+ *
+ * @return N/A
+ */
+extern void k_prio_work_q_stats_get(struct k_prio_work_q *work_q,
+				    struct k_prio_work_q_stats *stats);
+
+/**
+ * @brief Reset the statistics of a priority workqueue.
+ *
+ * @param work_q Workqueue
+ *
+ * @return N/A
+ */
+extern void k_prio_work_q_stats_reset(struct k_prio_work_q *work_q);
+
+#endif /* CONFIG_PRIO_WORKQUEUE */
+
+#ifdef CONFIG_POLL
+
+/* polling */
+
+/* the kind of condition an event waits for, see k_poll_event_init() */
+#define K_POLL_TYPE_IGNORE 0
+#define K_POLL_TYPE_SIGNAL 1
+#define K_POLL_TYPE_SEM_AVAILABLE 2
+#define K_POLL_TYPE_FIFO_DATA_AVAILABLE 3
+
+/* the state of an event when k_poll() returns */
+#define K_POLL_STATE_NOT_READY 0
+#define K_POLL_STATE_EADDRINUSE 1
+#define K_POLL_STATE_SIGNALED 2
+#define K_POLL_STATE_SEM_AVAILABLE 3
+#define K_POLL_STATE_FIFO_DATA_AVAILABLE 4
+
+/**
+ * @brief A signal that can be polled for.
+ *
+ * Raised with k_poll_signal(). It stays raised until the owner clears
+ * @a signaled, which is best done right after the poll that saw it.
+ */
+struct k_poll_signal {
+	_POLL_EVENT;
+	unsigned int signaled;
+	int result;
+};
+
+#define K_POLL_SIGNAL_INITIALIZER() \
+	{ \
+	.poll_event = NULL, \
+	.signaled = 0, \
+	.result = 0, \
+	}
+
+/**
+ * @brief An object, and the condition on it, that k_poll() waits for.
+ */
+struct k_poll_event {
+	struct k_thread *poller;
+	uint32_t type;
+	uint32_t state;
+	union {
+		void *obj;
+		struct k_poll_signal *signal;
+		struct k_sem *sem;
+		struct k_fifo *fifo;
+	};
+};
+
+/**
+ * @brief Statically initialize a poll event
+ */
+#define K_POLL_EVENT_INITIALIZER(event_type, event_obj) \
+	{ \
+	.poller = NULL, \
+	.type = event_type, \
+	.state = K_POLL_STATE_NOT_READY, \
+	.obj = event_obj, \
+	}
+
+/**
+ * @brief Initialize a poll event.
+ *
+ * @param event Event to initialize
+ * @param type K_POLL_TYPE_SEM_AVAILABLE, K_POLL_TYPE_FIFO_DATA_AVAILABLE or
+ * K_POLL_TYPE_SIGNAL, or K_POLL_TYPE_IGNORE to leave the event out of the
+ * polls without removing it from the array
+ * @param obj Semaphore, fifo or signal, matching @a type
+ *
+ * @return N/A
+ */
+extern void k_poll_event_init(struct k_poll_event *event, uint32_t type,
+			      void *obj);
+
+/**
+ * @brief Wait for any of several objects to become available.
+ *
+ * Waits until a semaphore is available, a fifo holds data or a signal is
+ * raised, for any of the @a events. On return the state of each event is
+ * set to the condition found on its object, K_POLL_STATE_NOT_READY for
+ * the others. Several events can be ready at once.
+ *
+ * Polling does not take the semaphore or get the data: the caller does it
+ * with k_sem_take() or k_fifo_get() and K_NO_WAIT, which can still fail if
+ * another thread got there first.
+ *
+ * Only one thread at a time can poll an object. Threads waiting on the
+ * object with k_sem_take() or k_fifo_get() are served before the poller.
+ *
+ * This routine must not be called from an ISR.
+ *
+ * @param events Events to wait for
+ * @param num_events Number of events
+ * @param timeout Waiting period in milliseconds, or one of the special
+ * values K_NO_WAIT and K_FOREVER
+ *
+ * @retval 0 At least one event is ready
+ * @retval -EAGAIN No event got ready in time
+ * @retval -EADDRINUSE Another thread polls one of the objects, its event
+ * is in state K_POLL_STATE_EADDRINUSE
+ */
+extern int k_poll(struct k_poll_event *events, int num_events,
+		  int32_t timeout);
+
+/**
+ * @brief Initialize a poll signal.
+ *
+ * @param signal Signal to initialize
+ *
+ * @return N/A
+ */
+extern void k_poll_signal_init(struct k_poll_signal *signal);
+
+/**
+ * @brief Raise a poll signal.
+ *
+ * Sets @a signaled and @a result in the signal, and wakes up the thread
+ * polling it, if any. It can be called from an ISR.
+ *
+ * @param signal Signal to raise
+ * @param result Value for the poller to find in @a signal->result
+ *
+ * @return N/A
+ */
+extern void k_poll_signal(struct k_poll_signal *signal, int result);
+
+#endif /* CONFIG_POLL */
+
 /* events */
 
 #define K_EVT_DEFAULT NULL
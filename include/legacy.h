@@ -722,6 +722,7 @@ extern int64_t sys_tick_delta(int64_t *reftime);
 extern uint32_t sys_tick_delta_32(int64_t *reftime);
 
 #define sys_cycle_get_32 k_cycle_get_32
+#define sys_cycle_get_64 k_cycle_get_64
 
 /* floating point services */
 
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Interrupt latency benchmark
+ */
+
+#ifndef _MISC_INT_LATENCY_H_
+#define _MISC_INT_LATENCY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_INT_LATENCY_BENCHMARK
+/**
+ * @brief Start tracking interrupt latency metrics.
+ */
+void int_latency_init(void);
+
+/**
+ * @brief Print the interrupt latency metrics and start a new interval.
+ */
+void int_latency_show(void);
+#endif
+
+#ifdef CONFIG_INT_LATENCY_STATS
+/*
+ * Histograms are log-scale: bucket n counts the samples of 2^n to
+ * 2^(n + 1) - 1 hardware cycles, bucket 0 those of 0 or 1.
+ */
+#define INT_LATENCY_HIST_BUCKETS 32
+
+/** Latency from interrupt generation to handler, system timer only */
+#define INT_LATENCY_HIST_ENTRY 0
+/** Time spent with interrupts locked */
+#define INT_LATENCY_HIST_LOCK 1
+
+struct int_latency_hist {
+	uint32_t count[INT_LATENCY_HIST_BUCKETS];
+};
+
+/** @brief Service statistics of an interrupt */
+struct int_latency_irq_stats {
+	/** Key of the interrupt, the vector on x86 */
+	int irq;
+	/** Times the handler ran */
+	uint32_t count;
+	/** Hardware cycles spent in the handler, nested ones included */
+	uint64_t cycles;
+	/** Longest run of the handler, in hardware cycles */
+	uint32_t max_cycles;
+};
+
+/**
+ * @brief Get the service statistics of all interrupts serviced so far.
+ *
+ * Up to CONFIG_INT_LATENCY_STATS_IRQS interrupts are tracked.
+ *
+ * @param irqs Filled with the statistics of each interrupt.
+ * @param max Size of @a irqs.
+ *
+ * @return Number of interrupts, which can be more than @a max.
+ */
+int int_latency_irq_stats_get(struct int_latency_irq_stats *irqs, int max);
+
+/**
+ * @brief Get a latency histogram.
+ *
+ * @param which INT_LATENCY_HIST_ENTRY or INT_LATENCY_HIST_LOCK.
+ * @param hist Filled with the histogram.
+ */
+void int_latency_hist_get(int which, struct int_latency_hist *hist);
+
+/**
+ * @brief Get the longest time interrupts were locked.
+ *
+ * @param cycles Set to the time, in hardware cycles.
+ *
+ * @return Address irq_lock() was called from, or the interrupt entry code
+ * if interrupts were locked by an interrupt.
+ */
+void *int_latency_worst_lock_get(uint32_t *cycles);
+
+/**
+ * @brief Reset the statistics and histograms.
+ */
+void int_latency_stats_reset(void);
+
+/**
+ * @brief Print the statistics and histograms.
+ */
+void int_latency_stats_show(void);
+
+/**
+ * @brief Shell command printing the statistics and histograms.
+ */
+int int_latency_shell_cmd(int argc, char *argv[]);
+
+#define INT_LATENCY_SHELL_CMD \
+	{ "irqstats", int_latency_shell_cmd, "print interrupt statistics" }
+#endif /* CONFIG_INT_LATENCY_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MISC_INT_LATENCY_H_ */
@@ -55,15 +55,32 @@ extern "C" {
 #define KERNEL_EVENT_LOGGER_TASK_MON_KEVENT_EVENT_ID            0x0006
 #endif
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_OBJECTS
+#define KERNEL_EVENT_LOGGER_SEM_GIVE_EVENT_ID                   0x0007
+#define KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID                   0x0008
+#define KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID                   0x0009
+#define KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID                   0x000A
+#define KERNEL_EVENT_LOGGER_MUTEX_CONTENDED_EVENT_ID            0x000B
+#endif
+
 #ifndef _ASMLANGUAGE
 
 /**
  * Global variable of the ring buffer that allows user to implement
  * their own reading routine.
  */
-struct event_logger sys_k_event_logger;
+extern struct event_logger sys_k_event_logger;
 
 
+static inline uint32_t _sys_k_get_default_time(void)
+{
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_TIMESTAMP_US
+	return (uint32_t)sys_clock_cycles_to_us64(sys_cycle_get_64());
+#else
+	return sys_cycle_get_32();
+#endif
+}
+
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_CUSTOM_TIMESTAMP
 
 /**
@@ -77,7 +94,7 @@ static inline uint32_t _sys_k_get_time(void)
 	if (timer_func)
 		return timer_func();
 	else
-		return sys_cycle_get_32();
+		return _sys_k_get_default_time();
 }
 
 /**
@@ -101,7 +118,7 @@ void sys_k_event_logger_set_timer(sys_k_timer_func func);
 #else
 static inline uint32_t _sys_k_get_time(void)
 {
-	return sys_cycle_get_32();
+	return _sys_k_get_default_time();
 }
 #endif
 
@@ -357,6 +374,65 @@ void _sys_k_event_logger_interrupt(void);
 static inline void _sys_k_event_logger_interrupt(void) {};
 #endif
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_TRACE
+
+/**
+ * @brief Kernel event trace record.
+ *
+ * @details Fixed-size record of the lock-free trace buffer. The thread is
+ * the one running when the event occurred, for a context switch that is the
+ * thread being switched out. The data and object fields depend on the
+ * event:
+ *
+ *	- Context switch: unused.
+ *	- Interrupt: data is the IRQ number.
+ *	- Sleep: recorded when the CPU wakes up, data is the IRQ that woke it
+ *	  up and object the number of hardware cycles slept.
+ *	- Kernel objects: object is the address of the semaphore, FIFO or
+ *	  mutex. For a take, a get or a contended mutex lock, data is 1 if
+ *	  the caller has to wait.
+ */
+struct sys_k_event_trace_record {
+	uint32_t timestamp;
+	uint16_t event_id;
+	uint16_t data;
+	uint32_t thread;
+	uint32_t object;
+};
+
+/**
+ * Global variable of the trace buffer, for reading it with a debugger.
+ */
+extern struct sys_k_event_trace_record
+	_sys_k_event_trace_buffer[CONFIG_KERNEL_EVENT_LOGGER_TRACE_BUFFER_SIZE];
+
+void _sys_k_event_trace(uint16_t event_id, uint16_t data, uint32_t object);
+
+/**
+ * @brief Retrieves kernel event trace records.
+ *
+ * @details Moves up to @a max records out of the trace buffer in the order
+ * they were recorded. A record that is still being written by an interrupted
+ * context stops the copy, it is returned by the next call. The function
+ * does not wait and must not be called by two collectors at once.
+ *
+ * @param records  Pointer to the buffer where the records will be copied.
+ * @param max      Size of the buffer in records.
+ *
+ * @return The amount of records copied, zero if there are none.
+ */
+int sys_k_event_trace_get(struct sys_k_event_trace_record *records, int max);
+
+/**
+ * @brief Get the number of trace records dropped.
+ *
+ * @details Records are dropped when the trace buffer is full.
+ *
+ * @return Records dropped since boot.
+ */
+uint32_t sys_k_event_trace_dropped_get(void);
+#endif /* CONFIG_KERNEL_EVENT_LOGGER_TRACE */
+
 #endif /* _ASMLANGUAGE */
 
 #else /* !CONFIG_KERNEL_EVENT_LOGGER */
@@ -372,6 +448,19 @@ static inline void _sys_k_event_logger_enter_sleep(void) {};
 
 #endif /* CONFIG_KERNEL_EVENT_LOGGER */
 
+#ifndef _ASMLANGUAGE
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_OBJECTS
+#define _SYS_K_EVENT_TRACE_OBJ(event_id, obj, data) \
+	do { \
+		if (sys_k_must_log_event(event_id)) { \
+			_sys_k_event_trace(event_id, data, (uint32_t)(obj)); \
+		} \
+	} while ((0))
+#else
+#define _SYS_K_EVENT_TRACE_OBJ(event_id, obj, data) do { } while ((0))
+#endif
+#endif /* _ASMLANGUAGE */
+
 #ifdef __cplusplus
 }
 #endif
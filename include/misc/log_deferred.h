@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Deferred logging
+ *
+ * A log call records the format string pointer and the raw argument words
+ * into a ring buffer, without formatting anything. A fiber formats and
+ * outputs the records through printk's character output later, so logging
+ * from an ISR or a time critical fiber costs a few dozen cycles instead of
+ * the time the characters take on the console.
+ *
+ * Since formatting happens later, %s arguments must point to strings that
+ * are still valid then, such as string literals.
+ */
+
+#ifndef __LOG_DEFERRED_H
+#define __LOG_DEFERRED_H
+
+#include <stdint.h>
+#include <toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest number of arguments of a deferred log call */
+#define LOG_DEFERRED_MAX_ARGS 15
+
+/**
+ * @brief Number of arguments passed, from 0 to LOG_DEFERRED_MAX_ARGS.
+ */
+#define LOG_DEFERRED_NARGS(...)						\
+	_LOG_DEFERRED_NARGS(_, ##__VA_ARGS__, 15, 14, 13, 12, 11, 10,	\
+			    9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define _LOG_DEFERRED_NARGS(_, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10,	\
+			    a11, a12, a13, a14, a15, n, ...) n
+
+/**
+ * @brief Record a message in the deferred log.
+ *
+ * Can be called from any context. The message is dropped if the buffer is
+ * full.
+ *
+ * @param fmt Format string, with printk's conversions.
+ * @param nargs Number of arguments that follow, see LOG_DEFERRED_NARGS().
+ */
+extern __printf_like(1, 3) void log_deferred(const char *fmt, int nargs,
+					     ...);
+
+/**
+ * @brief Record a message in the deferred log, counting the arguments.
+ */
+#define LOG_DEFERRED(fmt, ...)						\
+	log_deferred(fmt, LOG_DEFERRED_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+/**
+ * @brief Output the recorded messages from the calling context.
+ *
+ * Meant for code that is about to stop the system, or that must see the
+ * log in order with its own console output.
+ *
+ * @return Number of messages output, or -EBUSY if the log is being output
+ * by another context.
+ */
+extern int log_deferred_flush(void);
+
+struct log_deferred_stats {
+	/** Messages recorded */
+	uint32_t logged;
+	/** Messages dropped because the buffer was full */
+	uint32_t dropped;
+	/** Messages output */
+	uint32_t output;
+};
+
+/**
+ * @brief Get the deferred log counters.
+ *
+ * @param stats Filled with the counters.
+ */
+extern void log_deferred_stats_get(struct log_deferred_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOG_DEFERRED_H */
@@ -50,6 +50,11 @@ extern "C" {
  */
 #ifdef CONFIG_PRINTK
 extern __printf_like(1, 2) void printk(const char *fmt, ...);
+
+#ifdef CONFIG_PRINTK_DEFERRED
+#include <misc/log_deferred.h>
+#define printk LOG_DEFERRED
+#endif
 #else
 static inline __printf_like(1, 2) void printk(const char *fmt, ...)
 {
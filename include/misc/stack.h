@@ -19,20 +19,28 @@
  * limitations under the License.
  */
 
-#if defined(CONFIG_INIT_STACKS) && defined(CONFIG_PRINTK)
+#ifndef _MISC_STACK_H_
+#define _MISC_STACK_H_
+
+#ifdef CONFIG_INIT_STACKS
 #include <offsets.h>
-#include <misc/printk.h>
 
-static inline void stack_analyze(const char *name, const char *stack,
-				 unsigned size)
+/**
+ * @brief Get the unused space of a stack area.
+ *
+ * Counts the bytes still holding the value the stack area was initialized
+ * with, from the far end of the area the stack grows towards.
+ *
+ * @param stack Stack area.
+ * @param size Size of the stack area.
+ * @param stack_offset Bytes at the start of the area that are not stack.
+ *
+ * @return Unused bytes.
+ */
+static inline unsigned stack_unused_space_get(const char *stack, unsigned size,
+					      unsigned stack_offset)
 {
-	unsigned i, stack_offset, pcnt, unused = 0;
-
-	/* The TCS is always placed on a 4-byte aligned boundary - if
-	 * the stack beginning doesn't match that there will be some
-	 * unused bytes in the beginning.
-	 */
-	stack_offset = __tTCS_SIZEOF + ((4 - ((unsigned)stack % 4)) % 4);
+	unsigned i, unused = 0;
 
 /* TODO
  * Currently all supported platforms have stack growth down and there is no
@@ -58,6 +66,26 @@ static inline void stack_analyze(const char *name, const char *stack,
 	}
 #endif
 
+	return unused;
+}
+#endif /* CONFIG_INIT_STACKS */
+
+#if defined(CONFIG_INIT_STACKS) && defined(CONFIG_PRINTK)
+#include <misc/printk.h>
+
+static inline void stack_analyze(const char *name, const char *stack,
+				 unsigned size)
+{
+	unsigned stack_offset, pcnt, unused;
+
+	/* The TCS is always placed on a 4-byte aligned boundary - if
+	 * the stack beginning doesn't match that there will be some
+	 * unused bytes in the beginning.
+	 */
+	stack_offset = __tTCS_SIZEOF + ((4 - ((unsigned)stack % 4)) % 4);
+
+	unused = stack_unused_space_get(stack, size, stack_offset);
+
 	/* Calculate the real size reserved for the stack */
 	size -= stack_offset;
 	pcnt = ((size - unused) * 100) / size;
@@ -71,3 +99,42 @@ static inline void stack_analyze(const char *name, const char *stack,
 {
 }
 #endif
+
+#ifdef CONFIG_STACK_USAGE
+/**
+ * @brief Stack usage of a thread
+ */
+struct stack_usage {
+	/** Thread, its TCS sits at the start of its stack area */
+	void *thread;
+	/** Size of the stack area, TCS excluded */
+	unsigned size;
+	/** High water mark */
+	unsigned used;
+};
+
+/**
+ * @brief Get the stack usage of all threads.
+ *
+ * @param usage Filled with the stack usage of the threads.
+ * @param max Size of @a usage.
+ *
+ * @return Number of threads, which can be more than @a max.
+ */
+int stack_usage_get(struct stack_usage *usage, int max);
+
+/**
+ * @brief Print the stack usage of all threads.
+ */
+void stack_usage_print(void);
+
+/**
+ * @brief Shell command printing the stack usage of all threads.
+ */
+int stack_usage_shell_cmd(int argc, char *argv[]);
+
+#define STACK_USAGE_SHELL_CMD \
+	{ "stacks", stack_usage_shell_cmd, "print thread stack usage" }
+#endif /* CONFIG_STACK_USAGE */
+
+#endif /* _MISC_STACK_H_ */
@@ -50,13 +50,16 @@ extern "C" {
 #define IS_SYS_LOG_ACTIVE 1
 
 /* decide print func */
-#if defined(CONFIG_STDOUT_CONSOLE)
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+#include <misc/log_deferred.h>
+#define SYS_LOG_BACKEND_FN LOG_DEFERRED
+#elif defined(CONFIG_STDOUT_CONSOLE)
 #include <stdio.h>
 #define SYS_LOG_BACKEND_FN printf
 #else
 #include <misc/printk.h>
 #define SYS_LOG_BACKEND_FN printk
-#endif /* CONFIG_STDOUT_CONSOLE */
+#endif /* CONFIG_SYS_LOG_DEFERRED */
 
 /* Should use color? */
 #if defined(CONFIG_SYS_LOG_SHOW_COLOR)
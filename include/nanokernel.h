@@ -1710,6 +1710,17 @@ extern uint32_t sys_tick_get_32(void);
  */
 extern uint32_t sys_cycle_get_32(void);
 
+/**
+ * @brief Return a 64-bit time stamp in high-resolution format.
+ *
+ * This routine extends sys_cycle_get_32() across its wraps, without
+ * locking interrupts. Convert it with sys_clock_cycles_to_ns64() or
+ * sys_clock_cycles_to_us64() for a monotonic high-resolution time.
+ *
+ * @return The hardware cycles elapsed since the system clock started.
+ */
+extern uint64_t sys_cycle_get_64(void);
+
 /**
  *
  * @brief Return number of ticks elapsed since a reference time.
@@ -81,6 +81,24 @@ enum ip_buf_type {
  */
 #define IP_BUF_MAX_DATA UIP_BUFSIZE
 
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+/**
+ * @brief Buffer accounting of one network context.
+ *
+ * @details Arrays are indexed by the buffer type, IP_BUF_RX or IP_BUF_TX.
+ */
+struct ip_buf_quota {
+	/** Buffers currently held by the context */
+	uint8_t used[2];
+
+	/** TX buffers guaranteed to the context */
+	uint8_t tx_reserved;
+
+	/** Allocations refused because of the quota or an empty pool */
+	uint32_t alloc_failures[2];
+};
+#endif
+
 struct ip_buf {
 	/** @cond ignore */
 	enum ip_buf_type type;
@@ -90,6 +108,11 @@ struct ip_buf {
 	/** Network connection context */
 	struct net_context *context;
 
+#if defined(CONFIG_NETWORKING_RX_TIMESTAMP)
+	/** Hardware cycle count when the packet was received */
+	uint64_t rx_timestamp;
+#endif
+
 	/** @cond ignore */
 	/* uIP stack specific data */
 	uint16_t len; /* Contiki will set this to 0 if packet is discarded */
@@ -225,6 +248,22 @@ struct ip_buf {
 #define ip_buf_tcp_retry_count(ptr) (((struct ip_buf *)net_buf_user_data((ptr)))->tcp_retry_count)
 /* @endcond */
 
+#if defined(CONFIG_NETWORKING_RX_TIMESTAMP)
+/**
+ * @brief Get the time a packet was received.
+ *
+ * @details The 64-bit hardware cycle count, see sys_cycle_get_64(), when
+ * the network driver passed the packet to the IP stack. It converts to
+ * nanoseconds with sys_clock_cycles_to_ns64().
+ *
+ * @param buf Network buffer.
+ *
+ * @return Receive time in hardware cycles.
+ */
+#define ip_buf_rx_timestamp(buf) \
+	(((struct ip_buf *)net_buf_user_data((buf)))->rx_timestamp)
+#endif
+
 /** NET_BUF_IP
  *
  * @brief This macro returns IP header information struct stored in net_buf.
@@ -336,6 +375,69 @@ struct net_buf *ip_buf_ref_debug(struct net_buf *buf, const char *caller, int li
 struct net_buf *ip_buf_ref(struct net_buf *buf);
 #endif
 
+/**
+ * @brief Get a TX buffer, waiting for one to become available.
+ *
+ * @details Same as ip_buf_get_tx() but lets the caller bound how long
+ * it is willing to wait for the pool, or for the context to get below
+ * its quota. Senders should use this to slow down instead of failing
+ * when the stack is congested.
+ *
+ * @param context Network context that will be related to
+ * this buffer.
+ * @param timeout Timeout to wait, in ticks. TICKS_NONE and
+ * TICKS_UNLIMITED are accepted.
+ *
+ * @return Network buffer if successful, NULL on timeout.
+ */
+#ifdef DEBUG_IP_BUFS
+#define ip_buf_get_tx_timeout(context, timeout)				\
+	ip_buf_get_tx_timeout_debug(context, timeout, __func__, __LINE__)
+struct net_buf *ip_buf_get_tx_timeout_debug(struct net_context *context,
+					    int32_t timeout,
+					    const char *caller, int line);
+#else
+struct net_buf *ip_buf_get_tx_timeout(struct net_context *context,
+				      int32_t timeout);
+#endif
+
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+/**
+ * @brief Guarantee TX buffers to a network context.
+ *
+ * @details The reserved buffers are kept out of reach of other
+ * contexts and of the stack itself, so this context can always
+ * send even if someone else exhausted the pool. Passing 0 releases
+ * the reservation.
+ *
+ * @param context Network context.
+ * @param count Number of buffers to guarantee.
+ *
+ * @return 0 if ok, -ENOMEM if the pool cannot satisfy all reservations.
+ */
+int ip_buf_reserve_tx(struct net_context *context, uint8_t count);
+
+/**
+ * @brief Get the buffer accounting of a network context.
+ *
+ * @param context Network context.
+ *
+ * @return Buffer accounting if successful, NULL otherwise.
+ */
+const struct ip_buf_quota *ip_buf_get_quota(struct net_context *context);
+
+/** @cond ignore */
+bool ip_buf_charge_rx(struct net_context *context, struct net_buf *buf,
+		      bool acked);
+/* @endcond */
+#else
+static inline bool ip_buf_charge_rx(struct net_context *context,
+				    struct net_buf *buf, bool acked)
+{
+	return true;
+}
+#endif
+
 /** @cond ignore */
 void ip_buf_init(void);
 /* @endcond */
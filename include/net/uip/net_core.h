@@ -157,6 +157,18 @@ void net_context_init(void);
  */
 int net_context_get_connection_status(struct net_context *context);
 
+#ifdef CONFIG_NETWORKING_STATISTICS
+/**
+ * @brief Get the number of times the net timer fiber woke up.
+ *
+ * @details Each wakeup runs the event timers that expired by then,
+ * timers expiring at the same tick share a wakeup.
+ *
+ * @return Number of wakeups since net_init().
+ */
+uint32_t net_timer_wakeups_get(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
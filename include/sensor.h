@@ -36,6 +36,9 @@ extern "C" {
 #include <stdint.h>
 #include <device.h>
 #include <errno.h>
+#ifdef CONFIG_SENSOR_TRIGGER_WORKQ
+#include <misc/slist.h>
+#endif
 
 /** @brief Sensor value types. */
 enum sensor_value_type {
@@ -162,6 +165,38 @@ struct sensor_trigger {
 	enum sensor_channel chan;
 };
 
+/**
+ * @brief One sample of a FIFO read, see sensor_fifo_read().
+ *
+ * The axes hold raw device counts; multiply them by the scales returned in
+ * struct sensor_fifo to get micro m/s^2 and micro radians/s. The axes of a
+ * sensor that does not feed the FIFO read as 0.
+ */
+struct sensor_fifo_frame {
+	/** Hardware cycle count (see sys_cycle_get_32()) of the sample. */
+	uint32_t timestamp;
+	/** Raw accelerometer X, Y and Z axes. */
+	int16_t accel[3];
+	/** Raw gyroscope X, Y and Z axes. */
+	int16_t gyro[3];
+} __packed;
+
+/**
+ * @brief Descriptor of a FIFO read, see sensor_fifo_read().
+ */
+struct sensor_fifo {
+	/** Caller provided buffer the samples are stored in. */
+	struct sensor_fifo_frame *frames;
+	/** Number of frames the buffer can hold. */
+	uint16_t max_frames;
+	/** Number of frames stored, set by the driver. */
+	uint16_t num_frames;
+	/** Accelerometer scale in micro m/s^2 per count, set by the driver. */
+	uint32_t accel_scale;
+	/** Gyroscope scale in micro radians/s per count, set by the driver. */
+	uint32_t gyro_scale;
+};
+
 /**
  * @brief Sensor attribute types.
  */
@@ -244,12 +279,21 @@ typedef int (*sensor_sample_fetch_t)(struct device *dev,
 typedef int (*sensor_channel_get_t)(struct device *dev,
 				    enum sensor_channel chan,
 				    struct sensor_value *val);
+/**
+ * @typedef sensor_fifo_read_t
+ * @brief Callback API for draining the hardware FIFO of a sensor
+ *
+ * See sensor_fifo_read() for argument descriptor
+ */
+typedef int (*sensor_fifo_read_t)(struct device *dev,
+				  struct sensor_fifo *fifo);
 
 struct sensor_driver_api {
 	sensor_attr_set_t attr_set;
 	sensor_trigger_set_t trigger_set;
 	sensor_sample_fetch_t sample_fetch;
 	sensor_channel_get_t channel_get;
+	sensor_fifo_read_t fifo_read;
 };
 
 /**
@@ -394,6 +438,44 @@ static inline int sensor_channel_get(struct device *dev,
 	return api->channel_get(dev, chan, val);
 }
 
+/**
+ * @brief Read the samples queued in the hardware FIFO of a sensor
+ *
+ * Drain up to @a fifo->max_frames samples from the sensor's FIFO in as few
+ * bus transfers as the device allows, and store them, oldest first, in
+ * @a fifo->frames. Unlike sensor_sample_fetch() followed by
+ * sensor_channel_get(), no conversion to struct sensor_value is done;
+ * the scales needed to convert the raw counts are returned along with
+ * them.
+ *
+ * The driver does not know when each sample was taken, so the timestamp
+ * of the newest one is the time of the read, and the older ones are spaced
+ * back from it by the output data rate.
+ *
+ * Since the function communicates with the sensor device, it is unsafe
+ * to call it in an ISR if the device is connected via I2C or SPI.
+ *
+ * @param dev Pointer to the sensor device
+ * @param fifo Buffer to store the samples in, and where the number of
+ * samples read and their scales are returned
+ *
+ * @return 0 if successful, -ENOTSUP if the device has no FIFO support,
+ * negative errno code if failure.
+ */
+static inline int sensor_fifo_read(struct device *dev,
+				   struct sensor_fifo *fifo)
+{
+	struct sensor_driver_api *api;
+
+	api = (struct sensor_driver_api *)dev->driver_api;
+
+	if (!api->fifo_read) {
+		return -ENOTSUP;
+	}
+
+	return api->fifo_read(dev, fifo);
+}
+
 /**
  * @brief The value of gravitational constant in micro m/s^2.
  */
@@ -467,6 +549,92 @@ static inline void sensor_degrees_to_rad(int32_t d, struct sensor_value *rad)
 	rad->val2 = ((int64_t)d * SENSOR_PI / 180LL) % 1000000LL;
 }
 
+#ifdef CONFIG_SENSOR_TRIGGER_WORKQ
+/**
+ * @brief Latency statistics of a sensor trigger work item.
+ *
+ * Latencies are in hardware cycles (see sys_cycle_get_32()), from the
+ * submission of the work, usually in the GPIO interrupt, to the start of
+ * its handler on the sensor trigger work queue.
+ */
+struct sensor_trigger_stats {
+	/** Number of times the handler ran. */
+	uint32_t count;
+	/** Submissions merged into one still pending. */
+	uint32_t coalesced;
+	uint32_t latency_min;
+	uint32_t latency_max;
+	uint32_t latency_avg;
+};
+
+/**
+ * @typedef sensor_trigger_work_handler_t
+ * @brief Handler of a sensor trigger work item
+ *
+ * @param "struct device *dev" Pointer to the sensor device
+ */
+typedef void (*sensor_trigger_work_handler_t)(struct device *dev);
+
+/**
+ * @brief Interrupt work of a sensor driver, run on the sensor trigger work
+ * queue.
+ *
+ * The work queue is a single fiber shared by all the drivers that use it,
+ * in place of one fiber and stack per driver. Work items are run by
+ * priority level, 0 first, and in submission order within a level.
+ */
+struct sensor_trigger_work {
+	void *_reserved;	/* Used by the nano_fifo implementation. */
+	sensor_trigger_work_handler_t handler;
+	struct device *dev;
+	uint8_t level;
+	uint8_t pending;
+	uint32_t submit_time;
+	struct sensor_trigger_stats stats;
+	uint64_t latency_sum;
+	sys_snode_t node;
+};
+
+/**
+ * @brief Initialize a sensor trigger work item.
+ *
+ * Registers the work item so that its statistics can be looked up with
+ * sensor_trigger_stats_get(). Call this once, at driver init time.
+ *
+ * @param work Work item, usually part of the driver data.
+ * @param dev Sensor device, passed to @a handler.
+ * @param handler Function that services the interrupt.
+ * @param level Priority level, 0 being the highest, below
+ * CONFIG_SENSOR_TRIGGER_WORKQ_LEVELS.
+ */
+void sensor_trigger_work_init(struct sensor_trigger_work *work,
+			      struct device *dev,
+			      sensor_trigger_work_handler_t handler,
+			      uint8_t level);
+
+/**
+ * @brief Submit a sensor trigger work item.
+ *
+ * Can be called from an ISR. Submitting a work item whose handler has not
+ * started yet is a no-op, counted in the coalesced statistic.
+ *
+ * @param work Work item.
+ */
+void sensor_trigger_work_submit(struct sensor_trigger_work *work);
+
+/**
+ * @brief Get the trigger latency statistics of a sensor.
+ *
+ * @param dev Pointer to the sensor device
+ * @param stats Filled with the statistics of the device's work item.
+ *
+ * @return 0 if successful, -ENODEV if the device does not use the sensor
+ * trigger work queue.
+ */
+int sensor_trigger_stats_get(struct device *dev,
+			     struct sensor_trigger_stats *stats);
+#endif /* CONFIG_SENSOR_TRIGGER_WORKQ */
+
 /**
  * @brief configuration parameters for sensor triggers.
  */
@@ -32,6 +32,11 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <device.h>
+#ifdef CONFIG_SPI_ASYNC
+#include <errno.h>
+#include <misc/slist.h>
+#include <misc/nano_work.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -76,6 +81,70 @@ struct spi_config {
 	uint32_t	max_sys_freq;
 };
 
+#ifdef CONFIG_SPI_ASYNC
+/**
+ * @brief One transfer of an SPI transaction.
+ *
+ * The same rules as for spi_transceive() apply to the lengths.
+ */
+struct spi_msg {
+	/** Data to send, or NULL */
+	const void *tx_buf;
+	/** Length of tx_buf in bytes */
+	uint32_t tx_len;
+	/** Buffer for the received data, or NULL */
+	void *rx_buf;
+	/** Length of rx_buf in bytes */
+	uint32_t rx_len;
+};
+
+/**
+ * @brief Callback for a completed asynchronous SPI transaction.
+ *
+ * Called from the context the bus completes transactions in, which may be
+ * an ISR, so it must not block.
+ *
+ * @param dev Pointer to the device structure of the SPI controller.
+ * @param status 0 if all messages were transferred, negative errno code
+ * otherwise.
+ * @param user_data User data given with the transaction.
+ */
+typedef void (*spi_callback_t)(struct device *dev, int status,
+			       void *user_data);
+
+/**
+ * @brief Queued SPI transaction.
+ *
+ * A chain of messages to one slave. Controllers with a GPIO chip select
+ * keep it asserted from the first to the last message. The transaction,
+ * its configuration and its messages belong to the bus from submission
+ * until the callback runs.
+ */
+struct spi_transaction {
+	/** Configuration applied before the first message, or NULL to keep
+	 * the current one
+	 */
+	struct spi_config *config;
+	/** Slave selected before the first message, or 0 to keep the
+	 * current one
+	 */
+	uint32_t slave;
+	/** Messages, in order */
+	struct spi_msg *msgs;
+	/** Number of messages */
+	uint8_t num_msgs;
+	/** Called once the transaction is done */
+	spi_callback_t callback;
+	/** Passed to the callback */
+	void *user_data;
+
+	/* Private, used while the transaction is queued */
+	sys_snode_t node;
+	struct nano_work work;
+	struct device *dev;
+};
+#endif /* CONFIG_SPI_ASYNC */
+
 /**
  * @typedef spi_api_configure
  * @brief Callback API upon configuring the const controller
@@ -97,11 +166,23 @@ typedef int (*spi_api_slave_select)(struct device *dev, uint32_t slave);
 typedef int (*spi_api_io)(struct device *dev,
 			  const void *tx_buf, uint32_t tx_buf_len,
 			  void *rx_buf, uint32_t rx_buf_len);
+#ifdef CONFIG_SPI_ASYNC
+/**
+ * @typedef spi_api_io_async
+ * @brief Callback API for queued transactions
+ * See spi_transceive_async() for argument descriptions
+ */
+typedef int (*spi_api_io_async)(struct device *dev,
+				struct spi_transaction *trans);
+#endif
 
 struct spi_driver_api {
 	spi_api_configure configure;
 	spi_api_slave_select slave_select;
 	spi_api_io transceive;
+#ifdef CONFIG_SPI_ASYNC
+	spi_api_io_async transceive_async;
+#endif
 };
 
 /**
@@ -202,6 +283,52 @@ static inline int spi_transceive(struct device *dev,
 	return api->transceive(dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
 }
 
+#ifdef CONFIG_SPI_ASYNC
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+int _spi_async_submit(struct device *dev, struct spi_transaction *trans);
+void _spi_async_work_submit(struct nano_work *work);
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Queue a transaction on an SPI controller.
+ *
+ * This routine queues the messages of @a trans on the controller and
+ * returns without waiting for them to be transferred. Transactions on
+ * one controller complete in the order they were submitted, and the
+ * callback of each is called when it is done.
+ *
+ * Controllers whose driver does not queue transactions itself have
+ * theirs run one at a time by the SPI fiber with spi_transceive(), the
+ * chip select is then released between messages.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Transaction to queue. It must stay valid until the
+ * callback runs.
+ *
+ * @retval 0 If the transaction was queued.
+ * @retval Negative errno code if failure, the callback is not called.
+ */
+static inline int spi_transceive_async(struct device *dev,
+				       struct spi_transaction *trans)
+{
+	struct spi_driver_api *api = (struct spi_driver_api *)dev->driver_api;
+
+	if (!trans->msgs || !trans->num_msgs || !trans->callback) {
+		return -EINVAL;
+	}
+
+	if (api->transceive_async) {
+		return api->transceive_async(dev, trans);
+	}
+
+	return _spi_async_submit(dev, trans);
+}
+#endif /* CONFIG_SPI_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
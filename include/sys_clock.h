@@ -90,6 +90,14 @@ extern int sys_clock_hw_cycles_per_tick;
 
 #define SYS_CLOCK_HW_CYCLES_TO_NS(X) (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(X))
 
+/*
+ * sys_clock_cycles_to_ns64() and sys_clock_cycles_to_us64() convert a
+ * 64-bit hardware cycle count, e.g. from sys_cycle_get_64(), without
+ * dividing and without overflowing for centuries of cycles
+ */
+extern uint64_t sys_clock_cycles_to_ns64(uint64_t cycles);
+extern uint64_t sys_clock_cycles_to_us64(uint64_t cycles);
+
 extern int64_t _sys_clock_tick_count;
 
 /*
@@ -82,6 +82,60 @@ extern "C" {
  */
 typedef void (*uart_irq_callback_t)(struct device *port);
 
+#ifdef CONFIG_UART_ASYNC
+
+/* Events reported to the asynchronous API callback */
+
+/** @brief At least the threshold of received bytes is buffered */
+#define UART_ASYNC_RX_READY	(1 << 0)
+
+/**
+ * @brief The receive line went idle.
+ *
+ * Reported when bytes left in the receiver FIFO below its trigger level
+ * have not been followed by more for a few character times.
+ */
+#define UART_ASYNC_RX_IDLE	(1 << 1)
+
+/** @brief Received bytes were dropped, the ring buffer was full */
+#define UART_ASYNC_RX_OVERFLOW	(1 << 2)
+
+/** @brief A line error was detected, see uart_err_check() */
+#define UART_ASYNC_RX_ERROR	(1 << 3)
+
+/** @brief The buffer passed to uart_async_tx() can be reused */
+#define UART_ASYNC_TX_DONE	(1 << 4)
+
+/**
+ * @typedef uart_async_callback_t
+ * @brief Define the asynchronous API callback function signature.
+ *
+ * Called from the UART interrupt, once per interrupt for all the events
+ * it brought.
+ *
+ * @param port Device struct for the UART device.
+ * @param events Bitmask of UART_ASYNC_* events.
+ */
+typedef void (*uart_async_callback_t)(struct device *port, uint32_t events);
+
+/**
+ * @brief Asynchronous API counters.
+ */
+struct uart_async_stats {
+	/** Bytes received into the ring buffer */
+	uint32_t rx_bytes;
+	/** Bytes received while the ring buffer was full */
+	uint32_t rx_dropped;
+	/** Bytes sent */
+	uint32_t tx_bytes;
+	/** UART interrupts taken */
+	uint32_t interrupts;
+	/** Calls of the callback */
+	uint32_t callbacks;
+};
+
+#endif /* CONFIG_UART_ASYNC */
+
 /**
  * @typedef uart_irq_config_func_t
  * @brief For configuring IRQ on each individual UART device.
@@ -174,6 +228,19 @@ struct uart_driver_api {
 
 #endif
 
+#ifdef CONFIG_UART_ASYNC
+	/** Asynchronous API functions */
+	void (*async_callback_set)(struct device *dev,
+				   uart_async_callback_t cb);
+	int (*async_rx_enable)(struct device *dev, uint8_t *buf, uint32_t size,
+			       uint32_t threshold);
+	int (*async_rx_disable)(struct device *dev);
+	int (*async_read)(struct device *dev, uint8_t *buf, uint32_t len);
+	int (*async_tx)(struct device *dev, const uint8_t *buf, uint32_t len);
+	int (*async_stats_get)(struct device *dev,
+			       struct uart_async_stats *stats);
+#endif
+
 #ifdef CONFIG_UART_LINE_CTRL
 	int (*line_ctrl_set)(struct device *dev, uint32_t ctrl, uint32_t val);
 	int (*line_ctrl_get)(struct device *dev, uint32_t ctrl, uint32_t *val);
@@ -570,6 +637,168 @@ static inline void uart_irq_callback_set(struct device *dev,
 
 #endif
 
+#ifdef CONFIG_UART_ASYNC
+
+/**
+ * @brief Set the asynchronous API callback.
+ *
+ * The driver then handles the UART interrupt itself: received bytes go to
+ * the ring buffer given to uart_async_rx_enable() a FIFO at a time, and
+ * the FIFO is refilled from the buffer given to uart_async_tx(). The
+ * callback set with uart_irq_callback_set() is no longer called, until
+ * this one is set to NULL.
+ *
+ * @param dev UART device structure.
+ * @param cb Callback, or NULL.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the driver has no asynchronous API.
+ */
+static inline int uart_async_callback_set(struct device *dev,
+					  uart_async_callback_t cb)
+{
+	struct uart_driver_api *api;
+
+	api = (struct uart_driver_api *)dev->driver_api;
+
+	if (api->async_callback_set) {
+		api->async_callback_set(dev, cb);
+		return 0;
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Start receiving into a ring buffer.
+ *
+ * UART_ASYNC_RX_READY is reported from the interrupts that leave at least
+ * @a threshold bytes in the ring buffer, UART_ASYNC_RX_IDLE when the line
+ * goes idle with fewer.
+ *
+ * @param dev UART device structure.
+ * @param buf Ring buffer.
+ * @param size Size of the ring buffer, a power of two.
+ * @param threshold Number of buffered bytes to report, at least 1.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If the size or threshold is invalid.
+ * @retval -ENOTSUP If the driver has no asynchronous API.
+ */
+static inline int uart_async_rx_enable(struct device *dev, uint8_t *buf,
+				       uint32_t size, uint32_t threshold)
+{
+	struct uart_driver_api *api;
+
+	api = (struct uart_driver_api *)dev->driver_api;
+
+	if (api->async_rx_enable) {
+		return api->async_rx_enable(dev, buf, size, threshold);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Stop receiving into the ring buffer.
+ *
+ * @param dev UART device structure.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the driver has no asynchronous API.
+ */
+static inline int uart_async_rx_disable(struct device *dev)
+{
+	struct uart_driver_api *api;
+
+	api = (struct uart_driver_api *)dev->driver_api;
+
+	if (api->async_rx_disable) {
+		return api->async_rx_disable(dev);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Take received bytes out of the ring buffer.
+ *
+ * Can be called from the callback or from a fiber or task.
+ *
+ * @param dev UART device structure.
+ * @param buf Buffer to copy the bytes to.
+ * @param len Size of the buffer.
+ *
+ * @return Number of bytes read, or -ENOTSUP.
+ */
+static inline int uart_async_read(struct device *dev, uint8_t *buf,
+				  uint32_t len)
+{
+	struct uart_driver_api *api;
+
+	api = (struct uart_driver_api *)dev->driver_api;
+
+	if (api->async_read) {
+		return api->async_read(dev, buf, len);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Send a buffer.
+ *
+ * The FIFO is filled from the interrupt, UART_ASYNC_TX_DONE is reported
+ * once the last byte is in it.
+ *
+ * @param dev UART device structure.
+ * @param buf Data to send, which must stay valid until UART_ASYNC_TX_DONE.
+ * @param len Number of bytes to send, at least 1.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If @a len is 0.
+ * @retval -EBUSY If a buffer is being sent.
+ * @retval -ENOTSUP If the driver has no asynchronous API.
+ */
+static inline int uart_async_tx(struct device *dev, const uint8_t *buf,
+				uint32_t len)
+{
+	struct uart_driver_api *api;
+
+	api = (struct uart_driver_api *)dev->driver_api;
+
+	if (api->async_tx) {
+		return api->async_tx(dev, buf, len);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Get the asynchronous API counters.
+ *
+ * @param dev UART device structure.
+ * @param stats Filled with the counters.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the driver has no asynchronous API.
+ */
+static inline int uart_async_stats_get(struct device *dev,
+				       struct uart_async_stats *stats)
+{
+	struct uart_driver_api *api;
+
+	api = (struct uart_driver_api *)dev->driver_api;
+
+	if (api->async_stats_get) {
+		return api->async_stats_get(dev, stats);
+	}
+
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_UART_ASYNC */
+
 #ifdef CONFIG_UART_LINE_CTRL
 
 /**
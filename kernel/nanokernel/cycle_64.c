@@ -0,0 +1 @@
+#include "../unified/cycle_64.c"
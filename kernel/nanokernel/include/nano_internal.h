@@ -96,6 +96,13 @@ struct nano_lifo;
 
 extern void *_nano_fiber_lifo_get_panic(struct nano_lifo *lifo);
 
+#ifdef CONFIG_SYS_CLOCK_EXISTS
+/* extend the 64-bit cycle count, on each tick with interrupts locked */
+extern void _sys_cycle_64_update(void);
+#else
+#define _sys_cycle_64_update() do { } while (0)
+#endif
+
 #ifdef CONFIG_MICROKERNEL
 extern void _task_nop(void);
 extern void _nano_nop(void);
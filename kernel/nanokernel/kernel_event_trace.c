@@ -0,0 +1 @@
+#include "../unified/kernel_event_trace.c"
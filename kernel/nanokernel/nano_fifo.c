@@ -36,6 +36,7 @@
 
 #include <nano_private.h>
 #include <misc/debug/object_tracing_common.h>
+#include <misc/kernel_event_logger.h>
 #include <toolchain.h>
 #include <sections.h>
 #include <wait_q.h>
@@ -129,6 +130,7 @@ void _fifo_put_non_preemptible(struct nano_fifo *fifo, void *data)
 	unsigned int key;
 
 	key = irq_lock();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, fifo, 0);
 
 	tcs = _nano_wait_q_remove(&fifo->wait_q);
 	if (tcs) {
@@ -148,6 +150,7 @@ void nano_task_fifo_put(struct nano_fifo *fifo, void *data)
 	unsigned int key;
 
 	key = irq_lock();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, fifo, 0);
 	tcs = _nano_wait_q_remove(&fifo->wait_q);
 	if (tcs) {
 		_nano_timeout_abort(tcs);
@@ -190,6 +193,8 @@ void _fifo_put_list_non_preemptible(struct nano_fifo *fifo,
 	unsigned int key = irq_lock();
 	struct tcs *fiber;
 
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, fifo, 0);
+
 	while (head && ((fiber = _nano_wait_q_remove(&fifo->wait_q)))) {
 		_nano_timeout_abort(fiber);
 		fiberRtnValueSet(fiber, (unsigned int)head);
@@ -226,6 +231,8 @@ void nano_task_fifo_put_list(struct nano_fifo *fifo, void *head, void *tail)
 	unsigned int key = irq_lock();
 	struct tcs *fiber, *first_fiber;
 
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, fifo, 0);
+
 	first_fiber = fifo->wait_q.head;
 	while (head && ((fiber = _nano_wait_q_remove(&fifo->wait_q)))) {
 		_nano_timeout_abort(fiber);
@@ -304,7 +311,11 @@ void *_fifo_get(struct nano_fifo *fifo, int32_t timeout_in_ticks)
 
 	if (likely(!is_q_empty(&fifo->data_q))) {
 		data = dequeue_data(fifo);
+		_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID,
+				       fifo, 0);
 	} else if (timeout_in_ticks != TICKS_NONE) {
+		_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID,
+				       fifo, 1);
 		_NANO_TIMEOUT_ADD(&fifo->wait_q, timeout_in_ticks);
 		_nano_wait_q_put(&fifo->wait_q);
 		data = (void *)_Swap(key);
@@ -337,11 +348,15 @@ void *nano_task_fifo_get(struct nano_fifo *fifo, int32_t timeout_in_ticks)
 		if (likely(!is_q_empty(&fifo->data_q))) {
 			void *data = dequeue_data(fifo);
 
+			_SYS_K_EVENT_TRACE_OBJ(
+				KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID, fifo, 0);
 			irq_unlock(key);
 			return data;
 		}
 
 		if (timeout_in_ticks != TICKS_NONE) {
+			_SYS_K_EVENT_TRACE_OBJ(
+				KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID, fifo, 1);
 			_NANO_OBJECT_WAIT(&fifo->task_q, &fifo->data_q.head,
 					timeout_in_ticks, key);
 			cur_ticks = _NANO_TIMEOUT_TICK_GET();
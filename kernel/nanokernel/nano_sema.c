@@ -42,6 +42,7 @@
 
 #include <nano_private.h>
 #include <misc/debug/object_tracing_common.h>
+#include <misc/kernel_event_logger.h>
 #include <toolchain.h>
 #include <sections.h>
 #include <wait_q.h>
@@ -82,6 +83,7 @@ void _sem_give_non_preemptible(struct nano_sem *sem)
 	unsigned int imask;
 
 	imask = irq_lock();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_GIVE_EVENT_ID, sem, 0);
 	tcs = _nano_wait_q_remove(&sem->wait_q);
 	if (!tcs) {
 		sem->nsig++;
@@ -100,6 +102,7 @@ void nano_task_sem_give(struct nano_sem *sem)
 	unsigned int imask;
 
 	imask = irq_lock();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_GIVE_EVENT_ID, sem, 0);
 	tcs = _nano_wait_q_remove(&sem->wait_q);
 	if (tcs) {
 		_nano_timeout_abort(tcs);
@@ -134,11 +137,15 @@ int _sem_take(struct nano_sem *sem, int32_t timeout_in_ticks)
 
 	if (likely(sem->nsig > 0)) {
 		sem->nsig--;
+		_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID,
+				       sem, 0);
 		irq_unlock(key);
 		return 1;
 	}
 
 	if (timeout_in_ticks != TICKS_NONE) {
+		_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID,
+				       sem, 1);
 		_NANO_TIMEOUT_ADD(&sem->wait_q, timeout_in_ticks);
 		_nano_wait_q_put(&sem->wait_q);
 		return _Swap(key);
@@ -174,11 +181,15 @@ int nano_task_sem_take(struct nano_sem *sem, int32_t timeout_in_ticks)
 
 		if (likely(sem->nsig > 0)) {
 			sem->nsig--;
+			_SYS_K_EVENT_TRACE_OBJ(
+				KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID, sem, 0);
 			irq_unlock(key);
 			return 1;
 		}
 
 		if (timeout_in_ticks != TICKS_NONE) {
+			_SYS_K_EVENT_TRACE_OBJ(
+				KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID, sem, 1);
 			_NANO_OBJECT_WAIT(&sem->task_q, &sem->nsig,
 					timeout_in_ticks, key);
 			cur_ticks = _NANO_TIMEOUT_TICK_GET();
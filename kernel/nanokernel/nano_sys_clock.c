@@ -184,6 +184,7 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 
 	key = irq_lock();
 	_sys_clock_tick_count += ticks;
+	_sys_cycle_64_update();
 	handle_expired_nano_timeouts(ticks);
 	irq_unlock(key);
 }
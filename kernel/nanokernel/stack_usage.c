@@ -0,0 +1 @@
+#include "../unified/stack_usage.c"
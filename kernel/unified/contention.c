@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Mutex, semaphore and fifo contention statistics
+ *
+ * Each object carries its statistics, and is added to a list when it is
+ * initialized, or on first use if statically defined, the same way objects
+ * are added to the object tracing lists. Objects must therefore not go out
+ * of scope once used.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <contention.h>
+#include <string.h>
+
+static struct _contention *contention_list;
+
+void _contention_register(struct _contention *c, int type)
+{
+	unsigned int key = irq_lock();
+
+	/* raced by an interrupt registering it first */
+	if (!c->type) {
+		c->type = type;
+		c->next = contention_list;
+		contention_list = c;
+	}
+
+	irq_unlock(key);
+}
+
+void _contention_init(struct _contention *c, int type)
+{
+	struct _contention *listed;
+	unsigned int key = irq_lock();
+
+	memset(&c->stats, 0, sizeof(c->stats));
+	c->type = type;
+
+	/* objects can be initialized again */
+	for (listed = contention_list; listed; listed = listed->next) {
+		if (listed == c) {
+			break;
+		}
+	}
+
+	if (!listed) {
+		c->next = contention_list;
+		contention_list = c;
+	}
+
+	irq_unlock(key);
+}
+
+void _contention_wait_end(struct _contention *c, uint32_t start,
+			  int acquired)
+{
+	uint32_t wait = sys_cycle_get_32() - start;
+	unsigned int key = irq_lock();
+
+	c->stats.total_wait += wait;
+	if (wait > c->stats.max_wait) {
+		c->stats.max_wait = wait;
+	}
+
+	if (acquired) {
+		c->stats.acquisitions++;
+	}
+
+	irq_unlock(key);
+}
+
+static void *contention_obj(struct _contention *c)
+{
+	switch (c->type) {
+	case K_CONTENTION_MUTEX:
+		return CONTAINER_OF(c, struct k_mutex, contention);
+	case K_CONTENTION_SEM:
+		return CONTAINER_OF(c, struct k_sem, contention);
+	default:
+		return CONTAINER_OF(c, struct k_fifo, contention);
+	}
+}
+
+int k_contention_stats_all_get(struct k_contention *objs, int max)
+{
+	struct _contention *c;
+	unsigned int key;
+	int count = 0;
+
+	key = irq_lock();
+
+	for (c = contention_list; c; c = c->next, count++) {
+		if (count < max) {
+			objs[count].obj = contention_obj(c);
+			objs[count].type = c->type;
+			objs[count].stats = c->stats;
+		}
+	}
+
+	irq_unlock(key);
+
+	return count;
+}
+
+void k_contention_stats_reset(void)
+{
+	struct _contention *c;
+	unsigned int key;
+
+	key = irq_lock();
+
+	for (c = contention_list; c; c = c->next) {
+		memset(&c->stats, 0, sizeof(c->stats));
+	}
+
+	irq_unlock(key);
+}
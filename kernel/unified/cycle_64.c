@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief 64-bit hardware cycle count
+ *
+ * The 32-bit cycle count of the system timer driver wraps in seconds at
+ * high clock rates. It is extended to 64 bits from the cycle count at the
+ * last announced tick, which the tick announcement updates with interrupts
+ * locked. Readers do not lock interrupts: they retry if a tick was
+ * announced while they read, as told by a sequence number. The count is
+ * right as long as ticks are announced at least once per wrap of the
+ * 32-bit count, which the system timer drivers ensure even when idle.
+ *
+ * Conversions scale by a 32.32 fixed-point factor computed at boot, once
+ * the system timer driver has set the clock rate, so they only take
+ * multiplications.
+ */
+
+#include <nano_private.h>
+#include <nano_internal.h>
+#include <sys_clock.h>
+#include <init.h>
+
+/* incremented when the base changes, readers compare it before and after */
+static volatile uint32_t cycle_seq;
+/* 64-bit and 32-bit cycle count at the last announced tick */
+static volatile uint64_t cycle_base;
+static volatile uint32_t cycle_base_32;
+
+/* 2^32 times the nanoseconds and microseconds per cycle */
+static uint64_t ns_factor;
+static uint64_t us_factor;
+
+void _sys_cycle_64_update(void)
+{
+	uint32_t now = sys_cycle_get_32();
+
+	cycle_seq++;
+	cycle_base += (uint32_t)(now - cycle_base_32);
+	cycle_base_32 = now;
+	cycle_seq++;
+}
+
+#ifdef CONFIG_KERNEL_V2
+uint64_t k_cycle_get_64(void)
+#else
+uint64_t sys_cycle_get_64(void)
+#endif
+{
+	uint32_t seq, base_32, now;
+	uint64_t base;
+
+	/*
+	 * The base is only updated with interrupts locked, so a reader never
+	 * sees it half-updated but may be interrupted while reading it.
+	 */
+	do {
+		seq = cycle_seq;
+		base = cycle_base;
+		base_32 = cycle_base_32;
+		now = sys_cycle_get_32();
+	} while (seq != cycle_seq);
+
+	return base + (uint32_t)(now - base_32);
+}
+
+static uint64_t scale(uint64_t cycles, uint64_t factor)
+{
+	uint32_t c_hi = (uint32_t)(cycles >> 32);
+	uint32_t c_lo = (uint32_t)cycles;
+	uint32_t f_hi = (uint32_t)(factor >> 32);
+	uint32_t f_lo = (uint32_t)factor;
+
+	/* cycles * factor / 2^32, with 32x32-bit multiplications only */
+	return (((uint64_t)c_hi * f_hi) << 32) + (uint64_t)c_hi * f_lo +
+	       (uint64_t)c_lo * f_hi + (((uint64_t)c_lo * f_lo) >> 32);
+}
+
+uint64_t sys_clock_cycles_to_ns64(uint64_t cycles)
+{
+	return scale(cycles, ns_factor);
+}
+
+uint64_t sys_clock_cycles_to_us64(uint64_t cycles)
+{
+	return scale(cycles, us_factor);
+}
+
+/*
+ * The timer driver may only read the clock rate when it is initialized,
+ * at the SECONDARY level, so compute the factors at the next one.
+ */
+static int cycle_64_init(struct device *arg)
+{
+	uint64_t rate = sys_clock_hw_cycles_per_sec;
+
+	ARG_UNUSED(arg);
+
+	ns_factor = ((uint64_t)NSEC_PER_SEC << 32) / rate;
+	us_factor = ((uint64_t)USEC_PER_SEC << 32) / rate;
+
+	return 0;
+}
+SYS_INIT(cycle_64_init, NANOKERNEL, 0);
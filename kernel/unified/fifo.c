@@ -24,6 +24,9 @@
 #include <kernel.h>
 #include <nano_private.h>
 #include <misc/debug/object_tracing_common.h>
+#include <misc/kernel_event_logger.h>
+#include <contention.h>
+#include <poll_event.h>
 #include <toolchain.h>
 #include <sections.h>
 #include <wait_q.h>
@@ -36,6 +39,8 @@ void k_fifo_init(struct k_fifo *fifo)
 	sys_dlist_init(&fifo->wait_q);
 
 	SYS_TRACING_OBJ_INIT(k_fifo, fifo);
+	_contention_init(_CONTENTION(fifo), K_CONTENTION_FIFO);
+	_poll_event_init(_POLL_EVENT_OF(fifo));
 }
 
 static void prepare_thread_to_run(struct k_thread *thread, void *data)
@@ -51,6 +56,7 @@ void k_fifo_put(struct k_fifo *fifo, void *data)
 	unsigned int key;
 
 	key = irq_lock();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, fifo, 0);
 
 	first_pending_thread = _unpend_first_thread(&fifo->wait_q);
 
@@ -62,6 +68,11 @@ void k_fifo_put(struct k_fifo *fifo, void *data)
 		}
 	} else {
 		sys_slist_append(&fifo->data_q, data);
+		if (_handle_obj_poll_event(_POLL_EVENT_OF(fifo),
+				K_POLL_STATE_FIFO_DATA_AVAILABLE)) {
+			(void)_Swap(key);
+			return;
+		}
 	}
 
 	irq_unlock(key);
@@ -73,8 +84,10 @@ void k_fifo_put_list(struct k_fifo *fifo, void *head, void *tail)
 
 	struct k_thread *first_thread, *thread;
 	unsigned int key;
+	int poller_ready = 0;
 
 	key = irq_lock();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, fifo, 0);
 
 	first_thread = _peek_first_pending_thread(&fifo->wait_q);
 	while (head && ((thread = _unpend_first_thread(&fifo->wait_q)))) {
@@ -84,9 +97,11 @@ void k_fifo_put_list(struct k_fifo *fifo, void *head, void *tail)
 
 	if (head) {
 		sys_slist_append_list(&fifo->data_q, head, tail);
+		poller_ready = _handle_obj_poll_event(_POLL_EVENT_OF(fifo),
+				K_POLL_STATE_FIFO_DATA_AVAILABLE);
 	}
 
-	if (first_thread) {
+	if (first_thread || poller_ready) {
 		if (!_is_in_isr() && _must_switch_threads()) {
 			(void)_Swap(key);
 			return;
@@ -112,22 +127,35 @@ void k_fifo_put_slist(struct k_fifo *fifo, sys_slist_t *list)
 void *k_fifo_get(struct k_fifo *fifo, int32_t timeout)
 {
 	unsigned int key;
+	uint32_t wait_start;
 	void *data;
+	int ret;
 
 	key = irq_lock();
 
 	if (likely(!sys_slist_is_empty(&fifo->data_q))) {
 		data = sys_slist_get_not_empty(&fifo->data_q);
+		_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID,
+				       fifo, 0);
+		_contention_acquired(_CONTENTION(fifo), K_CONTENTION_FIFO);
 		irq_unlock(key);
 		return data;
 	}
 
 	if (timeout == K_NO_WAIT) {
+		_contention_busy(_CONTENTION(fifo), K_CONTENTION_FIFO);
 		irq_unlock(key);
 		return NULL;
 	}
 
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID, fifo, 1);
+	wait_start = _contention_wait_start(_CONTENTION(fifo),
+					    K_CONTENTION_FIFO);
 	_pend_current_thread(&fifo->wait_q, timeout);
 
-	return _Swap(key) ? NULL : _current->swap_data;
+	ret = _Swap(key);
+
+	_contention_wait_end(_CONTENTION(fifo), wait_start, ret == 0);
+
+	return ret ? NULL : _current->swap_data;
 }
@@ -20,6 +20,7 @@
 #include <sections.h>
 #include <drivers/system_timer.h>
 #include <wait_q.h>
+#include <sched.h>
 
 #if defined(CONFIG_TICKLESS_IDLE)
 /*
@@ -51,7 +52,7 @@ static void set_kernel_idle_time_in_ticks(int32_t ticks)
 
 static void _sys_power_save_idle(int32_t ticks __unused)
 {
-#if defined(CONFIG_TICKLESS_IDLE)
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/*
 		 * Stop generating system timer interrupts until it's time for
@@ -113,7 +114,7 @@ void _sys_power_save_idle_exit(int32_t ticks)
 	 */
 	_sys_soc_resume();
 #endif
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/* Resume normal periodic system timer interrupts */
 
@@ -137,3 +138,26 @@ void idle(void *unused1, void *unused2, void *unused3)
 		k_yield();
 	}
 }
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+int k_thread_runtime_idle_percent_get(void)
+{
+	static uint64_t last_idle, last_total;
+	struct k_thread_runtime_stats stats;
+	uint64_t idle, total;
+	unsigned int key;
+
+	key = irq_lock();
+
+	k_thread_runtime_stats_get(_idle_thread, &stats);
+	idle = stats.cycles - last_idle;
+	total = _thread_runtime_total_get() - last_total;
+
+	last_idle = stats.cycles;
+	last_total += total;
+
+	irq_unlock(key);
+
+	return total ? (int)(idle * 100 / total) : 0;
+}
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
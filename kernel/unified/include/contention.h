@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _kernel_unified_include_contention__h_
+#define _kernel_unified_include_contention__h_
+
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Contention statistics hooks of the mutex, semaphore and fifo objects.
+ *
+ * Except for _contention_wait_end(), they must be called with interrupts
+ * locked, or for mutexes with the scheduler locked. They compile to nothing
+ * when CONFIG_OBJECT_CONTENTION_STATS is disabled, _CONTENTION() then
+ * gives NULL.
+ */
+
+#ifdef CONFIG_OBJECT_CONTENTION_STATS
+
+#define _CONTENTION(obj) (&(obj)->contention)
+
+extern void _contention_init(struct _contention *c, int type);
+extern void _contention_register(struct _contention *c, int type);
+extern void _contention_wait_end(struct _contention *c, uint32_t start,
+				 int acquired);
+
+/* statically defined objects are listed on first use */
+static inline void _contention_check(struct _contention *c, int type)
+{
+	if (unlikely(!c->type)) {
+		_contention_register(c, type);
+	}
+}
+
+static inline void _contention_acquired(struct _contention *c, int type)
+{
+	_contention_check(c, type);
+	c->stats.acquisitions++;
+}
+
+static inline void _contention_busy(struct _contention *c, int type)
+{
+	_contention_check(c, type);
+	c->stats.contended++;
+}
+
+/* returns the cycle count to pass to _contention_wait_end() */
+static inline uint32_t _contention_wait_start(struct _contention *c,
+					      int type)
+{
+	_contention_busy(c, type);
+	return sys_cycle_get_32();
+}
+
+static inline void _contention_hold_start(struct _contention *c)
+{
+	c->hold_start = sys_cycle_get_32();
+}
+
+static inline void _contention_hold_end(struct _contention *c)
+{
+	uint32_t hold = sys_cycle_get_32() - c->hold_start;
+
+	if (hold > c->stats.max_hold) {
+		c->stats.max_hold = hold;
+	}
+}
+
+#else
+
+#define _CONTENTION(obj) ((struct _contention *)NULL)
+
+#define K_CONTENTION_MUTEX 0
+#define K_CONTENTION_SEM 0
+#define K_CONTENTION_FIFO 0
+
+struct _contention;
+
+static inline void _contention_init(struct _contention *c, int type) { }
+static inline void _contention_acquired(struct _contention *c, int type) { }
+static inline void _contention_busy(struct _contention *c, int type) { }
+static inline uint32_t _contention_wait_start(struct _contention *c,
+					      int type)
+{
+	return 0;
+}
+static inline void _contention_wait_end(struct _contention *c,
+					uint32_t start, int acquired) { }
+static inline void _contention_hold_start(struct _contention *c) { }
+static inline void _contention_hold_end(struct _contention *c) { }
+
+#endif /* CONFIG_OBJECT_CONTENTION_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _kernel_unified_include_contention__h_ */
@@ -82,6 +82,18 @@ extern void _thread_exit(struct tcs *tcs);
 	} while (0)
 #endif /* CONFIG_THREAD_MONITOR */
 
+#ifdef CONFIG_SYS_CLOCK_EXISTS
+/* extend the 64-bit cycle count, on each tick with interrupts locked */
+extern void _sys_cycle_64_update(void);
+#else
+#define _sys_cycle_64_update() do { } while (0)
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/* cycles accounted to all threads since boot, interrupts must be locked */
+extern uint64_t _thread_runtime_total_get(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
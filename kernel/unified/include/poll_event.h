@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _kernel_unified_include_poll_event__h_
+#define _kernel_unified_include_poll_event__h_
+
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Polling hooks of the semaphore and fifo objects.
+ *
+ * They must be called with interrupts locked. They compile to nothing when
+ * CONFIG_POLL is disabled, _POLL_EVENT_OF() then gives NULL.
+ */
+
+#ifdef CONFIG_POLL
+
+#define _POLL_EVENT_OF(obj) (&(obj)->poll_event)
+
+static inline void _poll_event_init(struct k_poll_event **poll_event)
+{
+	*poll_event = NULL;
+}
+
+/*
+ * Marks the event registered on an object with @a state and readies its
+ * poller. Returns whether the caller must reschedule.
+ */
+extern int _handle_obj_poll_event(struct k_poll_event **poll_event,
+				  uint32_t state);
+
+#else
+
+#define _POLL_EVENT_OF(obj) ((struct k_poll_event **)NULL)
+
+#define K_POLL_STATE_SEM_AVAILABLE 0
+#define K_POLL_STATE_FIFO_DATA_AVAILABLE 0
+
+struct k_poll_event;
+
+static inline void _poll_event_init(struct k_poll_event **poll_event) { }
+static inline int _handle_obj_poll_event(struct k_poll_event **poll_event,
+					 uint32_t state)
+{
+	return 0;
+}
+
+#endif /* CONFIG_POLL */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _kernel_unified_include_poll_event__h_ */
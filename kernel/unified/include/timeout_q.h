@@ -24,11 +24,17 @@
 #define _kernel_nanokernel_include_timeout_q__h_
 
 #include <misc/dlist.h>
+#include <drivers/system_timer.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/* program the system timer for the next timeout or end of time slice */
+extern void _sys_clock_expiry_update(void);
+#endif
+
 /* initialize the nano timeouts part of k_thread when enabled in the kernel */
 
 static inline void _init_timeout(struct _timeout *t, _timeout_func_t func)
@@ -105,6 +111,19 @@ static inline struct _timeout *_handle_one_timeout(
 {
 	struct _timeout *t = (void *)sys_dlist_get(timeout_q);
 	struct k_thread *thread = t->thread;
+	struct _timeout *next;
+
+	/*
+	 * More ticks than the timeout had left may have been announced at
+	 * once, the ticks in excess count towards the next timeout.
+	 */
+	if (t->delta_ticks_from_prev < 0) {
+		next = (struct _timeout *)sys_dlist_peek_head(timeout_q);
+		if (next) {
+			next->delta_ticks_from_prev += t->delta_ticks_from_prev;
+		}
+		t->delta_ticks_from_prev = 0;
+	}
 
 	K_DEBUG("timeout %p\n", t);
 	if (thread != NULL) {
@@ -136,7 +155,7 @@ static inline void _handle_timeouts(void)
 	struct _timeout *next;
 
 	next = (struct _timeout *)sys_dlist_peek_head(timeout_q);
-	while (next && next->delta_ticks_from_prev == 0) {
+	while (next && next->delta_ticks_from_prev <= 0) {
 		next = _handle_one_timeout(timeout_q);
 	}
 }
@@ -220,6 +239,11 @@ static inline void _add_timeout(struct k_thread *thread,
 	K_DEBUG("timeout   %p before: next: %p, prev: %p\n",
 		timeout_obj, timeout_obj->node.next, timeout_obj->node.prev);
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* the timeout queue counts from the last announced tick */
+	timeout += _timer_elapsed_get();
+#endif
+
 	timeout_obj->thread = thread;
 	timeout_obj->delta_ticks_from_prev = timeout;
 	timeout_obj->wait_q = (sys_dlist_t *)wait_q;
@@ -227,6 +251,12 @@ static inline void _add_timeout(struct k_thread *thread,
 			    _is_timeout_insert_point,
 			    &timeout_obj->delta_ticks_from_prev);
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	if (sys_dlist_peek_head(timeout_q) == &timeout_obj->node) {
+		_sys_clock_expiry_update();
+	}
+#endif
+
 	K_DEBUG("timeout_q %p after:  head: %p, tail: %p\n",
 		&_nanokernel.timeout_q,
 		sys_dlist_peek_head(&_nanokernel.timeout_q),
@@ -23,6 +23,14 @@
 #include <misc/printk.h> /* printk */
 #include <sys_clock.h>
 #include <drivers/system_timer.h>
+#include <misc/int_latency.h>
+
+#ifdef CONFIG_INT_LATENCY_STATS
+#include <irq.h>
+#include <string.h>
+#include <misc/util.h>
+#include <kernel_event_logger_arch.h>
+#endif
 
 #define NB_CACHE_WARMING_DRY_RUN 7
 
@@ -50,6 +58,120 @@ static uint32_t int_latency_bench_ready;
 /* min amount of time it takes from HW interrupt generation to 'C' handler */
 uint32_t _hw_irq_to_c_handler_latency = ULONG_MAX;
 
+#ifdef CONFIG_INT_LATENCY_STATS
+/* deeper nested interrupts are not accounted */
+#define ISR_NESTING_MAX 4
+
+static struct int_latency_hist entry_hist;
+static struct int_latency_hist lock_hist;
+
+/* caller of the irq_lock() that locked interrupts, and of the longest lock */
+static void *int_locked_caller;
+static void *int_locked_worst_caller;
+static uint32_t int_locked_worst;
+
+static struct int_latency_irq_stats irq_stats[CONFIG_INT_LATENCY_STATS_IRQS];
+static int irq_stats_count;
+
+/* interrupts being serviced, outermost first */
+static struct int_latency_irq_stats *isr_stats[ISR_NESTING_MAX];
+static uint32_t isr_start[ISR_NESTING_MAX];
+static int isr_nesting;
+
+static inline void hist_add(struct int_latency_hist *hist, uint32_t cycles)
+{
+	hist->count[cycles > 1 ? 31 - __builtin_clz(cycles) : 0]++;
+}
+
+static struct int_latency_irq_stats *irq_stats_find(int irq)
+{
+	int i;
+
+	for (i = 0; i < irq_stats_count; i++) {
+		if (irq_stats[i].irq == irq) {
+			return &irq_stats[i];
+		}
+	}
+
+	if (irq_stats_count == CONFIG_INT_LATENCY_STATS_IRQS) {
+		return NULL;
+	}
+
+	irq_stats[irq_stats_count].irq = irq;
+	return &irq_stats[irq_stats_count++];
+}
+
+/**
+ *
+ * @brief Start timing an interrupt handler
+ *
+ * Called by the interrupt entry code with interrupts locked, before the
+ * handler is invoked.
+ *
+ * @return N/A
+ *
+ */
+void _int_latency_isr_enter(void)
+{
+	int level = isr_nesting++;
+
+	if (level >= ISR_NESTING_MAX) {
+		return;
+	}
+
+	isr_stats[level] = int_latency_bench_ready ?
+			   irq_stats_find(_sys_current_irq_key_get()) : NULL;
+	isr_start[level] = sys_cycle_get_32();
+}
+
+/**
+ *
+ * @brief Stop timing an interrupt handler
+ *
+ * Called by the interrupt exit code with interrupts locked, once the
+ * handler returned.
+ *
+ * @return N/A
+ *
+ */
+void _int_latency_isr_exit(void)
+{
+	struct int_latency_irq_stats *stats;
+	int level = --isr_nesting;
+	uint32_t cycles;
+
+	if (level >= ISR_NESTING_MAX || !isr_stats[level]) {
+		return;
+	}
+
+	cycles = sys_cycle_get_32() - isr_start[level];
+	stats = isr_stats[level];
+
+	stats->count++;
+	stats->cycles += cycles;
+	if (cycles > stats->max_cycles) {
+		stats->max_cycles = cycles;
+	}
+}
+
+/**
+ *
+ * @brief Record the latency from interrupt generation to handler
+ *
+ * Called by the system timer drivers able to tell when their interrupt
+ * was generated.
+ *
+ * @return N/A
+ *
+ */
+void _int_latency_entry_record(uint32_t cycles)
+{
+	if (int_latency_bench_ready) {
+		hist_add(&entry_hist, cycles);
+	}
+}
+#endif /* CONFIG_INT_LATENCY_STATS */
+
 /**
  *
  * @brief Start tracking time spent with interrupts locked
@@ -66,6 +188,9 @@ void _int_latency_start(void)
 	if (!int_locked_timestamp && int_latency_bench_ready) {
 		int_locked_timestamp = sys_cycle_get_32();
 		int_lock_unlock_nest = 0;
+#ifdef CONFIG_INT_LATENCY_STATS
+		int_locked_caller = __builtin_return_address(0);
+#endif
 	}
 	int_lock_unlock_nest++;
 }
@@ -116,6 +241,15 @@ void _int_latency_stop(void)
 		if (delta < int_locked_latency_min)
 			int_locked_latency_min = delta;
 
+#ifdef CONFIG_INT_LATENCY_STATS
+		hist_add(&lock_hist, delta);
+
+		if (delta > int_locked_worst) {
+			int_locked_worst = delta;
+			int_locked_worst_caller = int_locked_caller;
+		}
+#endif
+
 		/* interrupts are now enabled, get ready for next interrupt lock
 		 */
 		int_locked_timestamp = 0;
@@ -171,6 +305,11 @@ void int_latency_init(void)
 
 		cacheWarming--;
 	}
+
+#ifdef CONFIG_INT_LATENCY_STATS
+	/* drop the samples of the dry runs */
+	int_latency_stats_reset();
+#endif
 }
 
 /**
@@ -233,3 +372,114 @@ void int_latency_show(void)
 	int_locked_latency_min = ULONG_MAX;
 	int_locked_latency_max = 0;
 }
+
+#ifdef CONFIG_INT_LATENCY_STATS
+int int_latency_irq_stats_get(struct int_latency_irq_stats *irqs, int max)
+{
+	unsigned int key = irq_lock();
+	int count = irq_stats_count;
+
+	memcpy(irqs, irq_stats,
+	       (count < max ? count : max) * sizeof(*irqs));
+
+	irq_unlock(key);
+
+	return count;
+}
+
+void int_latency_hist_get(int which, struct int_latency_hist *hist)
+{
+	unsigned int key = irq_lock();
+
+	*hist = which == INT_LATENCY_HIST_ENTRY ? entry_hist : lock_hist;
+
+	irq_unlock(key);
+}
+
+void *int_latency_worst_lock_get(uint32_t *cycles)
+{
+	unsigned int key = irq_lock();
+	void *caller = int_locked_worst_caller;
+
+	*cycles = int_locked_worst;
+
+	irq_unlock(key);
+
+	return caller;
+}
+
+void int_latency_stats_reset(void)
+{
+	unsigned int key = irq_lock();
+	int i;
+
+	memset(&entry_hist, 0, sizeof(entry_hist));
+	memset(&lock_hist, 0, sizeof(lock_hist));
+	int_locked_worst = 0;
+	int_locked_worst_caller = NULL;
+
+	/* the interrupts being serviced keep their entry */
+	for (i = 0; i < irq_stats_count; i++) {
+		irq_stats[i].count = 0;
+		irq_stats[i].cycles = 0;
+		irq_stats[i].max_cycles = 0;
+	}
+
+	irq_unlock(key);
+}
+
+static void hist_show(const char *name, int which)
+{
+	struct int_latency_hist hist;
+	int i;
+
+	int_latency_hist_get(which, &hist);
+
+	printk(" %s (tcs):\n", name);
+
+	for (i = 0; i < INT_LATENCY_HIST_BUCKETS; i++) {
+		if (hist.count[i]) {
+			printk("  %10u - %10u: %u\n", i ? 1U << i : 0,
+			       (uint32_t)(2ULL << i) - 1, hist.count[i]);
+		}
+	}
+}
+
+void int_latency_stats_show(void)
+{
+	struct int_latency_irq_stats irqs[CONFIG_INT_LATENCY_STATS_IRQS];
+	uint32_t worst;
+	void *caller;
+	int count, i;
+
+	if (!int_latency_bench_ready) {
+		printk("error: int_latency_init() has not been invoked\n");
+		return;
+	}
+
+	count = int_latency_irq_stats_get(irqs, ARRAY_SIZE(irqs));
+
+	printk(" irq      count  total tcs    max tcs\n");
+	for (i = 0; i < count; i++) {
+		printk(" %3d %10u %10u %10u\n", irqs[i].irq, irqs[i].count,
+		       (uint32_t)irqs[i].cycles, irqs[i].max_cycles);
+	}
+
+	hist_show("Interrupt entry latency", INT_LATENCY_HIST_ENTRY);
+	hist_show("Interrupts locked", INT_LATENCY_HIST_LOCK);
+
+	caller = int_latency_worst_lock_get(&worst);
+	printk(" Longest interrupt lock: %u tcs = %u nsec, locked at %p\n",
+	       worst, SYS_CLOCK_HW_CYCLES_TO_NS(worst), caller);
+}
+
+int int_latency_shell_cmd(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	int_latency_stats_show();
+
+	return 0;
+}
+#endif /* CONFIG_INT_LATENCY_STATS */
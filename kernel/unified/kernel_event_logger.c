@@ -26,6 +26,8 @@
 #include <nano_private.h>
 #include <kernel_event_logger_arch.h>
 
+struct event_logger sys_k_event_logger;
+
 uint32_t _sys_k_event_logger_buffer[CONFIG_KERNEL_EVENT_LOGGER_BUFFER_SIZE];
 
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
@@ -33,7 +35,16 @@ void *_collector_fiber;
 #endif
 
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
-uint32_t _sys_k_event_logger_sleep_start_time;
+#ifdef CONFIG_SYS_CLOCK_EXISTS
+typedef uint64_t sleep_cycles_t;
+#define sleep_cycles_get() sys_cycle_get_64()
+#else
+/* the 64-bit count is extended on ticks, without them use the 32-bit one */
+typedef uint32_t sleep_cycles_t;
+#define sleep_cycles_get() sys_cycle_get_32()
+#endif
+
+sleep_cycles_t _sys_k_event_logger_sleep_start_time;
 #endif
 
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_DYNAMIC
@@ -93,6 +104,15 @@ void _sys_k_event_logger_context_switch(void)
 		return;
 	}
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_TRACE
+	/*
+	 * Recording a trace event does not signal the collector, the context
+	 * switches of the collector fiber are traced like any other.
+	 */
+	_sys_k_event_trace(KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, 0, 0);
+	return;
+#endif
+
 	/* if the kernel event logger has not been initialized, we do nothing */
 	if (sys_k_event_logger.ring_buf.buf == NULL) {
 		return;
@@ -141,6 +161,12 @@ void _sys_k_event_logger_interrupt(void)
 		return;
 	}
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_TRACE
+	_sys_k_event_trace(KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID,
+			   _sys_current_irq_key_get(), 0);
+	return;
+#endif
+
 	/* if the kernel event logger has not been initialized, we do nothing */
 	if (sys_k_event_logger.ring_buf.buf == NULL) {
 		return;
@@ -162,21 +188,33 @@ void _sys_k_event_logger_enter_sleep(void)
 		return;
 	}
 
-	_sys_k_event_logger_sleep_start_time = sys_cycle_get_32();
+	_sys_k_event_logger_sleep_start_time = sleep_cycles_get();
 }
 
 void _sys_k_event_logger_exit_sleep(void)
 {
 	uint32_t data[3];
+	uint64_t slept;
 
 	if (!sys_k_must_log_event(KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID)) {
 		return;
 	}
 
 	if (_sys_k_event_logger_sleep_start_time != 0) {
+		/* a long sleep may outlast a wrap of the 32-bit cycle count */
+		slept = (sleep_cycles_t)(sleep_cycles_get() -
+					 _sys_k_event_logger_sleep_start_time);
+		if (slept > UINT32_MAX) {
+			slept = UINT32_MAX;
+		}
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_TRACE
+		_sys_k_event_trace(KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID,
+				   _sys_current_irq_key_get(), (uint32_t)slept);
+		_sys_k_event_logger_sleep_start_time = 0;
+		return;
+#endif
 		data[0] = _sys_k_get_time();
-		data[1] = (sys_cycle_get_32() - _sys_k_event_logger_sleep_start_time)
-			/ sys_clock_hw_cycles_per_tick;
+		data[1] = (uint32_t)slept / sys_clock_hw_cycles_per_tick;
 		/* register the cause of exiting sleep mode */
 		data[2] = _sys_current_irq_key_get();
 
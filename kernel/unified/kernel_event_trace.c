@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Kernel event logger lock-free trace buffer.
+ *
+ * Records are reserved with a compare-and-swap on the write index, so
+ * recording an event never locks interrupts, even when it interrupts the
+ * recording of another one. The event ID of a record is written last: the
+ * collector stops at a reserved record whose event ID is still zero, and
+ * zeroes the event ID of the records it has consumed.
+ *
+ * The record fields are accessed through volatile pointers, which keeps the
+ * event ID store after the other ones on the single CPU the interrupted and
+ * interrupting contexts share.
+ */
+
+#include <misc/kernel_event_logger.h>
+#include <atomic.h>
+#include <nano_private.h>
+
+#define TRACE_SIZE CONFIG_KERNEL_EVENT_LOGGER_TRACE_BUFFER_SIZE
+#define TRACE_MASK (TRACE_SIZE - 1)
+
+#if (TRACE_SIZE & TRACE_MASK)
+#error "CONFIG_KERNEL_EVENT_LOGGER_TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+struct sys_k_event_trace_record _sys_k_event_trace_buffer[TRACE_SIZE];
+
+/* Records reserved and consumed since boot */
+static atomic_t trace_head;
+static atomic_t trace_tail;
+static atomic_t trace_dropped;
+
+void _sys_k_event_trace(uint16_t event_id, uint16_t data, uint32_t object)
+{
+	extern tNANO _nanokernel;
+	volatile struct sys_k_event_trace_record *rec;
+	atomic_val_t head;
+
+	do {
+		head = atomic_get(&trace_head);
+
+		if ((uint32_t)head - (uint32_t)atomic_get(&trace_tail) >=
+		    TRACE_SIZE) {
+			atomic_inc(&trace_dropped);
+			return;
+		}
+	} while (!atomic_cas(&trace_head, head, head + 1));
+
+	rec = &_sys_k_event_trace_buffer[head & TRACE_MASK];
+
+	rec->timestamp = _sys_k_get_time();
+	rec->data = data;
+	rec->thread = (uint32_t)_nanokernel.current;
+	rec->object = object;
+	rec->event_id = event_id;
+}
+
+int sys_k_event_trace_get(struct sys_k_event_trace_record *records, int max)
+{
+	volatile struct sys_k_event_trace_record *rec;
+	atomic_val_t tail = atomic_get(&trace_tail);
+	int count;
+
+	for (count = 0; count < max; count++, tail++) {
+		rec = &_sys_k_event_trace_buffer[tail & TRACE_MASK];
+
+		if (!rec->event_id) {
+			break;
+		}
+
+		records[count].timestamp = rec->timestamp;
+		records[count].event_id = rec->event_id;
+		records[count].data = rec->data;
+		records[count].thread = rec->thread;
+		records[count].object = rec->object;
+
+		/* release the record to the producers */
+		rec->event_id = 0;
+		atomic_set(&trace_tail, tail + 1);
+	}
+
+	return count;
+}
+
+uint32_t sys_k_event_trace_dropped_get(void)
+{
+	return atomic_get(&trace_dropped);
+}
@@ -42,6 +42,8 @@
 #include <sections.h>
 #include <wait_q.h>
 #include <misc/dlist.h>
+#include <misc/kernel_event_logger.h>
+#include <contention.h>
 #include <errno.h>
 
 #ifdef CONFIG_OBJECT_MONITOR
@@ -83,6 +85,7 @@ void k_mutex_init(struct k_mutex *mutex)
 
 	INIT_OBJECT_MONITOR(mutex);
 	INIT_KERNEL_TRACING(mutex);
+	_contention_init(_CONTENTION(mutex), K_CONTENTION_MUTEX);
 }
 
 static int new_prio_for_inheritance(int target, int limit)
@@ -110,6 +113,7 @@ static void adjust_owner_prio(struct k_mutex *mutex, int new_prio)
 int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 {
 	int new_prio, key;
+	uint32_t wait_start;
 
 	k_sched_lock();
 
@@ -117,6 +121,11 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 
 		RECORD_STATE_CHANGE();
 
+		_contention_acquired(_CONTENTION(mutex), K_CONTENTION_MUTEX);
+		if (mutex->lock_count == 0) {
+			_contention_hold_start(_CONTENTION(mutex));
+		}
+
 		mutex->owner_orig_prio = mutex->lock_count == 0 ?
 					_current->prio :
 					mutex->owner_orig_prio;
@@ -134,12 +143,18 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 	}
 
 	RECORD_CONFLICT();
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_MUTEX_CONTENDED_EVENT_ID,
+			       mutex, timeout != K_NO_WAIT);
 
 	if (unlikely(timeout == K_NO_WAIT)) {
+		_contention_busy(_CONTENTION(mutex), K_CONTENTION_MUTEX);
 		k_sched_unlock();
 		return -EBUSY;
 	}
 
+	wait_start = _contention_wait_start(_CONTENTION(mutex),
+					    K_CONTENTION_MUTEX);
+
 #if 0
 	if (_is_prio_higher(_current->prio, mutex->owner->prio)) {
 		new_prio = _current->prio;
@@ -158,6 +173,8 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 
 	int got_mutex = _Swap(key);
 
+	_contention_wait_end(_CONTENTION(mutex), wait_start, got_mutex == 0);
+
 	K_DEBUG("on mutex %p got_mutex value: %d\n", mutex, got_mutex);
 
 	K_DEBUG("%p got mutex %p (y/n): %c\n", _current, mutex,
@@ -209,6 +226,8 @@ void k_mutex_unlock(struct k_mutex *mutex)
 		return;
 	}
 
+	_contention_hold_end(_CONTENTION(mutex));
+
 	key = irq_lock();
 
 	adjust_owner_prio(mutex, mutex->owner_orig_prio);
@@ -233,6 +252,7 @@ void k_mutex_unlock(struct k_mutex *mutex)
 		 */
 		mutex->owner = new_owner;
 		mutex->lock_count++;
+		_contention_hold_start(_CONTENTION(mutex));
 		mutex->owner_orig_prio = new_owner->prio;
 	} else {
 		irq_unlock(key);
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Waiting on several kernel objects at once
+ *
+ * A poller that finds none of its events ready registers each of them on
+ * its object, then pends on a wait queue of its own. Giving a semaphore,
+ * putting data in a fifo or raising a signal that no thread is waiting on
+ * sets the state of the event registered on the object and readies the
+ * poller, which unregisters all its events once it runs again.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <poll_event.h>
+#include <wait_q.h>
+#include <sched.h>
+#include <misc/slist.h>
+#include <errno.h>
+
+void k_poll_event_init(struct k_poll_event *event, uint32_t type,
+		       void *obj)
+{
+	__ASSERT(type <= K_POLL_TYPE_FIFO_DATA_AVAILABLE, "invalid type");
+	__ASSERT(obj || type == K_POLL_TYPE_IGNORE, "must provide an object");
+
+	event->poller = NULL;
+	event->type = type;
+	event->state = K_POLL_STATE_NOT_READY;
+	event->obj = obj;
+}
+
+/* must be called with interrupts locked */
+static uint32_t event_state(struct k_poll_event *event)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		if (event->sem->count > 0) {
+			return K_POLL_STATE_SEM_AVAILABLE;
+		}
+		break;
+	case K_POLL_TYPE_FIFO_DATA_AVAILABLE:
+		if (!sys_slist_is_empty(&event->fifo->data_q)) {
+			return K_POLL_STATE_FIFO_DATA_AVAILABLE;
+		}
+		break;
+	case K_POLL_TYPE_SIGNAL:
+		if (event->signal->signaled) {
+			return K_POLL_STATE_SIGNALED;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return K_POLL_STATE_NOT_READY;
+}
+
+static struct k_poll_event **obj_poll_event(struct k_poll_event *event)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		return &event->sem->poll_event;
+	case K_POLL_TYPE_FIFO_DATA_AVAILABLE:
+		return &event->fifo->poll_event;
+	case K_POLL_TYPE_SIGNAL:
+		return &event->signal->poll_event;
+	default:
+		return NULL;
+	}
+}
+
+/* must be called with interrupts locked */
+static void clear_events(struct k_poll_event *events, int num_events)
+{
+	struct k_poll_event **poll_event;
+	int i;
+
+	for (i = 0; i < num_events; i++) {
+		poll_event = obj_poll_event(&events[i]);
+
+		/* the object drops the event when it readies the poller */
+		if (poll_event && *poll_event == &events[i]) {
+			*poll_event = NULL;
+		}
+		events[i].poller = NULL;
+	}
+}
+
+int k_poll(struct k_poll_event *events, int num_events, int32_t timeout)
+{
+	struct k_poll_event **poll_event;
+	unsigned int key;
+	_wait_q_t wait_q;
+	int ready = 0;
+	int i, rc;
+
+	__ASSERT(!_is_in_isr(), "");
+	__ASSERT(events, "NULL events\n");
+	__ASSERT(num_events > 0, "zero events\n");
+
+	key = irq_lock();
+
+	for (i = 0; i < num_events; i++) {
+		events[i].state = event_state(&events[i]);
+		ready |= events[i].state != K_POLL_STATE_NOT_READY;
+	}
+
+	if (ready) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	if (timeout == K_NO_WAIT) {
+		irq_unlock(key);
+		return -EAGAIN;
+	}
+
+	for (i = 0; i < num_events; i++) {
+		poll_event = obj_poll_event(&events[i]);
+		if (!poll_event) {
+			continue;
+		}
+
+		/* an object can appear in several events of the poll */
+		if (*poll_event && (*poll_event)->poller == _current) {
+			continue;
+		}
+
+		if (*poll_event) {
+			events[i].state = K_POLL_STATE_EADDRINUSE;
+			clear_events(events, i);
+			irq_unlock(key);
+			return -EADDRINUSE;
+		}
+
+		events[i].poller = _current;
+		*poll_event = &events[i];
+	}
+
+	sys_dlist_init(&wait_q);
+	_pend_current_thread(&wait_q, timeout);
+
+	rc = _Swap(key);
+
+	key = irq_lock();
+
+	clear_events(events, num_events);
+
+	/* an event can get ready after the timeout readied the poller */
+	if (rc == -EAGAIN) {
+		for (i = 0; i < num_events; i++) {
+			if (events[i].state != K_POLL_STATE_NOT_READY) {
+				rc = 0;
+				break;
+			}
+		}
+	}
+
+	irq_unlock(key);
+
+	return rc;
+}
+
+int _handle_obj_poll_event(struct k_poll_event **poll_event, uint32_t state)
+{
+	struct k_poll_event *event = *poll_event;
+	struct k_thread *thread;
+
+	if (!event) {
+		return 0;
+	}
+
+	*poll_event = NULL;
+	event->state = state;
+
+	thread = event->poller;
+
+	/* already readied by another of its events, or its timeout */
+	if (!_is_thread_pending(thread)) {
+		return 0;
+	}
+
+	_unpend_thread(thread);
+	_abort_thread_timeout(thread);
+	_ready_thread(thread);
+	_set_thread_return_value(thread, 0);
+
+	return !_is_in_isr() && _must_switch_threads();
+}
+
+void k_poll_signal_init(struct k_poll_signal *signal)
+{
+	signal->poll_event = NULL;
+	signal->signaled = 0;
+	signal->result = 0;
+}
+
+void k_poll_signal(struct k_poll_signal *signal, int result)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	signal->result = result;
+	signal->signaled = 1;
+
+	if (_handle_obj_poll_event(&signal->poll_event,
+				   K_POLL_STATE_SIGNALED)) {
+		_Swap(key);
+	} else {
+		irq_unlock(key);
+	}
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Priority workqueues
+ *
+ * Pending items are kept in a list sorted by priority and deadline, and
+ * counted by a semaphore the worker threads take before removing the head
+ * of the list. A worker that finds the list empty because the item it was
+ * woken for got cancelled goes back to waiting.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <misc/dlist.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+/* insert before the first item that is to execute after the new one */
+static int is_insert_point(sys_dnode_t *node, void *data)
+{
+	struct k_prio_work *pos = CONTAINER_OF(node, struct k_prio_work, node);
+	struct k_prio_work *work = data;
+
+	if (pos->prio != work->prio) {
+		return pos->prio > work->prio;
+	}
+
+	if (!work->has_deadline) {
+		return 0;
+	}
+
+	return !pos->has_deadline ||
+	       (int32_t)(pos->deadline - work->deadline) > 0;
+}
+
+static void update_stats(struct k_prio_work_q_stats *stats, uint32_t wait,
+			 uint32_t exec)
+{
+	stats->total_wait += wait;
+	if (wait > stats->max_wait) {
+		stats->max_wait = wait;
+	}
+
+	stats->total_exec += exec;
+	if (exec > stats->max_exec) {
+		stats->max_exec = exec;
+	}
+
+	stats->executed++;
+}
+
+static void prio_work_q_main(void *work_q_ptr, void *p2, void *p3)
+{
+	struct k_prio_work_q *work_q = work_q_ptr;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		struct k_prio_work *work;
+		sys_dnode_t *node;
+		uint32_t start, wait;
+		unsigned int key;
+		int missed;
+
+		k_sem_take(&work_q->sem, K_FOREVER);
+
+		key = irq_lock();
+
+		node = sys_dlist_get(&work_q->queue);
+		if (!node) {
+			irq_unlock(key);
+			continue;
+		}
+		work = CONTAINER_OF(node, struct k_prio_work, node);
+
+		start = k_cycle_get_32();
+		wait = start - work->submit_time;
+		missed = work->has_deadline &&
+			 (int32_t)(k_uptime_get_32() - work->deadline) > 0;
+
+		/* Reset pending state so it can be resubmitted by handler */
+		atomic_clear_bit(work->work.flags, K_WORK_STATE_PENDING);
+
+		irq_unlock(key);
+
+		work->work.handler(&work->work);
+
+		key = irq_lock();
+		update_stats(&work_q->stats, wait, k_cycle_get_32() - start);
+		work_q->stats.deadline_misses += missed;
+		irq_unlock(key);
+
+		/* Let the other workers and equal priority threads run */
+		k_yield();
+	}
+}
+
+void k_prio_work_q_start(struct k_prio_work_q *work_q,
+			 const struct k_thread_config *config, int workers)
+{
+	int i;
+
+	sys_dlist_init(&work_q->queue);
+	k_sem_init(&work_q->sem, 0, UINT_MAX);
+	memset(&work_q->stats, 0, sizeof(work_q->stats));
+
+	for (i = 0; i < workers; i++) {
+		k_thread_spawn(config->stack + i * config->stack_size,
+			       config->stack_size, prio_work_q_main, work_q,
+			       0, 0, config->prio, 0, 0);
+	}
+}
+
+void k_prio_work_submit(struct k_prio_work_q *work_q,
+			struct k_prio_work *work, int prio, int32_t deadline)
+{
+	unsigned int key = irq_lock();
+
+	/* pending items are in the list, for k_prio_work_cancel() */
+	if (atomic_test_and_set_bit(work->work.flags, K_WORK_STATE_PENDING)) {
+		irq_unlock(key);
+		return;
+	}
+
+	work->prio = prio;
+	work->has_deadline = (deadline != K_FOREVER);
+	work->deadline = k_uptime_get_32() + deadline;
+	work->submit_time = k_cycle_get_32();
+	sys_dlist_insert_at(&work_q->queue, &work->node, is_insert_point,
+			    work);
+
+	irq_unlock(key);
+
+	k_sem_give(&work_q->sem);
+}
+
+int k_prio_work_cancel(struct k_prio_work_q *work_q, struct k_prio_work *work)
+{
+	unsigned int key = irq_lock();
+
+	if (!k_work_pending(&work->work)) {
+		irq_unlock(key);
+		return -EINVAL;
+	}
+
+	sys_dlist_remove(&work->node);
+	atomic_clear_bit(work->work.flags, K_WORK_STATE_PENDING);
+
+	/* a worker may already be on its way to the item, see above */
+	k_sem_take(&work_q->sem, K_NO_WAIT);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+void k_prio_work_q_stats_get(struct k_prio_work_q *work_q,
+			     struct k_prio_work_q_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	*stats = work_q->stats;
+
+	irq_unlock(key);
+}
+
+void k_prio_work_q_stats_reset(struct k_prio_work_q *work_q)
+{
+	unsigned int key = irq_lock();
+
+	memset(&work_q->stats, 0, sizeof(work_q->stats));
+
+	irq_unlock(key);
+}
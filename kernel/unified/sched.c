@@ -355,5 +355,12 @@ void k_sched_time_slice_set(int32_t duration_in_ms, int prio)
 	_time_slice_duration = duration_in_ms;
 	_time_slice_elapsed = 0;
 	_time_slice_prio_ceiling = prio;
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	unsigned int key = irq_lock();
+
+	_sys_clock_expiry_update();
+	irq_unlock(key);
+#endif
 }
 #endif /* CONFIG_TIMESLICING */
@@ -29,6 +29,9 @@
 #include <kernel.h>
 #include <nano_private.h>
 #include <misc/debug/object_tracing_common.h>
+#include <misc/kernel_event_logger.h>
+#include <contention.h>
+#include <poll_event.h>
 #include <toolchain.h>
 #include <sections.h>
 #include <wait_q.h>
@@ -57,6 +60,8 @@ void k_sem_init(struct k_sem *sem, unsigned int initial_count,
 	sem->limit = limit;
 	sys_dlist_init(&sem->wait_q);
 	SYS_TRACING_OBJ_INIT(nano_sem, sem);
+	_contention_init(_CONTENTION(sem), K_CONTENTION_SEM);
+	_poll_event_init(_POLL_EVENT_OF(sem));
 }
 
 #ifdef CONFIG_SEMAPHORE_GROUPS
@@ -221,6 +226,8 @@ static bool sem_give_common(struct k_sem *sem)
 {
 	struct k_thread *thread;
 
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_GIVE_EVENT_ID, sem, 0);
+
 	thread = _unpend_first_thread(&sem->wait_q);
 	if (!thread) {
 		/*
@@ -229,7 +236,8 @@ static bool sem_give_common(struct k_sem *sem)
 		 * its limit has already been reached.
 		 */
 		sem->count += (sem->count != sem->limit);
-		return false;
+		return _handle_obj_poll_event(_POLL_EVENT_OF(sem),
+					      K_POLL_STATE_SEM_AVAILABLE);
 	}
 
 	_abort_thread_timeout(thread);
@@ -294,19 +302,31 @@ int k_sem_take(struct k_sem *sem, int32_t timeout)
 	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
 
 	unsigned int key = irq_lock();
+	uint32_t wait_start;
+	int ret;
 
 	if (likely(sem->count > 0)) {
 		sem->count--;
+		_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID,
+				       sem, 0);
+		_contention_acquired(_CONTENTION(sem), K_CONTENTION_SEM);
 		irq_unlock(key);
 		return 0;
 	}
 
 	if (timeout == K_NO_WAIT) {
+		_contention_busy(_CONTENTION(sem), K_CONTENTION_SEM);
 		irq_unlock(key);
 		return -EBUSY;
 	}
 
+	_SYS_K_EVENT_TRACE_OBJ(KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID, sem, 1);
+	wait_start = _contention_wait_start(_CONTENTION(sem), K_CONTENTION_SEM);
 	_pend_current_thread(&sem->wait_q, timeout);
 
-	return _Swap(key);
+	ret = _Swap(key);
+
+	_contention_wait_end(_CONTENTION(sem), wait_start, ret == 0);
+
+	return ret;
 }
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Thread stack usage reporting
+ *
+ * _new_thread() fills the stack area of each thread with 0xaa and records
+ * its size in the TCS, which sits at the start of the area. The high water
+ * mark is found by looking for the first byte overwritten since.
+ */
+
+#include <nano_private.h>
+#include <misc/stack.h>
+#include <misc/printk.h>
+
+#define MAX_THREADS 16
+
+int stack_usage_get(struct stack_usage *usage, int max)
+{
+	struct tcs *thread;
+	unsigned int key;
+	int count = 0;
+	int i;
+
+	key = irq_lock();
+
+	for (thread = _nanokernel.threads; thread;
+	     thread = thread->next_thread, count++) {
+		if (count < max) {
+			usage[count].thread = thread;
+			usage[count].size = thread->stack_size -
+					    sizeof(struct tcs);
+		}
+	}
+
+	irq_unlock(key);
+
+	/*
+	 * Scan the stacks with interrupts unlocked, a thread exiting in the
+	 * meantime leaves its stack area behind.
+	 */
+	for (i = 0; i < count && i < max; i++) {
+		usage[i].used = usage[i].size -
+			stack_unused_space_get(usage[i].thread,
+					       usage[i].size +
+					       sizeof(struct tcs),
+					       sizeof(struct tcs));
+	}
+
+	return count;
+}
+
+void stack_usage_print(void)
+{
+	struct stack_usage usage[MAX_THREADS];
+	int count, i;
+
+	count = stack_usage_get(usage, MAX_THREADS);
+
+	for (i = 0; i < count && i < MAX_THREADS; i++) {
+		printk("%p:\tsize %u\tused %u (%u %%)\n", usage[i].thread,
+		       usage[i].size, usage[i].used,
+		       usage[i].used * 100 / usage[i].size);
+	}
+
+	if (count > MAX_THREADS) {
+		printk("%d more threads\n", count - MAX_THREADS);
+	}
+}
+
+int stack_usage_shell_cmd(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	stack_usage_print();
+
+	return 0;
+}
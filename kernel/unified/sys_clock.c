@@ -44,6 +44,13 @@ int32_t _sys_idle_elapsed_ticks = 1;
 
 int64_t _sys_clock_tick_count;
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/* the ticks elapsed since the last announced one are not counted yet */
+#define unannounced_ticks() _timer_elapsed_get()
+#else
+#define unannounced_ticks() 0
+#endif
+
 /**
  *
  * @brief Return the lower part of the current system tick count
@@ -53,7 +60,11 @@ int64_t _sys_clock_tick_count;
  */
 uint32_t sys_tick_get_32(void)
 {
+#ifdef CONFIG_TICKLESS_KERNEL
+	return (uint32_t)sys_tick_get();
+#else
 	return (uint32_t)_sys_clock_tick_count;
+#endif
 }
 
 uint32_t k_uptime_get_32(void)
@@ -79,7 +90,7 @@ int64_t sys_tick_get(void)
 	 */
 	unsigned int imask = irq_lock();
 
-	tmp_sys_clock_tick_count = _sys_clock_tick_count;
+	tmp_sys_clock_tick_count = _sys_clock_tick_count + unannounced_ticks();
 	irq_unlock(imask);
 	return tmp_sys_clock_tick_count;
 }
@@ -130,7 +141,7 @@ static ALWAYS_INLINE int64_t _nano_tick_delta(int64_t *reftime)
 	 */
 	unsigned int imask = irq_lock();
 
-	saved = _sys_clock_tick_count;
+	saved = _sys_clock_tick_count + unannounced_ticks();
 	irq_unlock(imask);
 	delta = saved - (*reftime);
 	*reftime = saved;
@@ -217,6 +228,57 @@ static void handle_time_slicing(int32_t ticks)
 #else
 #define handle_time_slicing(ticks) do { } while (0)
 #endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * Ticks from the last announced tick until the timer must interrupt: when
+ * the next timeout expires, or sooner if the time slice of @a thread ends
+ * first.
+ */
+static int32_t next_expiry(struct k_thread *thread)
+{
+	int32_t ticks = _get_next_timeout_expiry();
+
+#ifdef CONFIG_TIMESLICING
+	int32_t slice;
+
+	if (_time_slice_duration != 0 && thread != _idle_thread &&
+	    !_is_prio_higher(thread->prio, _time_slice_prio_ceiling)) {
+		slice = _ms_to_ticks(_time_slice_duration -
+				     _time_slice_elapsed);
+		if (ticks == K_FOREVER || slice < ticks) {
+			ticks = slice;
+		}
+	}
+#else
+	ARG_UNUSED(thread);
+#endif
+
+	return ticks;
+}
+
+/* must be called with interrupts locked */
+void _sys_clock_expiry_update(void)
+{
+	_timer_expiry_set(next_expiry(_current));
+}
+
+#ifdef CONFIG_TIMESLICING
+/*
+ * Called by _Swap() with interrupts locked, before it switches to the next
+ * ready thread. That thread starts a new time slice, counted from now
+ * rather than from the last announced tick, and the timer is reprogrammed
+ * for the end of it.
+ */
+void _sys_clock_slice_switch(void)
+{
+	struct k_thread *thread = _get_next_ready_thread();
+
+	_time_slice_elapsed = -_ticks_to_ms(_timer_elapsed_get());
+	_timer_expiry_set(next_expiry(thread));
+}
+#endif
+#endif
 /**
  *
  * @brief Announce a tick to the nanokernel
@@ -235,9 +297,14 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 
 	key = irq_lock();
 	_sys_clock_tick_count += ticks;
+	_sys_cycle_64_update();
 	handle_expired_timeouts(ticks);
 
 	handle_time_slicing(ticks);
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	_sys_clock_expiry_update();
+#endif
+
 	irq_unlock(key);
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Thread runtime statistics
+ *
+ * _Swap() calls _thread_runtime_switch() before picking the next thread,
+ * while the outgoing thread is still current. The cycles since the previous
+ * context switch are the run of the outgoing thread, the incoming one starts
+ * its run at the same cycle count.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <nano_internal.h>
+#include <sched.h>
+
+/* cycle count at the last context switch */
+static uint32_t last_switch;
+
+/* cycles accounted to all threads up to the last context switch */
+static uint64_t total_cycles;
+
+void _thread_runtime_switch(void)
+{
+	struct k_thread_runtime_stats *stats = &_current->runtime;
+	uint32_t now = sys_cycle_get_32();
+	uint32_t run = now - last_switch;
+
+	stats->cycles += run;
+	stats->switches++;
+
+	if (_is_thread_ready(_current)) {
+		stats->preemptions++;
+	}
+
+	if (run > stats->max_run) {
+		stats->max_run = run;
+	}
+
+	total_cycles += run;
+	last_switch = now;
+}
+
+/* must be called with interrupts locked */
+static void stats_get(struct k_thread *thread,
+		      struct k_thread_runtime_stats *stats)
+{
+	uint32_t run;
+
+	*stats = thread->runtime;
+
+	if (thread == _current) {
+		run = sys_cycle_get_32() - last_switch;
+
+		stats->cycles += run;
+		if (run > stats->max_run) {
+			stats->max_run = run;
+		}
+	}
+}
+
+uint64_t _thread_runtime_total_get(void)
+{
+	return total_cycles + (sys_cycle_get_32() - last_switch);
+}
+
+void k_thread_runtime_stats_get(k_tid_t thread,
+				struct k_thread_runtime_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	stats_get(thread, stats);
+
+	irq_unlock(key);
+}
+
+int k_thread_runtime_stats_all_get(struct k_thread_runtime *threads, int max)
+{
+	struct k_thread *thread;
+	unsigned int key;
+	int count = 0;
+
+	key = irq_lock();
+
+	for (thread = _nanokernel.threads; thread;
+	     thread = thread->next_thread, count++) {
+		if (count < max) {
+			threads[count].thread = thread;
+			stats_get(thread, &threads[count].stats);
+		}
+	}
+
+	irq_unlock(key);
+
+	return count;
+}
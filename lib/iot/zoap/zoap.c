@@ -23,6 +23,7 @@
 
 #include <misc/byteorder.h>
 #include <net/ip_buf.h>
+#include <sys_clock.h>
 
 #include "zoap.h"
 
@@ -39,6 +40,8 @@ struct option_context {
 
 #define BASIC_HEADER_SIZE 4
 
+#define NOTIFY_MIN_INTERVAL MSEC(CONFIG_ZOAP_OBSERVE_MIN_INTERVAL)
+
 static uint8_t coap_option_header_get_delta(uint8_t buf)
 {
 	return (buf & 0xF0) >> 4;
@@ -663,16 +666,124 @@ void zoap_reply_clear(struct zoap_reply *reply)
 	reply->reply = NULL;
 }
 
+static int32_t observer_next_notify(const struct zoap_observer *observer,
+				    uint32_t now)
+{
+	uint32_t elapsed = now - observer->last_notify;
+
+	if (elapsed >= NOTIFY_MIN_INTERVAL) {
+		return 0;
+	}
+
+	return NOTIFY_MIN_INTERVAL - elapsed;
+}
+
+static void observer_notify(struct zoap_resource *resource,
+			    struct zoap_observer *observer, uint32_t now)
+{
+	observer->pending = false;
+	observer->last_notify = now;
+
+	resource->notify(resource, observer);
+}
+
 int zoap_resource_notify(struct zoap_resource *resource)
 {
-	sys_snode_t *node;
+	sys_snode_t *node, *next;
+	uint32_t now = sys_tick_get_32();
 
 	resource->age++;
 
-	SYS_SLIST_FOR_EACH_NODE(&resource->observers, node) {
+	/* The callback may remove the observer from the list */
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&resource->observers, node, next) {
 		struct zoap_observer *o = (struct zoap_observer *) node;
 
-		resource->notify(resource, o);
+		/*
+		 * An observer that was notified recently only gets the
+		 * latest state once its interval expires.
+		 */
+		if (observer_next_notify(o, now)) {
+			o->pending = true;
+			continue;
+		}
+
+		observer_notify(resource, o, now);
+	}
+
+	return 0;
+}
+
+int zoap_resource_notify_pending(struct zoap_resource *resource)
+{
+	sys_snode_t *node, *next;
+	uint32_t now = sys_tick_get_32();
+	int32_t timeout = 0;
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&resource->observers, node, next) {
+		struct zoap_observer *o = (struct zoap_observer *) node;
+		int32_t ticks;
+
+		if (!o->pending) {
+			continue;
+		}
+
+		ticks = observer_next_notify(o, now);
+		if (ticks) {
+			if (!timeout || ticks < timeout) {
+				timeout = ticks;
+			}
+			continue;
+		}
+
+		observer_notify(resource, o, now);
+	}
+
+	if (!timeout) {
+		return 0;
+	}
+
+	/* Round up, so the caller doesn't wake up too early */
+	return (timeout * MSEC_PER_SEC + sys_clock_ticks_per_sec - 1) /
+		sys_clock_ticks_per_sec;
+}
+
+int zoap_notification_patch(struct zoap_packet *pkt,
+			    const struct zoap_packet *tmpl,
+			    const struct zoap_observer *observer,
+			    uint16_t id)
+{
+	struct net_buf *buf = pkt->buf;
+	uint8_t *appdata = ip_buf_appdata(buf);
+	uint8_t *tmpldata = ip_buf_appdata(tmpl->buf);
+	uint16_t tmpllen = ip_buf_appdatalen(tmpl->buf);
+	uint16_t len;
+
+	if (coap_header_get_tkl(tmpl) != 0) {
+		return -EINVAL;
+	}
+
+	len = tmpllen + observer->tkl;
+	if (len > net_buf_tailroom(buf)) {
+		return -ENOMEM;
+	}
+
+	/* Header, with the token length replaced */
+	appdata[0] = (tmpldata[0] & 0xF0) | observer->tkl;
+	appdata[1] = tmpldata[1];
+	sys_put_be16(id, &appdata[2]);
+
+	memcpy(appdata + BASIC_HEADER_SIZE, observer->token, observer->tkl);
+
+	/* Options and payload are shared by all observers */
+	memcpy(appdata + BASIC_HEADER_SIZE + observer->tkl,
+	       tmpldata + BASIC_HEADER_SIZE, tmpllen - BASIC_HEADER_SIZE);
+
+	ip_buf_appdatalen(buf) = len;
+
+	if (tmpl->start) {
+		pkt->start = appdata + (tmpl->start - tmpldata) + observer->tkl;
+	} else {
+		pkt->start = NULL;
 	}
 
 	return 0;
@@ -702,6 +813,10 @@ void zoap_observer_init(struct zoap_observer *observer,
 	/* FIXME: new network stack */
 	uip_ipaddr_copy(&observer->addr, addr);
 	observer->port = port;
+
+	/* The response to the registration carries the current state */
+	observer->last_notify = sys_tick_get_32();
+	observer->pending = false;
 }
 
 bool zoap_register_observer(struct zoap_resource *resource,
@@ -157,6 +157,10 @@ typedef int (*zoap_method_t)(struct zoap_resource *resource,
 /**
  * Type of the callback being called when a resource's has observers to be
  * informed when an update happens.
+ *
+ * As every observer receives the same representation, the callback may
+ * encode the notification once per resource age and use
+ * zoap_notification_patch() to produce the packet for each observer.
  */
 typedef void (*zoap_notify_t)(struct zoap_resource *resource,
 			      struct zoap_observer *observer);
@@ -185,6 +189,8 @@ struct zoap_observer {
 	uint16_t port;
 	uint8_t token[8];
 	uint8_t tkl;
+	uint32_t last_notify; /* in ticks */
+	bool pending;
 };
 
 /**
@@ -355,9 +361,33 @@ int zoap_handle_request(struct zoap_packet *pkt,
 /**
  * Indicates that this resource was updated and that the @a notify callback
  * should be called for every registered observer.
+ *
+ * Observers that were notified less than CONFIG_ZOAP_OBSERVE_MIN_INTERVAL
+ * milliseconds ago are only marked as pending; further updates before they
+ * are notified are coalesced into a single notification, sent by
+ * zoap_resource_notify_pending().
  */
 int zoap_resource_notify(struct zoap_resource *resource);
 
+/**
+ * Calls the @a notify callback for the pending observers of this resource
+ * whose minimum notification interval has expired. Returns how many ms
+ * until the next pending observer may be notified, or 0 if there are no
+ * pending observers left.
+ */
+int zoap_resource_notify_pending(struct zoap_resource *resource);
+
+/**
+ * Builds the notification for @a observer in @a pkt from @a tmpl, a
+ * notification encoded once without a token. Only the token and message
+ * id are filled in, header fields, options and payload are copied as is.
+ * @a pkt must have been initialized with zoap_packet_init().
+ */
+int zoap_notification_patch(struct zoap_packet *pkt,
+			    const struct zoap_packet *tmpl,
+			    const struct zoap_observer *observer,
+			    uint16_t id);
+
 /**
  * Returns if this request is enabling observing a resource.
  */
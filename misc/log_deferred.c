@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Deferred logging
+ *
+ * Records are reserved in the ring buffer with a compare-and-swap on the
+ * write index, so a log call never takes a lock or waits, even when it
+ * interrupts another one. A record is [header, format, arguments...], one
+ * word each. The header is written last: the output side stops at a
+ * reserved record whose header is still zero, and zeroes the words of the
+ * records it has consumed.
+ *
+ * The output fiber runs periodically. It is only woken up by a log call
+ * when the buffer gets half full, so logging from a task does not switch
+ * to it right away.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+
+#include <nanokernel.h>
+#include <init.h>
+#include <atomic.h>
+#include <misc/log_deferred.h>
+
+#define LOG_WORDS (CONFIG_LOG_DEFERRED_BUF_SIZE / 4)
+#define LOG_MASK (LOG_WORDS - 1)
+
+#if (LOG_WORDS & LOG_MASK)
+#error "CONFIG_LOG_DEFERRED_BUF_SIZE must be a power of two"
+#endif
+
+#define LOG_PERIOD \
+	((CONFIG_LOG_DEFERRED_PERIOD * sys_clock_ticks_per_sec + 999) / 1000)
+
+#define LOG_HDR_MAGIC 0xA5000000
+#define LOG_HDR_NARGS(hdr) ((hdr) & 0xff)
+
+/* Words of a record with n arguments */
+#define LOG_RECORD_WORDS(n) ((n) + 2)
+
+extern void _printk_argv(const char *fmt, const unsigned long *argv);
+
+static atomic_t log_buf[LOG_WORDS];
+
+/* Free running word counts, wrapped with LOG_MASK */
+static atomic_t log_head;
+static atomic_t log_tail;
+
+static atomic_t log_logged;
+static atomic_t log_dropped;
+static atomic_t log_output;
+
+/* Set once a log call has woken up the output fiber */
+static atomic_t log_wakeup;
+/* Set while a context outputs the log */
+static atomic_t log_busy;
+
+static struct nano_sem log_sem;
+
+static char __stack log_stack[CONFIG_LOG_DEFERRED_FIBER_STACK_SIZE];
+
+void log_deferred(const char *fmt, int nargs, ...)
+{
+	atomic_val_t head, words;
+	va_list ap;
+	int i;
+
+	if (nargs > LOG_DEFERRED_MAX_ARGS) {
+		nargs = LOG_DEFERRED_MAX_ARGS;
+	}
+
+	words = LOG_RECORD_WORDS(nargs);
+
+	do {
+		head = atomic_get(&log_head);
+
+		if ((uint32_t)(head - atomic_get(&log_tail)) + words >
+		    LOG_WORDS) {
+			atomic_inc(&log_dropped);
+			return;
+		}
+	} while (!atomic_cas(&log_head, head, head + words));
+
+	log_buf[(head + 1) & LOG_MASK] = (atomic_val_t)fmt;
+
+	va_start(ap, nargs);
+	for (i = 0; i < nargs; i++) {
+		log_buf[(head + 2 + i) & LOG_MASK] =
+			(atomic_val_t)va_arg(ap, unsigned long);
+	}
+	va_end(ap);
+
+	/* Commit, the atomic store orders it after the words above */
+	atomic_set(&log_buf[head & LOG_MASK], LOG_HDR_MAGIC | nargs);
+	atomic_inc(&log_logged);
+
+	if ((uint32_t)(head + words - atomic_get(&log_tail)) > LOG_WORDS / 2 &&
+	    !atomic_set(&log_wakeup, 1)) {
+		nano_sem_give(&log_sem);
+	}
+}
+
+/* Output the committed records, returns the number output */
+static int log_process(void)
+{
+	static atomic_val_t dropped_reported;
+	unsigned long argv[LOG_DEFERRED_MAX_ARGS];
+	atomic_val_t tail, hdr, dropped;
+	const char *fmt;
+	int nargs, i, count = 0;
+
+	tail = atomic_get(&log_tail);
+
+	while (tail != atomic_get(&log_head)) {
+		hdr = atomic_get(&log_buf[tail & LOG_MASK]);
+		if (!hdr) {
+			/* reserved by a log call that has not finished */
+			break;
+		}
+
+		nargs = LOG_HDR_NARGS(hdr);
+		fmt = (const char *)log_buf[(tail + 1) & LOG_MASK];
+
+		for (i = 0; i < nargs; i++) {
+			argv[i] = log_buf[(tail + 2 + i) & LOG_MASK];
+		}
+
+		for (i = 0; i < LOG_RECORD_WORDS(nargs); i++) {
+			log_buf[(tail + i) & LOG_MASK] = 0;
+		}
+
+		/* Free the space before the slow part */
+		tail += LOG_RECORD_WORDS(nargs);
+		atomic_set(&log_tail, tail);
+
+		_printk_argv(fmt, argv);
+		atomic_inc(&log_output);
+		count++;
+	}
+
+	dropped = atomic_get(&log_dropped);
+	if (dropped != dropped_reported) {
+		/* printk() itself may be deferred */
+		argv[0] = dropped - dropped_reported;
+		_printk_argv("--- %u log messages dropped ---\n", argv);
+		dropped_reported = dropped;
+	}
+
+	return count;
+}
+
+int log_deferred_flush(void)
+{
+	int count;
+
+	if (atomic_set(&log_busy, 1)) {
+		return -EBUSY;
+	}
+
+	count = log_process();
+
+	atomic_clear(&log_busy);
+
+	return count;
+}
+
+void log_deferred_stats_get(struct log_deferred_stats *stats)
+{
+	stats->logged = atomic_get(&log_logged);
+	stats->dropped = atomic_get(&log_dropped);
+	stats->output = atomic_get(&log_output);
+}
+
+static void log_fiber(int arg1, int arg2)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	while (1) {
+		nano_fiber_sem_take(&log_sem, LOG_PERIOD);
+
+		/* The buffer filling up wakes the fiber up again */
+		atomic_clear(&log_wakeup);
+
+		log_deferred_flush();
+	}
+}
+
+static int log_deferred_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	nano_sem_init(&log_sem);
+
+	fiber_start(log_stack, sizeof(log_stack), log_fiber, 0, 0,
+		    CONFIG_LOG_DEFERRED_FIBER_PRIORITY, 0);
+
+	return 0;
+}
+
+SYS_INIT(log_deferred_init, PRIMARY, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -24,9 +24,13 @@
 
 #include <misc/printk.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <toolchain.h>
 #include <sections.h>
 
+/* printk() may be a macro recording into the deferred log */
+#undef printk
+
 static void _printk_dec_ulong(const unsigned long num);
 static void _printk_hex_ulong(const unsigned long num);
 
@@ -61,16 +65,24 @@ void __printk_hook_install(int (*fn)(int))
 	_char_out = fn;
 }
 
+/*
+ * Arguments come either from a va_list, or from an array of raw words
+ * captured by the deferred logger
+ */
+#define _PRINTK_ARG(type) (argv ? (type)*argv++ : va_arg(*ap, type))
+
 /**
  * @brief Printk internals
  *
  * See printk() for description.
  * @param fmt Format string
- * @param ap Variable parameters
+ * @param ap Variable parameters, used if @a argv is NULL
+ * @param argv Parameters, one word each
  *
  * @return N/A
  */
-static inline void _vprintk(const char *fmt, va_list ap)
+static void _printk_fmt(const char *fmt, va_list *ap,
+			const unsigned long *argv)
 {
 	int might_format = 0; /* 1 if encountered a '%' */
 
@@ -92,7 +104,7 @@ static inline void _vprintk(const char *fmt, va_list ap)
 				goto still_might_format;
 			case 'd':
 			case 'i': {
-				long d = va_arg(ap, long);
+				long d = _PRINTK_ARG(long);
 
 				if (d < 0) {
 					_char_out((int)'-');
@@ -102,8 +114,8 @@ static inline void _vprintk(const char *fmt, va_list ap)
 				break;
 			}
 			case 'u': {
-				unsigned long u = va_arg(
-					ap, unsigned long);
+				unsigned long u = _PRINTK_ARG(unsigned long);
+
 				_printk_dec_ulong(u);
 				break;
 			}
@@ -113,20 +125,20 @@ static inline void _vprintk(const char *fmt, va_list ap)
 				  /* Fall through */
 			case 'x':
 			case 'X': {
-				unsigned long x = va_arg(
-					ap, unsigned long);
+				unsigned long x = _PRINTK_ARG(unsigned long);
+
 				_printk_hex_ulong(x);
 				break;
 			}
 			case 's': {
-				char *s = va_arg(ap, char *);
+				char *s = _PRINTK_ARG(char *);
 
 				while (*s)
 					_char_out((int)(*s++));
 				break;
 			}
 			case 'c': {
-				int c = va_arg(ap, int);
+				int c = _PRINTK_ARG(int);
 
 				_char_out(c);
 				break;
@@ -147,6 +159,21 @@ still_might_format:
 	}
 }
 
+#ifdef CONFIG_LOG_DEFERRED
+/**
+ * @brief Output a string with arguments captured by the deferred logger
+ *
+ * @param fmt Format string
+ * @param argv Arguments, one word each
+ *
+ * @return N/A
+ */
+void _printk_argv(const char *fmt, const unsigned long *argv)
+{
+	_printk_fmt(fmt, NULL, argv);
+}
+#endif
+
 /**
  * @brief Output a string
  *
@@ -170,7 +197,7 @@ void printk(const char *fmt, ...)
 	va_list ap;
 
 	va_start(ap, fmt);
-	_vprintk(fmt, ap);
+	_printk_fmt(fmt, &ap, NULL);
 	va_end(ap);
 }
 
@@ -62,6 +62,10 @@ typedef unsigned int uip_stats_t;
 #define UIP_CONF_RECEIVE_WINDOW CONFIG_TCP_RECEIVE_WINDOW
 #endif /* CONFIG_TCP_RECEIVE_WINDOW */
 
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+#define UIP_CONF_TCP_SEND_SEGMENTS CONFIG_TCP_SEND_SEGMENTS
+#endif /* CONFIG_TCP_SEND_SEGMENTS */
+
 #else
 #define UIP_CONF_TCP 0
 #endif
@@ -133,6 +137,12 @@ typedef unsigned int uip_stats_t;
 #endif
 #ifdef CONFIG_NETWORKING_WITH_15_4_MAC_CSMA
 #define NETSTACK_CONF_MAC	csma_driver
+#define CSMA_CONF_MAX_NEIGHBOR_QUEUES CONFIG_15_4_CSMA_NEIGHBOR_QUEUES
+#define CSMA_CONF_MAX_PACKET_PER_NEIGHBOR \
+	CONFIG_15_4_CSMA_PACKETS_PER_NEIGHBOR
+#ifdef CONFIG_15_4_CSMA_DROP_HEAD
+#define CSMA_CONF_DROP_HEAD 1
+#endif
 #endif
 #define LINKADDR_CONF_SIZE      8
 #define UIP_CONF_LL_802154	1
@@ -557,6 +557,19 @@ struct uip_conn *uip_connect(const uip_ipaddr_t *ripaddr, uint16_t port);
  */
 #define uip_outstanding(conn) ((conn)->len)
 
+#if UIP_TCP_SEND_SEGMENTS > 1
+/**
+ * \internal
+ *
+ * Check if a buffer holds a segment of a connection that is sent, or
+ * was to be sent, and not yet acknowledged. uIP retransmits it if needed.
+ *
+ * \param conn A pointer to the uip_conn structure for the connection.
+ * \param buf The buffer.
+ */
+int uip_tcp_is_unacked(struct uip_conn *conn, struct net_buf *buf);
+#endif
+
 /**
  * Send data on the current connection.
  *
@@ -1344,6 +1357,15 @@ struct uip_conn {
   /* buffer holding the data to this connection */
   struct net_buf *buf;
 
+#if UIP_TCP_SEND_SEGMENTS > 1
+  /* Segments sent after the one in buf and not yet acknowledged,
+     oldest first. */
+  struct net_buf *unacked[UIP_TCP_SEND_SEGMENTS - 1];
+  uint16_t unacked_len[UIP_TCP_SEND_SEGMENTS - 1];
+  uint8_t unacked_count;
+  uint16_t snd_wnd;      /**< The window advertised by the remote host. */
+#endif
+
 #if UIP_ACTIVE_OPEN
   /* re-send SYN in active open connection */
   struct ctimer retransmit_timer;
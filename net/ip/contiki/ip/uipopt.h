@@ -500,6 +500,22 @@ void uip_log(char *msg);
 #define UIP_RECEIVE_WINDOW (UIP_CONF_RECEIVE_WINDOW)
 #endif
 
+/**
+ * The number of data segments a connection can have unacknowledged.
+ *
+ * With one segment uIP waits for each segment to be acknowledged
+ * before sending the next one. More segments let the connection fill
+ * the window advertised by the remote host. Every unacknowledged
+ * segment holds on to its buffer so that it can be retransmitted.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_SEND_SEGMENTS
+#define UIP_TCP_SEND_SEGMENTS (UIP_CONF_TCP_SEND_SEGMENTS)
+#else
+#define UIP_TCP_SEND_SEGMENTS 1
+#endif
+
 /**
  * How long a connection should stay in the TIME_WAIT state.
  *
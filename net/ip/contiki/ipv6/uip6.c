@@ -95,6 +95,7 @@ void net_context_set_internal_connection(struct net_context *context,
 struct net_context *net_context_find_internal_connection(void *conn);
 void net_context_tcp_set_pending(struct net_context *context,
 				 struct net_buf *buf);
+void net_tcp_window_open(struct net_context *context);
 
 /*---------------------------------------------------------------------------*/
 /* For Debug, logging, statistics                                            */
@@ -451,6 +452,125 @@ uip_udpchksum(struct net_buf *buf)
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
 #endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
+#if UIP_TCP && UIP_TCP_SEND_SEGMENTS > 1
+/*
+ * The oldest unacknowledged segment is kept in conn->buf and its length
+ * in conn->len like with a single segment. The segments sent after it
+ * are kept in conn->unacked. The sequence number of a queued segment is
+ * snd_nxt + len + the length of the segments queued before it.
+ */
+static uint16_t
+tcp_unacked_len(struct uip_conn *conn)
+{
+  uint16_t len = 0;
+  uint8_t i;
+
+  for(i = 0; i < conn->unacked_count; i++) {
+    len += conn->unacked_len[i];
+  }
+  return len;
+}
+
+int
+uip_tcp_is_unacked(struct uip_conn *conn, struct net_buf *buf)
+{
+  uint8_t i;
+
+  if(buf == conn->buf) {
+    return 1;
+  }
+  for(i = 0; i < conn->unacked_count; i++) {
+    if(buf == conn->unacked[i]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int
+tcp_can_queue(struct uip_conn *conn, struct net_buf *buf)
+{
+  if((conn->tcpstateflags & UIP_TS_MASK) != UIP_ESTABLISHED ||
+     !conn->buf || conn->unacked_count == UIP_TCP_SEND_SEGMENTS - 1) {
+    return 0;
+  }
+  return (uint32_t)conn->len + tcp_unacked_len(conn) + uip_slen(buf) <=
+    conn->snd_wnd;
+}
+
+/* Returns the offset of the segment from snd_nxt */
+static uint16_t
+tcp_queue(struct uip_conn *conn, struct net_buf *buf)
+{
+  uint16_t offset = conn->len + tcp_unacked_len(conn);
+
+  conn->unacked[conn->unacked_count] = ip_buf_ref(buf);
+  conn->unacked_len[conn->unacked_count] = uip_slen(buf);
+  conn->unacked_count++;
+  return offset;
+}
+
+static void
+tcp_unacked_remove(struct uip_conn *conn, uint8_t count)
+{
+  uint8_t i;
+
+  for(i = 0; i < count; i++) {
+    ip_buf_unref(conn->unacked[i]);
+  }
+  conn->unacked_count -= count;
+  memmove(conn->unacked, conn->unacked + count,
+          conn->unacked_count * sizeof(conn->unacked[0]));
+  memmove(conn->unacked_len, conn->unacked_len + count,
+          conn->unacked_count * sizeof(conn->unacked_len[0]));
+}
+
+static void
+tcp_unacked_flush(struct uip_conn *conn)
+{
+  tcp_unacked_remove(conn, conn->unacked_count);
+}
+
+/*
+ * If the ACK in buf covers queued segments, release them and add their
+ * length to conn->len so that the ACK is handled as if it acknowledged
+ * the oldest segment only.
+ */
+static void
+tcp_ack_unacked(struct uip_conn *conn, struct net_buf *buf)
+{
+  uint16_t len = conn->len;
+  uint8_t i;
+
+  for(i = 0; i < conn->unacked_count; i++) {
+    len += conn->unacked_len[i];
+    uip_add32(conn->snd_nxt, len);
+    if(memcmp(UIP_TCP_BUF(buf)->ackno, uip_acc32, 4) == 0) {
+      tcp_unacked_remove(conn, i + 1);
+      conn->len = len;
+      return;
+    }
+  }
+}
+
+/* The oldest segment was acknowledged, the next one takes its place */
+static void
+tcp_unacked_next(struct uip_conn *conn)
+{
+  ip_buf_unref(conn->buf);
+  conn->buf = NULL;
+
+  if(conn->unacked_count == 0) {
+    return;
+  }
+
+  conn->buf = ip_buf_ref(conn->unacked[0]);
+  conn->len = conn->unacked_len[0];
+  conn->nrtx = 0;
+  tcp_unacked_remove(conn, 1);
+}
+#endif /* UIP_TCP && UIP_TCP_SEND_SEGMENTS > 1 */
+/*---------------------------------------------------------------------------*/
 void
 uip_init(void)
 {
@@ -539,6 +659,10 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
   }
   
   conn->tcpstateflags = UIP_SYN_SENT;
+#if UIP_TCP_SEND_SEGMENTS > 1
+  tcp_unacked_flush(conn);
+  conn->snd_wnd = 0;
+#endif
 
   conn->snd_nxt[0] = iss[0];
   conn->snd_nxt[1] = iss[1];
@@ -1017,6 +1141,9 @@ uip_process(struct net_buf **buf_out, uint8_t flag)
 #if UIP_TCP
   register struct uip_conn *uip_connr = uip_conn(buf);
   uint8_t c;
+#if UIP_TCP_SEND_SEGMENTS > 1
+  uint16_t seq_offset = 0;
+#endif
 #endif /* UIP_TCP */
 #if UIP_UDP
   int i;
@@ -1086,7 +1213,34 @@ uip_process(struct net_buf **buf_out, uint8_t flag)
       }
 
       if (uip_outstanding(uip_connr)) {
+#if UIP_TCP_SEND_SEGMENTS > 1
+        if(uip_tcp_is_unacked(uip_connr, buf)) {
+          /* Already sent, waiting for the ACK */
+          ip_buf_sent_status(buf) = 0;
+          return 0;
+        }
+
+        if(uip_slen(buf) > uip_connr->mss) {
+          uip_slen(buf) = uip_connr->mss;
+        }
+
+        if(tcp_can_queue(uip_connr, buf)) {
+          seq_offset = tcp_queue(uip_connr, buf);
+          ip_buf_sent_status(buf) = 0;
+          PRINTF("Queued packet len %d at offset %d, %d segments "
+                 "unacked, conn %p\n", uip_slen(buf), seq_offset,
+                 uip_connr->unacked_count + 1, uip_connr);
+          uip_appdata(buf) = uip_sappdata(buf);
+          uip_len(buf) = uip_slen(buf) + UIP_TCPIP_HLEN;
+          UIP_TCP_BUF(buf)->flags = TCP_ACK | TCP_PSH;
+          goto tcp_send_noopts;
+        }
+        /* No room in the send window. A failed output of a queued
+           segment is -EAGAIN, uIP retransmits that one itself. */
+        ip_buf_sent_status(buf) = -ENOSPC;
+#else
         ip_buf_sent_status(buf) = -EAGAIN;
+#endif
         PRINTF("Retry to send packet len %d, outstanding data len %d, "
 	       "conn %p\n", uip_len(buf), uip_outstanding(uip_connr),
 		uip_connr);
@@ -1147,6 +1301,9 @@ uip_process(struct net_buf **buf_out, uint8_t flag)
                uip_connr->tcpstateflags == UIP_SYN_RCVD) &&
               uip_connr->nrtx == UIP_MAXSYNRTX)) {
             uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_SEND_SEGMENTS > 1
+            tcp_unacked_flush(uip_connr);
+#endif
             /*
              * We call UIP_APPCALL() with uip_flags set to
              * UIP_TIMEDOUT to inform the application that the
@@ -1901,6 +2058,10 @@ uip_process(struct net_buf **buf_out, uint8_t flag)
   uip_connr->rport = UIP_TCP_BUF(buf)->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF(buf)->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
+#if UIP_TCP_SEND_SEGMENTS > 1
+  tcp_unacked_flush(uip_connr);
+  uip_connr->snd_wnd = 0;
+#endif
 
   uip_connr->snd_nxt[0] = iss[0];
   uip_connr->snd_nxt[1] = iss[1];
@@ -2043,6 +2204,9 @@ tcp_send_syn:
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
   if((UIP_TCP_BUF(buf)->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
+#if UIP_TCP_SEND_SEGMENTS > 1
+    tcp_ack_unacked(uip_connr, buf);
+#endif
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
     if(UIP_TCP_BUF(buf)->ackno[0] == uip_acc32[0] &&
@@ -2081,6 +2245,14 @@ tcp_send_syn:
     
   }
 
+#if UIP_TCP_SEND_SEGMENTS > 1
+  /* Remember how much the remote host is willing to receive */
+  if(UIP_TCP_BUF(buf)->flags & TCP_ACK) {
+    uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF(buf)->wnd[0] << 8) +
+      UIP_TCP_BUF(buf)->wnd[1];
+  }
+#endif
+
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
     /* CLOSED and LISTEN are not handled here. CLOSE_WAIT is not
@@ -2305,6 +2477,26 @@ tcp_send_syn:
         }
 
 	if (uip_connr->buf) {
+#if UIP_TCP_SEND_SEGMENTS > 1
+	  struct net_context *context = ip_buf_context(uip_connr->buf);
+
+          net_context_set_internal_connection(context, uip_connr);
+
+	  if (uip_flags(buf) & UIP_ACKDATA) {
+	    /* The buffers are released here and not by net_send() as
+	     * the next queued segment becomes the pending one.
+	     */
+	    tcp_unacked_next(uip_connr);
+	    if (!uip_connr->buf) {
+	      tcp_cancel_retrans_timer(uip_connr);
+	    }
+
+	    net_context_set_connection_status(context, 0);
+
+	    /* There is room in the window for data waiting to be sent */
+	    net_tcp_window_open(context);
+	  }
+#else
 	  net_context_tcp_set_pending(ip_buf_context(uip_connr->buf), NULL);
           net_context_set_internal_connection(ip_buf_context(uip_connr->buf),
 					      uip_connr);
@@ -2322,7 +2514,7 @@ tcp_send_syn:
 	   */
 
 	  tcp_cancel_retrans_timer(uip_connr);
-
+#endif
 	} else {
 	  /* We have no pending data so this will cause ACK to be sent to
 	   * peer in few lines below.
@@ -2337,12 +2529,18 @@ tcp_send_syn:
         if(uip_flags(buf) & UIP_ABORT) {
           uip_slen(buf) = 0;
           uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_SEND_SEGMENTS > 1
+          tcp_unacked_flush(uip_connr);
+#endif
           UIP_TCP_BUF(buf)->flags = TCP_RST | TCP_ACK;
           goto tcp_send_nodata;
         }
 
         if(uip_flags(buf) & UIP_CLOSE) {
           uip_slen(buf) = 0;
+#if UIP_TCP_SEND_SEGMENTS > 1
+          tcp_unacked_flush(uip_connr);
+#endif
           uip_connr->len = 1;
           uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
           uip_connr->nrtx = 0;
@@ -2382,6 +2580,13 @@ tcp_send_syn:
 	      if (uip_connr->buf != buf) {
 	        PRINTF("Data packet %p already pending....\n",
 		       uip_connr->buf);
+#if UIP_TCP_SEND_SEGMENTS > 1
+	        /* Nothing is outstanding so the old buffer is not
+	         * needed for retransmissions any more.
+	         */
+	        ip_buf_unref(uip_connr->buf);
+	        uip_connr->buf = ip_buf_ref(buf);
+#endif
 	      }
 	    } else {
 	      uip_connr->buf = ip_buf_ref(buf);
@@ -2518,6 +2723,13 @@ tcp_send_syn:
   UIP_TCP_BUF(buf)->seqno[2] = uip_connr->snd_nxt[2];
   UIP_TCP_BUF(buf)->seqno[3] = uip_connr->snd_nxt[3];
 
+#if UIP_TCP_SEND_SEGMENTS > 1
+  if(seq_offset > 0) {
+    uip_add32(uip_connr->snd_nxt, seq_offset);
+    memcpy(UIP_TCP_BUF(buf)->seqno, uip_acc32, 4);
+  }
+#endif
+
   UIP_TCP_BUF(buf)->srcport  = uip_connr->lport;
   UIP_TCP_BUF(buf)->destport = uip_connr->rport;
 
@@ -2588,6 +2800,12 @@ tcp_send_syn:
       uip_connr->buf = NULL;
     }
   }
+#if UIP_TCP_SEND_SEGMENTS > 1
+  if (uip_connr &&
+      (uip_connr->tcpstateflags & UIP_TS_MASK) != UIP_ESTABLISHED) {
+    tcp_unacked_flush(uip_connr);
+  }
+#endif
 #endif
 
   return 0;
@@ -103,9 +103,18 @@ void uip_log(char *msg);
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
+  /* The buffer the packet was queued from. The caller holds a
+     reference to it until the sent callback is called. */
+  struct net_buf *owner;
   uint8_t max_transmissions;
 };
 
+/* A queue entry and its metadata are allocated from the same pool */
+struct qbuf_entry {
+  struct rdc_buf_list list;
+  struct qbuf_metadata metadata;
+};
+
 /* Every neighbor has its own packet queue */
 struct neighbor_queue {
   struct neighbor_queue *next;
@@ -130,10 +139,18 @@ struct neighbor_queue {
 #define CSMA_MAX_PACKET_PER_NEIGHBOR MAX_QUEUED_PACKETS
 #endif /* CSMA_CONF_MAX_PACKET_PER_NEIGHBOR */
 
+/* Drop the oldest packet instead of the new one when a queue is full */
+#ifdef CSMA_CONF_DROP_HEAD
+#define CSMA_DROP_HEAD CSMA_CONF_DROP_HEAD
+#else
+#define CSMA_DROP_HEAD 0
+#endif /* CSMA_CONF_DROP_HEAD */
+
 #define MAX_QUEUED_PACKETS QUEUEBUF_NUM
 MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
-MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
-MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
+MEMB(packet_memb, struct qbuf_entry, MAX_QUEUED_PACKETS);
+
+static struct csma_stats stats;
 
 static void packet_sent(struct net_buf *buf, void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(struct net_buf *buf, void *ptr);
@@ -177,7 +194,6 @@ free_packet(struct net_buf *buf, struct neighbor_queue *n, struct rdc_buf_list *
     list_remove(n->queued_packet_list, p);
 
     queuebuf_free(p->buf);
-    memb_free(&metadata_memb, p->ptr);
     memb_free(&packet_memb, p);
     PRINTF("csma: free_queued_packet, queue length %d, free packets %d\n",
            list_length(n->queued_packet_list), memb_numfree(&packet_memb));
@@ -306,6 +322,7 @@ packet_sent(struct net_buf *buf, void *ptr, int status, int num_transmissions)
         } else {
           PRINTF("csma: drop with status %d after %d transmissions, %d collisions\n",
                  status, n->transmissions, n->collisions);
+          stats.retx_drops++;
           free_packet(buf, n, q);
           mac_call_sent_callback(buf, sent, cptr, status, num_tx);
         }
@@ -326,10 +343,47 @@ packet_sent(struct net_buf *buf, void *ptr, int status, int num_transmissions)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_DROP_HEAD
+static int
+drop_head(struct neighbor_queue *n)
+{
+  struct rdc_buf_list *q = list_head(n->queued_packet_list);
+  struct qbuf_metadata *metadata;
+  struct net_buf *owner;
+  mac_callback_t sent;
+  void *cptr;
+
+  /* The head of the queue is being transmitted if it has been tried
+     already, leave it alone and drop the one after it. */
+  if(q != NULL && (n->transmissions || n->collisions || n->deferrals)) {
+    q = list_item_next(q);
+  }
+  if(q == NULL) {
+    return 0;
+  }
+
+  /* The metadata lives in the queue entry, which is freed below */
+  metadata = (struct qbuf_metadata *)q->ptr;
+  owner = metadata->owner;
+  sent = metadata->sent;
+  cptr = metadata->cptr;
+
+  list_remove(n->queued_packet_list, q);
+  queuebuf_free(q->buf);
+  memb_free(&packet_memb, q);
+  stats.head_drops++;
+
+  PRINTF("csma: queue full, dropped oldest packet\n");
+  mac_call_sent_callback(owner, sent, cptr, MAC_TX_ERR, 0);
+  return 1;
+}
+#endif /* CSMA_DROP_HEAD */
+/*---------------------------------------------------------------------------*/
 static uint8_t
 send_packet(struct net_buf *buf, mac_callback_t sent, bool last_fragment, void *ptr)
 {
   struct rdc_buf_list *q;
+  struct qbuf_entry *e;
   struct neighbor_queue *n;
   static uint8_t initialized = 0;
   static uint16_t seqno;
@@ -372,48 +426,55 @@ send_packet(struct net_buf *buf, mac_callback_t sent, bool last_fragment, void *
   }
 
   if(n != NULL) {
+#if CSMA_DROP_HEAD
+    if(list_length(n->queued_packet_list) >= CSMA_MAX_PACKET_PER_NEIGHBOR) {
+      /* The sent callback of the dropped packet can do anything,
+         including sending, so the queue is checked again below. */
+      drop_head(n);
+    }
+#endif /* CSMA_DROP_HEAD */
     /* Add packet to the neighbor's queue */
     if(list_length(n->queued_packet_list) < CSMA_MAX_PACKET_PER_NEIGHBOR) {
-      q = memb_alloc(&packet_memb);
-      if(q != NULL) {
-        q->ptr = memb_alloc(&metadata_memb);
-        if(q->ptr != NULL) {
-          q->buf = queuebuf_new_from_packetbuf(buf);
-          if(q->buf != NULL) {
-            struct qbuf_metadata *metadata = (struct qbuf_metadata *)q->ptr;
-            /* Neighbor and packet successfully allocated */
-            if(packetbuf_attr(buf, PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS) == 0) {
-              /* Use default configuration for max transmissions */
-              metadata->max_transmissions = CSMA_MAX_MAC_TRANSMISSIONS;
-            } else {
-              metadata->max_transmissions =
-                packetbuf_attr(buf, PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
-            }
-            metadata->sent = sent;
-            metadata->cptr = ptr;
-
-            if(packetbuf_attr(buf, PACKETBUF_ATTR_PACKET_TYPE) ==
-               PACKETBUF_ATTR_PACKET_TYPE_ACK) {
-              list_push(n->queued_packet_list, q);
-            } else {
-              list_add(n->queued_packet_list, q);
-            }
-
-            PRINTF("csma: send_packet, queue length %d, free packets %d\n",
-                   list_length(n->queued_packet_list), memb_numfree(&packet_memb));
-            /* if received packet is last fragment/only one packet start sending
-             * packets in list, do not start any timer.*/
-            if (last_fragment) {
-               transmit_packet_list(buf, n);
-            }
-            return 1;
+      e = memb_alloc(&packet_memb);
+      if(e != NULL) {
+        q = &e->list;
+        q->ptr = &e->metadata;
+        q->buf = queuebuf_new_from_packetbuf(buf);
+        if(q->buf != NULL) {
+          struct qbuf_metadata *metadata = (struct qbuf_metadata *)q->ptr;
+          /* Neighbor and packet successfully allocated */
+          if(packetbuf_attr(buf, PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS) == 0) {
+            /* Use default configuration for max transmissions */
+            metadata->max_transmissions = CSMA_MAX_MAC_TRANSMISSIONS;
+          } else {
+            metadata->max_transmissions =
+              packetbuf_attr(buf, PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+          }
+          metadata->sent = sent;
+          metadata->cptr = ptr;
+          metadata->owner = buf;
+
+          if(packetbuf_attr(buf, PACKETBUF_ATTR_PACKET_TYPE) ==
+             PACKETBUF_ATTR_PACKET_TYPE_ACK) {
+            list_push(n->queued_packet_list, q);
+          } else {
+            list_add(n->queued_packet_list, q);
+          }
+          stats.queued++;
+
+          PRINTF("csma: send_packet, queue length %d, free packets %d\n",
+                 list_length(n->queued_packet_list), memb_numfree(&packet_memb));
+          /* if received packet is last fragment/only one packet start sending
+           * packets in list, do not start any timer.*/
+          if (last_fragment) {
+             transmit_packet_list(buf, n);
           }
-          memb_free(&metadata_memb, q->ptr);
-          PRINTF("csma: could not allocate queuebuf, dropping packet\n");
+          return 1;
         }
-        memb_free(&packet_memb, q);
+        memb_free(&packet_memb, e);
         PRINTF("csma: could not allocate queuebuf, dropping packet\n");
       }
+      stats.no_buffer_drops++;
       /* The packet allocation failed. Remove and free neighbor entry if empty. */
       if(list_length(n->queued_packet_list) == 0) {
         list_remove(uip_neighbor_list(buf), n);
@@ -421,10 +482,12 @@ send_packet(struct net_buf *buf, mac_callback_t sent, bool last_fragment, void *
       }
     } else {
       PRINTF("csma: Neighbor queue full\n");
+      stats.tail_drops++;
     }
     PRINTF("csma: could not allocate packet, dropping packet\n");
   } else {
     PRINTF("csma: could not allocate neighbor, dropping packet\n");
+    stats.no_buffer_drops++;
   }
   mac_call_sent_callback(buf, sent, ptr, MAC_TX_ERR, 1);
   return 0;
@@ -463,10 +526,15 @@ init(void)
   queuebuf_init();
 
   memb_init(&packet_memb);
-  memb_init(&metadata_memb);
   memb_init(&neighbor_memb);
 }
 /*---------------------------------------------------------------------------*/
+const struct csma_stats *
+csma_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
 const struct mac_driver csma_driver = {
   "CSMA",
   init,
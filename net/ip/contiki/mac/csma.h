@@ -46,6 +46,17 @@
 
 extern const struct mac_driver csma_driver;
 
+/* Queueing statistics of the CSMA layer */
+struct csma_stats {
+  uint32_t queued;          /* packets added to a neighbor queue */
+  uint32_t tail_drops;      /* new packets dropped, queue full */
+  uint32_t head_drops;      /* old packets dropped to make room */
+  uint32_t no_buffer_drops; /* out of neighbor, entry or queuebuf */
+  uint32_t retx_drops;      /* dropped after max retransmissions */
+};
+
+const struct csma_stats *csma_get_stats(void);
+
 const struct mac_driver *csma_init(const struct mac_driver *r);
 
 #endif /* CSMA_H_ */
@@ -25,6 +25,7 @@
 #include <toolchain.h>
 #include <string.h>
 #include <stdint.h>
+#include <errno.h>
 
 #include <net/net_core.h>
 #include <net/buf.h>
@@ -141,18 +142,144 @@ static inline int get_frees(enum ip_buf_type type)
 static struct nano_fifo free_rx_bufs;
 static struct nano_fifo free_tx_bufs;
 
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+extern struct ip_buf_quota *net_context_get_quota(struct net_context *context);
+
+static const uint8_t quota_limit[] = {
+	[IP_BUF_RX] = CONFIG_IP_BUF_CONTEXT_RX_QUOTA,
+	[IP_BUF_TX] = CONFIG_IP_BUF_CONTEXT_TX_QUOTA,
+};
+
+/* Buffers sitting in the free queues. Buffers taken directly from the
+ * queues with net_buf_clone() are only accounted once charged to a
+ * context with ip_buf_charge_rx().
+ */
+static uint8_t num_free[] = {
+	[IP_BUF_RX] = IP_BUF_RX_SIZE,
+	[IP_BUF_TX] = IP_BUF_TX_SIZE,
+};
+
+/* TX buffers reserved by contexts that are not in use yet, the
+ * free queue never gets shorter than this for anybody else.
+ */
+static uint8_t tx_reserved_free;
+static uint8_t tx_reserved_total;
+
+/* Given every time a TX buffer is released, to wake up senders */
+static struct nano_sem tx_released;
+
+/* Accounting state of each buffer, kept out of the user data as the
+ * stack copies that around between buffers.
+ */
+struct buf_account {
+	struct net_context *owner;
+	bool taken;
+};
+
+static struct buf_account rx_accounts[IP_BUF_RX_SIZE];
+static struct buf_account tx_accounts[IP_BUF_TX_SIZE];
+
+static struct buf_account *buf_account(struct net_buf *buf,
+				       enum ip_buf_type type);
+
+static uint8_t quota_max(struct ip_buf_quota *quota, enum ip_buf_type type)
+{
+	if (type == IP_BUF_TX && quota->tx_reserved > quota_limit[type]) {
+		return quota->tx_reserved;
+	}
+
+	return quota_limit[type];
+}
+
+/* Must be called with interrupts locked */
+static bool quota_take(struct net_context *context, enum ip_buf_type type)
+{
+	struct ip_buf_quota *quota = net_context_get_quota(context);
+
+	if (quota) {
+		if (quota->used[type] >= quota_max(quota, type)) {
+			return false;
+		}
+
+		if (type == IP_BUF_TX &&
+		    quota->used[type] < quota->tx_reserved) {
+			tx_reserved_free--;
+			goto take;
+		}
+	}
+
+	if (num_free[type] <= (type == IP_BUF_TX ? tx_reserved_free : 0)) {
+		return false;
+	}
+
+take:
+	if (quota) {
+		quota->used[type]++;
+	}
+
+	num_free[type]--;
+
+	return true;
+}
+
+/* Must be called with interrupts locked */
+static void quota_give(struct net_context *context, enum ip_buf_type type)
+{
+	struct ip_buf_quota *quota = net_context_get_quota(context);
+
+	if (quota) {
+		quota->used[type]--;
+
+		if (type == IP_BUF_TX &&
+		    quota->used[type] < quota->tx_reserved) {
+			tx_reserved_free++;
+		}
+	}
+
+	num_free[type]++;
+}
+
+static inline void put_free_buf(struct net_buf *buf, enum ip_buf_type type)
+{
+	struct buf_account *account = buf_account(buf, type);
+	struct net_context *owner = account->owner;
+	bool taken = account->taken;
+	unsigned int key;
+
+	account->owner = NULL;
+	account->taken = false;
+
+	nano_fifo_put(buf->free, buf);
+
+	if (!taken) {
+		return;
+	}
+
+	/* Only account the buffer once it can really be taken */
+	key = irq_lock();
+	quota_give(owner, type);
+	irq_unlock(key);
+
+	if (type == IP_BUF_TX) {
+		nano_sem_give(&tx_released);
+	}
+}
+#else
+#define put_free_buf(buf, type) nano_fifo_put(buf->free, buf)
+#endif
+
 static inline void free_rx_bufs_func(struct net_buf *buf)
 {
 	inc_free_rx_bufs_func(buf);
 
-	nano_fifo_put(buf->free, buf);
+	put_free_buf(buf, IP_BUF_RX);
 }
 
 static inline void free_tx_bufs_func(struct net_buf *buf)
 {
 	inc_free_tx_bufs_func(buf);
 
-	nano_fifo_put(buf->free, buf);
+	put_free_buf(buf, IP_BUF_TX);
 }
 
 static NET_BUF_POOL(rx_buffers, IP_BUF_RX_SIZE, IP_BUF_MAX_DATA, \
@@ -162,6 +289,23 @@ static NET_BUF_POOL(tx_buffers, IP_BUF_TX_SIZE, IP_BUF_MAX_DATA, \
 		    &free_tx_bufs, free_tx_bufs_func, \
 		    sizeof(struct ip_buf));
 
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+static struct buf_account *buf_account(struct net_buf *buf,
+				       enum ip_buf_type type)
+{
+	switch (type) {
+	case IP_BUF_RX:
+		return &rx_accounts[((uint8_t *)buf - (uint8_t *)rx_buffers) /
+				    sizeof(rx_buffers[0])];
+	case IP_BUF_TX:
+		return &tx_accounts[((uint8_t *)buf - (uint8_t *)tx_buffers) /
+				    sizeof(tx_buffers[0])];
+	}
+
+	return NULL;
+}
+#endif
+
 static inline const char *type2str(enum ip_buf_type type)
 {
 	switch (type) {
@@ -174,14 +318,102 @@ static inline const char *type2str(enum ip_buf_type type)
 	return NULL;
 }
 
+static inline struct nano_fifo *free_bufs(enum ip_buf_type type)
+{
+	switch (type) {
+	case IP_BUF_RX:
+		return &free_rx_bufs;
+	case IP_BUF_TX:
+		return &free_tx_bufs;
+	}
+
+	return NULL;
+}
+
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+static struct net_buf *alloc_buf(enum ip_buf_type type,
+				 struct net_context *context,
+				 int32_t timeout)
+{
+	struct ip_buf_quota *quota = net_context_get_quota(context);
+	uint32_t start = sys_tick_get_32();
+	struct net_buf *buf;
+	unsigned int key;
+	int32_t remaining;
+	bool taken;
+
+	while (1) {
+		key = irq_lock();
+		taken = quota_take(context, type);
+		irq_unlock(key);
+
+		if (taken) {
+			buf = net_buf_get_timeout(free_bufs(type), 0,
+						  TICKS_NONE);
+			if (buf) {
+				buf_account(buf, type)->owner = context;
+				buf_account(buf, type)->taken = true;
+				return buf;
+			}
+
+			key = irq_lock();
+			quota_give(context, type);
+			irq_unlock(key);
+		}
+
+		/* Only senders are slowed down, received data is dropped */
+		if (type != IP_BUF_TX || timeout == TICKS_NONE ||
+		    sys_execution_context_type_get() == NANO_CTX_ISR) {
+			break;
+		}
+
+		if (timeout == TICKS_UNLIMITED) {
+			remaining = TICKS_UNLIMITED;
+		} else {
+			remaining = timeout -
+				(int32_t)(sys_tick_get_32() - start);
+			if (remaining <= 0) {
+				break;
+			}
+		}
+
+		if (!nano_sem_take(&tx_released, remaining)) {
+			break;
+		}
+	}
+
+	if (quota) {
+		quota->alloc_failures[type]++;
+	}
+
+	return NULL;
+}
+#else
+static struct net_buf *alloc_buf(enum ip_buf_type type,
+				 struct net_context *context,
+				 int32_t timeout)
+{
+	if (timeout == TICKS_UNLIMITED) {
+		/* Does not wait when called from ISR */
+		return net_buf_get(free_bufs(type), 0);
+	}
+
+	return net_buf_get_timeout(free_bufs(type), 0, timeout);
+}
+#endif
+
 #ifdef DEBUG_IP_BUFS
 static struct net_buf *ip_buf_get_reserve_debug(enum ip_buf_type type,
+						struct net_context *context,
 						uint16_t reserve_head,
+						int32_t timeout,
 						const char *caller,
 						int line)
 #else
 static struct net_buf *ip_buf_get_reserve(enum ip_buf_type type,
-					  uint16_t reserve_head)
+					  struct net_context *context,
+					  uint16_t reserve_head,
+					  int32_t timeout)
 #endif
 {
 	struct net_buf *buf = NULL;
@@ -196,13 +428,13 @@ static struct net_buf *ip_buf_get_reserve(enum ip_buf_type type,
 	 * That variable is only used to calculate the pointer
 	 * where the application data starts.
 	 */
+	buf = alloc_buf(type, context, timeout);
+
 	switch (type) {
 	case IP_BUF_RX:
-		buf = net_buf_get(&free_rx_bufs, 0);
 		dec_free_rx_bufs(buf);
 		break;
 	case IP_BUF_TX:
-		buf = net_buf_get(&free_tx_bufs, 0);
 		dec_free_tx_bufs(buf);
 		break;
 	}
@@ -243,10 +475,11 @@ struct net_buf *ip_buf_get_reserve_rx(uint16_t reserve_head)
 #endif
 {
 #ifdef DEBUG_IP_BUFS
-	return ip_buf_get_reserve_debug(IP_BUF_RX, reserve_head,
-					caller, line);
+	return ip_buf_get_reserve_debug(IP_BUF_RX, NULL, reserve_head,
+					TICKS_UNLIMITED, caller, line);
 #else
-	return ip_buf_get_reserve(IP_BUF_RX, reserve_head);
+	return ip_buf_get_reserve(IP_BUF_RX, NULL, reserve_head,
+				  TICKS_UNLIMITED);
 #endif
 }
 
@@ -257,20 +490,23 @@ struct net_buf *ip_buf_get_reserve_tx(uint16_t reserve_head)
 #endif
 {
 #ifdef DEBUG_IP_BUFS
-	return ip_buf_get_reserve_debug(IP_BUF_TX, reserve_head,
-					caller, line);
+	return ip_buf_get_reserve_debug(IP_BUF_TX, NULL, reserve_head,
+					TICKS_UNLIMITED, caller, line);
 #else
-	return ip_buf_get_reserve(IP_BUF_TX, reserve_head);
+	return ip_buf_get_reserve(IP_BUF_TX, NULL, reserve_head,
+				  TICKS_UNLIMITED);
 #endif
 }
 
 #ifdef DEBUG_IP_BUFS
 static struct net_buf *ip_buf_get_debug(enum ip_buf_type type,
 					struct net_context *context,
+					int32_t timeout,
 					const char *caller, int line)
 #else
 static struct net_buf *ip_buf_get(enum ip_buf_type type,
-				  struct net_context *context)
+				  struct net_context *context,
+				  int32_t timeout)
 #endif
 {
 	struct net_buf *buf;
@@ -295,9 +531,10 @@ static struct net_buf *ip_buf_get(enum ip_buf_type type,
 	}
 
 #ifdef DEBUG_IP_BUFS
-	buf = ip_buf_get_reserve_debug(type, reserve, caller, line);
+	buf = ip_buf_get_reserve_debug(type, context, reserve, timeout,
+				       caller, line);
 #else
-	buf = ip_buf_get_reserve(type, reserve);
+	buf = ip_buf_get_reserve(type, context, reserve, timeout);
 #endif
 	if (!buf) {
 		return buf;
@@ -317,9 +554,10 @@ struct net_buf *ip_buf_get_rx(struct net_context *context)
 #endif
 {
 #ifdef DEBUG_IP_BUFS
-	return ip_buf_get_debug(IP_BUF_RX, context, caller, line);
+	return ip_buf_get_debug(IP_BUF_RX, context, TICKS_UNLIMITED,
+				caller, line);
 #else
-	return ip_buf_get(IP_BUF_RX, context);
+	return ip_buf_get(IP_BUF_RX, context, TICKS_UNLIMITED);
 #endif
 }
 
@@ -331,12 +569,112 @@ struct net_buf *ip_buf_get_tx(struct net_context *context)
 #endif
 {
 #ifdef DEBUG_IP_BUFS
-	return ip_buf_get_debug(IP_BUF_TX, context, caller, line);
+	return ip_buf_get_debug(IP_BUF_TX, context, TICKS_UNLIMITED,
+				caller, line);
+#else
+	return ip_buf_get(IP_BUF_TX, context, TICKS_UNLIMITED);
+#endif
+}
+
+#ifdef DEBUG_IP_BUFS
+struct net_buf *ip_buf_get_tx_timeout_debug(struct net_context *context,
+					    int32_t timeout,
+					    const char *caller, int line)
+#else
+struct net_buf *ip_buf_get_tx_timeout(struct net_context *context,
+				      int32_t timeout)
+#endif
+{
+#ifdef DEBUG_IP_BUFS
+	return ip_buf_get_debug(IP_BUF_TX, context, timeout, caller, line);
 #else
-	return ip_buf_get(IP_BUF_TX, context);
+	return ip_buf_get(IP_BUF_TX, context, timeout);
 #endif
 }
 
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+int ip_buf_reserve_tx(struct net_context *context, uint8_t count)
+{
+	struct ip_buf_quota *quota = net_context_get_quota(context);
+	unsigned int key;
+	uint8_t unused, new_unused;
+
+	if (!quota) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (tx_reserved_total - quota->tx_reserved + count > IP_BUF_TX_SIZE) {
+		irq_unlock(key);
+		return -ENOMEM;
+	}
+
+	unused = quota->tx_reserved > quota->used[IP_BUF_TX] ?
+		quota->tx_reserved - quota->used[IP_BUF_TX] : 0;
+	new_unused = count > quota->used[IP_BUF_TX] ?
+		count - quota->used[IP_BUF_TX] : 0;
+
+	/* The reserved buffers must be free right now */
+	if (new_unused > unused &&
+	    num_free[IP_BUF_TX] < tx_reserved_free + new_unused - unused) {
+		irq_unlock(key);
+		return -ENOMEM;
+	}
+
+	tx_reserved_total = tx_reserved_total - quota->tx_reserved + count;
+	tx_reserved_free = tx_reserved_free - unused + new_unused;
+	quota->tx_reserved = count;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+bool ip_buf_charge_rx(struct net_context *context, struct net_buf *buf,
+		      bool acked)
+{
+	struct ip_buf_quota *quota = net_context_get_quota(context);
+	struct buf_account *account = buf_account(buf, IP_BUF_RX);
+	unsigned int key;
+
+	if (!quota || account->owner) {
+		return true;
+	}
+
+	key = irq_lock();
+
+	if (!acked && quota->used[IP_BUF_RX] >= quota_limit[IP_BUF_RX]) {
+		quota->alloc_failures[IP_BUF_RX]++;
+		irq_unlock(key);
+
+		NET_DBG("context %p over RX quota, buf %p dropped\n",
+			context, buf);
+		return false;
+	}
+
+	/* A clone was taken straight from the free queue, account it now
+	 * so that it is given back when released.
+	 */
+	if (!account->taken) {
+		account->taken = true;
+		num_free[IP_BUF_RX]--;
+	}
+
+	quota->used[IP_BUF_RX]++;
+	account->owner = context;
+
+	irq_unlock(key);
+
+	return true;
+}
+
+const struct ip_buf_quota *ip_buf_get_quota(struct net_context *context)
+{
+	return net_context_get_quota(context);
+}
+#endif
+
 #ifdef DEBUG_IP_BUFS
 void ip_buf_unref_debug(struct net_buf *buf, const char *caller, int line)
 #else
@@ -408,4 +746,8 @@ void ip_buf_init(void)
 
 	net_buf_pool_init(rx_buffers);
 	net_buf_pool_init(tx_buffers);
+
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+	nano_sem_init(&tx_released);
+#endif
 }
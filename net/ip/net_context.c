@@ -29,10 +29,12 @@
 #include <string.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <misc/__assert.h>
 
 #include <net/net_ip.h>
 #include <net/net_socket.h>
 #include <net/net_context.h>
+#include <net/ip_buf.h>
 
 #include "contiki/ip/simple-udp.h"
 #include "contiki/ipv6/uip-ds6.h"
@@ -71,13 +73,33 @@ struct net_context {
 			enum net_tcp_type tcp_type;
 			int connection_status;
 			void *conn;
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+			/* Buffers waiting for room in the send window,
+			 * oldest first, and the one given back to the TX
+			 * fiber when the window opened.
+			 */
+			struct net_buf *pending[CONFIG_TCP_SEND_SEGMENTS];
+			uint8_t pending_count;
+			struct net_buf *resending;
+			/* Buffers accepted by net_send() that uIP has not
+			 * taken yet, wherever they are. There are never more
+			 * than pending slots, so a buffer can always wait.
+			 */
+			uint8_t queued;
+#else
 			struct net_buf *pending;
+#endif
 			uint8_t retry_count;
 		};
 #endif
 	};
 
 	bool receiver_registered;
+
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+	/* Buffers held by this context */
+	struct ip_buf_quota quota;
+#endif
 };
 
 /* Override this in makefile if needed */
@@ -224,12 +246,29 @@ void net_context_put(struct net_context *context)
 		tcp_unlisten(UIP_HTONS(context->tuple.local_port),
 			     &context->tcp);
 	}
+
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+	if (context->tuple.ip_proto == IPPROTO_TCP) {
+		while (context->pending_count) {
+			context->pending_count--;
+			ip_buf_unref(context->pending[context->pending_count]);
+		}
+		context->queued = 0;
+	}
+#endif
 #endif
 
 	memset(&context->tuple, 0, sizeof(context->tuple));
 	memset(&context->udp, 0, sizeof(context->udp));
 	context->receiver_registered = false;
 
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+	/* Buffers still in flight are released to the context later */
+	ip_buf_reserve_tx(context, 0);
+	memset(context->quota.alloc_failures, 0,
+	       sizeof(context->quota.alloc_failures));
+#endif
+
 	context_sem_give(&contexts_lock);
 }
 
@@ -250,6 +289,17 @@ struct nano_fifo *net_context_get_queue(struct net_context *context)
 	return &context->rx_queue;
 }
 
+#if defined(CONFIG_IP_BUF_CONTEXT_QUOTA)
+struct ip_buf_quota *net_context_get_quota(struct net_context *context)
+{
+	if (!context) {
+		return NULL;
+	}
+
+	return &context->quota;
+}
+#endif
+
 struct simple_udp_connection *
 net_context_get_udp_connection(struct net_context *context)
 {
@@ -416,6 +466,9 @@ PROCESS_THREAD(tcp, ev, data, buf, user_data)
 			ip_buf_appdatalen(clone) = uip_len(buf);
 			ip_buf_len(clone) = uip_len(buf) + UIP_IPTCPH_LEN + UIP_LLH_LEN;
 			ip_buf_context(clone) = user_data;
+#ifdef CONFIG_NETWORKING_RX_TIMESTAMP
+			ip_buf_rx_timestamp(clone) = ip_buf_rx_timestamp(buf);
+#endif
 			if (!ip_buf_context(buf)) {
 				ip_buf_context(buf) = user_data;
 			}
@@ -431,6 +484,11 @@ PROCESS_THREAD(tcp, ev, data, buf, user_data)
 				ip_buf_appdata(clone),
 				ip_buf_appdatalen(clone));
 
+			/* The data is acknowledged already, it is charged
+			 * to the context even over its quota.
+			 */
+			ip_buf_charge_rx(user_data, clone, true);
+
 			nano_fifo_put(net_context_get_queue(user_data), clone);
 
 			ip_buf_sent_status(buf) = 1;
@@ -652,8 +710,12 @@ struct net_buf *net_context_tcp_get_pending(struct net_context *context)
 		return NULL;
 	}
 
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+	return context->pending_count ? context->pending[0] : NULL;
+#else
 	return context->pending;
 #endif
+#endif
 }
 
 void net_context_tcp_set_pending(struct net_context *context,
@@ -666,10 +728,98 @@ void net_context_tcp_set_pending(struct net_context *context,
 		return;
 	}
 
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+	/* Waiting buffers are queued with net_context_tcp_add_pending() */
+	ARG_UNUSED(buf);
+#else
 	context->pending = buf;
 #endif
+#endif
+}
+
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+/* Queue a buffer that does not fit into the send window. The buffer that
+ * was given back to the TX fiber goes in front of the others. There is
+ * always room, see net_context_tcp_reserve().
+ */
+void net_context_tcp_add_pending(struct net_context *context,
+				 struct net_buf *buf, bool oldest)
+{
+	__ASSERT(context->pending_count < CONFIG_TCP_SEND_SEGMENTS,
+		 "more buffers queued than reserved");
+
+	if (oldest) {
+		memmove(&context->pending[1], &context->pending[0],
+			context->pending_count * sizeof(context->pending[0]));
+		context->pending[0] = buf;
+	} else {
+		context->pending[context->pending_count] = buf;
+	}
+
+	context->pending_count++;
+
+	if (buf == context->resending) {
+		context->resending = NULL;
+	}
+}
+
+/* Account a buffer accepted by net_send() until uIP takes it, so that it
+ * cannot find the pending slots all taken if it has to wait.
+ */
+int net_context_tcp_reserve(struct net_context *context)
+{
+	if (context->queued == CONFIG_TCP_SEND_SEGMENTS) {
+		return -EAGAIN;
+	}
+
+	context->queued++;
+
+	return 0;
+}
+
+/* uIP has taken, or dropped, a buffer accepted by net_send() */
+void net_context_tcp_release(struct net_context *context)
+{
+	if (context->queued) {
+		context->queued--;
+	}
 }
 
+/* Whether buf has to wait behind older buffers to keep the data in
+ * order.
+ */
+bool net_context_tcp_is_blocked(struct net_context *context,
+				struct net_buf *buf)
+{
+	if (buf == context->resending) {
+		context->resending = NULL;
+		return false;
+	}
+
+	return context->pending_count || context->resending;
+}
+
+/* Take the oldest waiting buffer to be sent again. Only one buffer is
+ * given back at a time so that it cannot be overtaken by the others.
+ */
+struct net_buf *net_context_tcp_resend_pending(struct net_context *context)
+{
+	struct net_buf *buf;
+
+	if (!context->pending_count || context->resending) {
+		return NULL;
+	}
+
+	buf = context->pending[0];
+	context->pending_count--;
+	memmove(&context->pending[0], &context->pending[1],
+		context->pending_count * sizeof(context->pending[0]));
+	context->resending = buf;
+
+	return buf;
+}
+#endif
+
 void net_context_tcp_set_retry_count(struct net_context *context,
 				     uint8_t count)
 {
@@ -75,6 +75,15 @@ void *net_context_get_internal_connection(struct net_context *context);
 struct net_buf *net_context_tcp_get_pending(struct net_context *context);
 void net_context_tcp_set_pending(struct net_context *context,
 				 struct net_buf *buf);
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+void net_context_tcp_add_pending(struct net_context *context,
+				 struct net_buf *buf, bool oldest);
+int net_context_tcp_reserve(struct net_context *context);
+void net_context_tcp_release(struct net_context *context);
+bool net_context_tcp_is_blocked(struct net_context *context,
+				struct net_buf *buf);
+struct net_buf *net_context_tcp_resend_pending(struct net_context *context);
+#endif
 void net_context_set_connection_status(struct net_context *context,
 				       int status);
 void net_context_unset_receiver_registered(struct net_context *context);
@@ -198,6 +207,15 @@ int net_send(struct net_buf *buf)
 			return status;
 		}
 
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+		if (net_context_tcp_reserve(ip_buf_context(buf))) {
+			/* Too much data waiting for the send window, the
+			 * caller keeps the buffer and tries again later.
+			 */
+			return -EAGAIN;
+		}
+#endif
+
 		ret = status;
 	}
 #endif
@@ -231,6 +249,38 @@ int net_send(struct net_buf *buf)
 #include "mac/handler-802154.h"
 #endif
 
+#ifdef CONFIG_NETWORKING_RX_TIMESTAMP
+/* Time received packets take from net_recv() to net_receive() */
+static struct {
+	uint32_t count;
+	uint64_t total;
+	uint64_t max;
+} rx_latency;
+
+static void rx_latency_record(struct net_buf *buf)
+{
+	uint64_t latency = sys_cycle_get_64() - ip_buf_rx_timestamp(buf);
+
+	rx_latency.count++;
+	rx_latency.total += latency;
+	if (latency > rx_latency.max) {
+		rx_latency.max = latency;
+	}
+}
+#else
+#define rx_latency_record(buf)
+#endif
+
+/* Wakeups of the timer fiber, each runs the etimers expired by then */
+static uint32_t timer_wakeups;
+
+#define timer_wakeup_record() (timer_wakeups++)
+
+uint32_t net_timer_wakeups_get(void)
+{
+	return timer_wakeups;
+}
+
 static void stats(void)
 {
 	static clock_time_t last_print;
@@ -287,6 +337,18 @@ static void stats(void)
 		NET_DBG("UDP chkerr     %d\n",
 			STAT(icmp.chkerr));
 
+#ifdef CONFIG_NETWORKING_RX_TIMESTAMP
+		if (rx_latency.count) {
+			NET_DBG("RX latency us  avg\t%u\tmax\t%u\n",
+				(uint32_t)sys_clock_cycles_to_us64(
+					rx_latency.total) / rx_latency.count,
+				(uint32_t)sys_clock_cycles_to_us64(
+					rx_latency.max));
+		}
+#endif
+
+		NET_DBG("Timer wakeups  %u\n", timer_wakeups);
+
 #if NET_COAP_CONF_STATS
 		NET_DBG("CoAP recv      %d\terr\t%d\tsent\t%d\tre-sent\t%d\n",
 			NET_COAP_STAT(recv),
@@ -332,6 +394,8 @@ static void stats(void)
 }
 #else
 #define net_print_statistics()
+#define rx_latency_record(buf)
+#define timer_wakeup_record()
 #endif
 
 /* Switch the ports and addresses and set route and neighbor cache.
@@ -573,6 +637,10 @@ int net_recv(struct net_buf *buf)
 		return -ENODATA;
 	}
 
+#ifdef CONFIG_NETWORKING_RX_TIMESTAMP
+	ip_buf_rx_timestamp(buf) = sys_cycle_get_64();
+#endif
+
 	nano_fifo_put(&netdev.rx_queue, buf);
 
 	return 0;
@@ -606,6 +674,12 @@ static void udp_packet_receive(struct simple_udp_connection *c,
 		context, ip_buf_len(buf),
 		ip_buf_appdata(buf), ip_buf_appdatalen(buf));
 
+	/* Do not let a slow reader hold all the RX buffers */
+	if (!ip_buf_charge_rx(context, buf, false)) {
+		ip_buf_unref(buf);
+		return;
+	}
+
 	nano_fifo_put(net_context_get_queue(context), buf);
 }
 
@@ -723,6 +797,10 @@ struct net_buf *net_receive(struct net_context *context, int32_t timeout)
 		ip_buf_appdata(buf) = &uip_buf(buf)[reserve];
 	}
 
+	if (buf) {
+		rx_latency_record(buf);
+	}
+
 	return buf;
 }
 
@@ -759,6 +837,11 @@ static void udp_packet_reply(struct simple_udp_connection *c,
 		context, ip_buf_len(buf),
 		ip_buf_appdata(buf), ip_buf_appdatalen(buf), queue);
 
+	if (!ip_buf_charge_rx(context, buf, false)) {
+		ip_buf_unref(buf);
+		return;
+	}
+
 	nano_fifo_put(queue, buf);
 }
 
@@ -767,6 +850,9 @@ static int check_and_send_packet(struct net_buf *buf)
 {
 	struct net_tuple *tuple;
 	struct simple_udp_connection *udp;
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+	struct uip_conn *conn;
+#endif
 	int ret = 0;
 
 	if (!netdev.drv) {
@@ -823,7 +909,42 @@ static int check_and_send_packet(struct net_buf *buf)
 		if (uip_len(buf) == 0) {
 			uip_len(buf) = buf->len;
 		}
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+		/* Data must not overtake the buffers already waiting for
+		 * room in the send window.
+		 */
+		if (net_context_tcp_is_blocked(ip_buf_context(buf), buf)) {
+			net_context_tcp_add_pending(ip_buf_context(buf), buf,
+						    false);
+			return 1;
+		}
+#endif
 		ret = net_context_tcp_send(buf);
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+		if (ret == -ENOSPC) {
+			/* The window is full, net_tcp_window_open() sends
+			 * the buffer when an ACK makes room for it.
+			 */
+			net_context_tcp_add_pending(ip_buf_context(buf), buf,
+						    true);
+			ip_buf_sent_status(buf) = 0;
+			return 1;
+		}
+
+		net_context_tcp_release(ip_buf_context(buf));
+
+		conn = net_context_get_internal_connection(
+							ip_buf_context(buf));
+		if (ret == -EAGAIN && uip_tcp_is_unacked(conn, buf)) {
+			/* The output failed after uIP took the segment, it
+			 * retransmits it itself. Sending the buffer again
+			 * would duplicate its data, only our reference is
+			 * dropped, as the driver does on success.
+			 */
+			ip_buf_unref(buf);
+			return 1;
+		}
+#endif
 		if (ret < 0 && ret != -EAGAIN) {
 			NET_DBG("Packet could not be sent properly "
 				"(err %d)\n", ret);
@@ -854,6 +975,21 @@ static int check_and_send_packet(struct net_buf *buf)
 	return ret;
 }
 
+#if CONFIG_TCP_SEND_SEGMENTS > 1
+/* Called by uIP when acknowledged data has made room in the send window
+ * of the context.
+ */
+void net_tcp_window_open(struct net_context *context)
+{
+	struct net_buf *buf;
+
+	buf = net_context_tcp_resend_pending(context);
+	if (buf) {
+		nano_fifo_put(&netdev.tx_queue, buf);
+	}
+}
+#endif
+
 static void net_tx_fiber(void)
 {
 	NET_DBG("Starting TX fiber (stack %zu bytes)\n",
@@ -929,8 +1065,15 @@ static void net_rx_fiber(void)
 
 /*
  * Run various Contiki timers.
+ *
+ * The fiber blocks on a single timeout armed for the next etimer
+ * expiry, and is signalled by net_timer_check() only when a timer is
+ * added that expires before that. An idle stack does not wake up.
  */
-#define MAX_TIMER_WAKEUP 0x7ffffff
+static struct nano_sem timer_sem;
+
+/* When the timer fiber wakes up, 0 if it waits for a new timer */
+static clock_time_t timer_deadline;
 
 static void net_timer_fiber(void)
 {
@@ -940,47 +1083,54 @@ static void net_timer_fiber(void)
 		sizeof(timer_fiber_stack));
 
 	while (1) {
+		timer_wakeup_record();
+
 		/* Run various timers */
 		next_wakeup = etimer_request_poll();
 
 		if (next_wakeup == 0) {
-			/* There was no timers, wait again */
-			next_wakeup = MAX_TIMER_WAKEUP;
-		} else {
-			if (next_wakeup > MAX_TIMER_WAKEUP) {
-				next_wakeup = MAX_TIMER_WAKEUP;
-			}
+			/* There was no timers, wait for one to be added */
+			timer_deadline = 0;
+			nano_fiber_sem_take(&timer_sem, TICKS_UNLIMITED);
+			continue;
+		}
 
 #ifdef CONFIG_INIT_STACKS
-			{
+		{
 #define PRINT_CYCLE (60 * sys_clock_ticks_per_sec)
 
-				static uint32_t next_print;
-				uint32_t curr = sys_tick_get_32();
+			static uint32_t next_print;
+			uint32_t curr = sys_tick_get_32();
 
-				/* Print stack usage every n. sec */
-				if (!next_print ||
-				    (next_print < curr &&
-				     (!((curr - next_print) > PRINT_CYCLE)))) {
-					uint32_t new_print;
+			/* Print stack usage every n. sec */
+			if (!next_print ||
+			    (next_print < curr &&
+			     (!((curr - next_print) > PRINT_CYCLE)))) {
+				uint32_t new_print;
 
-					net_analyze_stack("timer fiber",
-							  timer_fiber_stack,
+				net_analyze_stack("timer fiber",
+						  timer_fiber_stack,
 						  sizeof(timer_fiber_stack));
-					new_print = curr + PRINT_CYCLE;
-					if (new_print > curr) {
-						next_print = new_print;
-					} else {
-						/* Overflow */
-						next_print = PRINT_CYCLE -
-							(0xffffffff - curr);
-					}
+				new_print = curr + PRINT_CYCLE;
+				if (new_print > curr) {
+					next_print = new_print;
+				} else {
+					/* Overflow */
+					next_print = PRINT_CYCLE -
+						(0xffffffff - curr);
 				}
 			}
+		}
 #endif
+
+		timer_deadline = clock_time() + next_wakeup;
+		if (!timer_deadline) {
+			/* 0 means idle, wake up a tick early instead */
+			timer_deadline--;
+			next_wakeup--;
 		}
 
-		fiber_sleep(next_wakeup);
+		nano_fiber_sem_take(&timer_sem, next_wakeup);
 	}
 }
 
@@ -1003,6 +1153,8 @@ static void init_tx_queue(void)
 
 static void init_timer_fiber(void)
 {
+	nano_sem_init(&timer_sem);
+
 	timer_fiber_id = fiber_start(timer_fiber_stack,
 				     sizeof(timer_fiber_stack),
 				     (nano_fiber_entry_t)net_timer_fiber,
@@ -1011,7 +1163,27 @@ static void init_timer_fiber(void)
 
 void net_timer_check(void)
 {
-	fiber_wakeup(timer_fiber_id);
+	clock_time_t next;
+
+	/* The timer fiber re-arms itself after running the timers */
+	if (sys_thread_self_get() == timer_fiber_id) {
+		return;
+	}
+
+	if (!etimer_pending()) {
+		return;
+	}
+
+	/* Only wake up the fiber if the timeout it sleeps on is too late.
+	 * Timers that already expired have no remaining time.
+	 */
+	next = etimer_next_expiration_time();
+	if (next && timer_deadline &&
+	    (int32_t)(clock_time() + next - timer_deadline) >= 0) {
+		return;
+	}
+
+	nano_sem_give(&timer_sem);
 }
 
 int net_set_mac(uint8_t *mac, uint8_t len)
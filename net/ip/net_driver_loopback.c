@@ -35,6 +35,9 @@
 #include <net/buf.h>
 #include <net/net_ip.h>
 #include <net/net_socket.h>
+#include <net/ip_buf.h>
+
+#include "net_driver_loopback.h"
 
 /* The following uIP includes are for testing purposes only. Never
  * ever use them in your application.
@@ -70,11 +73,50 @@ static int net_driver_loopback_open(void)
 	return 0;
 }
 
+static net_driver_loopback_filter_t loopback_filter;
+
+void net_driver_loopback_filter_set(net_driver_loopback_filter_t filter)
+{
+	loopback_filter = filter;
+}
+
 static int net_driver_loopback_send(struct net_buf *buf)
 {
+	struct net_buf *rx;
+	int ret;
+
 	NET_DBG("received %d bytes\n", buf->len);
 
-	net_recv(buf);
+	ret = loopback_filter ? loopback_filter(buf) : 1;
+	if (ret < 0) {
+		NET_DBG("failed to send %d bytes (%d)\n", buf->len, ret);
+		return ret;
+	}
+
+	if (!ret) {
+		NET_DBG("dropped %d bytes\n", buf->len);
+		ip_buf_unref(buf);
+		return 1;
+	}
+
+	/* Loop back a copy like a real link would, the sender may still
+	 * hold on to the buffer, e.g. TCP to retransmit it.
+	 */
+	rx = ip_buf_get_reserve_rx(0);
+	if (!rx) {
+		NET_DBG("no RX buffer, dropped %d bytes\n", buf->len);
+		ip_buf_unref(buf);
+		return 1;
+	}
+
+	memcpy(net_buf_add(rx, buf->len), buf->data, buf->len);
+	uip_len(rx) = ip_buf_len(rx);
+	linkaddr_copy(&ip_buf_ll_src(rx), &ip_buf_ll_src(buf));
+	linkaddr_copy(&ip_buf_ll_dest(rx), &ip_buf_ll_dest(buf));
+
+	ip_buf_unref(buf);
+
+	net_recv(rx);
 
 	return 1;
 }
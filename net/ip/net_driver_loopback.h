@@ -14,6 +14,11 @@
  * limitations under the License.
  */
 
+#ifndef __NET_DRIVER_LOOPBACK_H
+#define __NET_DRIVER_LOOPBACK_H
+
+#include <net/buf.h>
+
  /**
   * @brief Register loopback driver
   *
@@ -23,3 +28,26 @@
   */
 
 int net_driver_loopback_init(void);
+
+/**
+ * @brief Loopback packet filter
+ *
+ * @param buf Packet about to be looped back.
+ *
+ * @return 1 to loop the packet back, 0 to drop it as if lost on the link,
+ * or a negative errno code to fail the send, the buffer then stays with
+ * the caller as with a driver that cannot transmit.
+ */
+typedef int (*net_driver_loopback_filter_t)(struct net_buf *buf);
+
+/**
+ * @brief Set a filter on the looped back packets
+ *
+ * Lets tests inspect the packets and simulate their loss or a failed
+ * transmission.
+ *
+ * @param filter Filter called for each packet, NULL for none.
+ */
+void net_driver_loopback_filter_set(net_driver_loopback_filter_t filter);
+
+#endif /* __NET_DRIVER_LOOPBACK_H */
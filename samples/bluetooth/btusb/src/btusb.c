@@ -83,6 +83,10 @@ static struct device *btusb_dev;
 
 static struct nano_fifo rx_queue;
 
+/* ACL data is sent to the Host asynchronously, two buffers in flight */
+static struct usb_transfer_ep bulk_in_ep;
+static struct nano_sem bulk_in_sem;
+
 /* HCI command buffers */
 #define CMD_BUF_SIZE (CONFIG_BLUETOOTH_HCI_SEND_RESERVE + \
 		      sizeof(struct bt_hci_cmd_hdr) + \
@@ -477,10 +481,15 @@ static void btusb_bulk_out(uint8_t ep, enum usb_dc_ep_cb_status_code ep_status)
 	bt_send(buf);
 }
 
-/* EP Bulk IN handler, used to send data to the Host */
-static void btusb_bulk_in(uint8_t ep, enum usb_dc_ep_cb_status_code ep_status)
+/* Bulk IN transfer completion, the buffer is released to the stack */
+static void btusb_bulk_in_done(uint8_t ep, struct net_buf *buf, int status)
 {
-	SYS_LOG_ERR("Not implemented");
+	if (status < 0) {
+		SYS_LOG_ERR("ACL transfer failed: %d", status);
+	}
+
+	net_buf_unref(buf);
+	nano_isr_sem_give(&bulk_in_sem);
 }
 
 /* EP ISO OUT handler, used to read the data received from the Host */
@@ -506,7 +515,7 @@ static struct usb_ep_cfg_data btusb_ep[] = {
 		.ep_addr = BTUSB_ENDP_BULK_OUT
 	},
 	{
-		.ep_cb = btusb_bulk_in,
+		.ep_cb = usb_transfer_ep_callback,
 		.ep_addr = BTUSB_ENDP_BULK_IN
 	},
 	{
@@ -650,6 +659,17 @@ static int btusb_init(struct device *dev)
 	btusb_config.interface.payload_data = dev_data->interface_data;
 	btusb_dev = dev;
 
+	nano_sem_init(&bulk_in_sem);
+	nano_sem_give(&bulk_in_sem);
+	nano_sem_give(&bulk_in_sem);
+
+	ret = usb_transfer_ep_init(&bulk_in_ep, BTUSB_ENDP_BULK_IN,
+				   BTUSB_BULK_EP_MPS);
+	if (ret < 0) {
+		SYS_LOG_ERR("Failed to init bulk IN endpoint");
+		return ret;
+	}
+
 	/* Initialize the USB driver with the right configuration */
 	ret = usb_set_config(&btusb_config);
 	if (ret < 0) {
@@ -713,8 +733,14 @@ void main(void)
 			try_write(BTUSB_ENDP_INT, buf);
 			break;
 		case BT_BUF_ACL_IN:
-			try_write(BTUSB_ENDP_BULK_IN, buf);
-			break;
+			/* Queued behind the transfer in progress, if any */
+			nano_sem_take(&bulk_in_sem, TICKS_UNLIMITED);
+			if (usb_transfer(BTUSB_ENDP_BULK_IN, buf,
+					 btusb_bulk_in_done) < 0) {
+				nano_sem_give(&bulk_in_sem);
+				break;
+			}
+			continue;
 		default:
 			SYS_LOG_ERR("Unknown type %u", bt_buf_get_type(buf));
 			break;
@@ -17,6 +17,8 @@
 #include <zephyr.h>
 #include <misc/printk.h>
 #include <misc/shell.h>
+#include <misc/stack.h>
+#include <misc/int_latency.h>
 #define DEVICE_NAME "test shell"
 
 static int shell_cmd_ping(int argc, char *argv[])
@@ -45,6 +47,12 @@ const struct shell_cmd commands[] = {
 	{ "ping", shell_cmd_ping },
 	{ "ticks", shell_cmd_ticks },
 	{ "highticks", shell_cmd_highticks },
+#ifdef CONFIG_STACK_USAGE
+	STACK_USAGE_SHELL_CMD,
+#endif
+#ifdef CONFIG_INT_LATENCY_STATS
+	INT_LATENCY_SHELL_CMD,
+#endif
 	{ NULL, NULL }
 };
 
@@ -56,5 +64,9 @@ void main(void)
 		SYS_KERNEL_VER_MAJOR(version),
 		SYS_KERNEL_VER_MINOR(version),
 		SYS_KERNEL_VER_PATCHLEVEL(version));
+
+#ifdef CONFIG_INT_LATENCY_STATS
+	int_latency_init();
+#endif
 	shell_init("shell> ", commands);
 }
@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016 Intel Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Kernel event trace decoder.
+#
+# Decodes the records of the kernel event logger trace buffer
+# (CONFIG_KERNEL_EVENT_LOGGER_TRACE) into a timeline, followed by the CPU
+# time of each thread and the activity of each kernel object.
+#
+# The input is either the records as returned by sys_k_event_trace_get(),
+# 16 little-endian bytes each, or with --text a console log where each
+# record was printed as:
+#
+#     <timestamp> <event id> <data> <thread> <object>
+#
+# in hexadecimal, "%08x %04x %04x %08x %08x". Other lines are ignored.
+#
+# A context switch record is made by the thread being switched out, so the
+# time since the previous context switch is accounted to that thread. Sleep
+# records are made on wake up and carry the cycles slept, which are taken
+# out of the CPU time of the thread that slept (the idle task or fiber).
+
+import re
+import struct
+import subprocess
+import sys
+from argparse import ArgumentParser
+from collections import defaultdict, OrderedDict
+
+EVENT_CONTEXT_SWITCH = 0x0001
+EVENT_INTERRUPT = 0x0002
+EVENT_SLEEP = 0x0003
+EVENT_SEM_GIVE = 0x0007
+EVENT_SEM_TAKE = 0x0008
+EVENT_FIFO_PUT = 0x0009
+EVENT_FIFO_GET = 0x000A
+EVENT_MUTEX_CONTENDED = 0x000B
+
+EVENT_NAMES = {
+    EVENT_CONTEXT_SWITCH: "switch out",
+    EVENT_INTERRUPT: "irq",
+    EVENT_SLEEP: "wake up",
+    EVENT_SEM_GIVE: "sem give",
+    EVENT_SEM_TAKE: "sem take",
+    EVENT_FIFO_PUT: "fifo put",
+    EVENT_FIFO_GET: "fifo get",
+    EVENT_MUTEX_CONTENDED: "mutex contended",
+}
+
+OBJECT_EVENTS = (EVENT_SEM_GIVE, EVENT_SEM_TAKE, EVENT_FIFO_PUT,
+                 EVENT_FIFO_GET, EVENT_MUTEX_CONTENDED)
+
+RECORD = struct.Struct("<IHHII")
+
+text_re = re.compile(r"\b([0-9a-fA-F]{8}) ([0-9a-fA-F]{4}) ([0-9a-fA-F]{4}) "
+                     r"([0-9a-fA-F]{8}) ([0-9a-fA-F]{8})\b")
+
+
+def read_binary(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    records = []
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        record = RECORD.unpack_from(data, offset)
+        # skip the free slots of a raw dump of the trace buffer
+        if record[1]:
+            records.append(record)
+    return records
+
+
+def read_text(path):
+    records = []
+    with open(path) as f:
+        for line in f:
+            m = text_re.search(line)
+            if m:
+                records.append(tuple(int(x, 16) for x in m.groups()))
+    return records
+
+
+def read_symbols(elf, nm):
+    symbols = {}
+    out = subprocess.check_output([nm, elf], universal_newlines=True)
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1] in "bBdDrR":
+            symbols[int(fields[0], 16)] = fields[2]
+    return symbols
+
+
+def unwrap(records):
+    """Turn the 32-bit timestamps into cycles since the first record.
+
+    Records are in the order their slot was reserved, an interrupt may
+    reserve its slot before the record it interrupted takes its timestamp,
+    so a timestamp going back by less than half the range is not a wrap.
+    """
+    elapsed = 0
+    last = records[0][0]
+    for record in records:
+        delta = (record[0] - last) & 0xffffffff
+        if delta >= 0x80000000:
+            delta -= 0x100000000
+        elapsed += delta
+        last = record[0]
+        yield (elapsed,) + record[1:]
+
+
+class Decoder:
+    def __init__(self, symbols, hz):
+        self.symbols = symbols
+        self.hz = hz
+        self.cpu = OrderedDict()
+        self.switches = defaultdict(int)
+        self.slept = defaultdict(int)
+        self.irqs = defaultdict(int)
+        self.objects = OrderedDict()
+        self.start = None
+        self.end = 0
+        self.last_switch = None
+
+    def name(self, addr):
+        if addr in self.symbols:
+            return self.symbols[addr]
+        return "%#010x" % addr
+
+    def time(self, cycles):
+        if self.hz:
+            return "%12.3f us" % (cycles * 1e6 / self.hz)
+        return "%12d cyc" % cycles
+
+    def describe(self, event_id, data, obj):
+        name = EVENT_NAMES.get(event_id, "event %#06x" % event_id)
+        if event_id == EVENT_INTERRUPT:
+            return "%s %d" % (name, data)
+        if event_id == EVENT_SLEEP:
+            return "%s by irq %d, slept %s" % (name, data,
+                                               self.time(obj).strip())
+        if event_id in OBJECT_EVENTS:
+            wait = " (waits)" if data else ""
+            return "%s %s%s" % (name, self.name(obj), wait)
+        return name
+
+    def account(self, when, event_id, data, thread, obj):
+        if self.start is None:
+            self.start = when
+            self.last_switch = when
+        self.end = when
+
+        self.cpu.setdefault(thread, 0)
+
+        if event_id == EVENT_CONTEXT_SWITCH:
+            self.cpu[thread] += when - self.last_switch
+            self.switches[thread] += 1
+            self.last_switch = when
+        elif event_id == EVENT_INTERRUPT:
+            self.irqs[data] += 1
+        elif event_id == EVENT_SLEEP:
+            self.slept[thread] += obj
+        elif event_id in OBJECT_EVENTS:
+            stats = self.objects.setdefault(obj, defaultdict(int))
+            stats[EVENT_NAMES[event_id]] += 1
+            if data:
+                stats["waits"] += 1
+
+    def timeline(self, records, quiet):
+        for when, event_id, data, thread, obj in records:
+            self.account(when, event_id, data, thread, obj)
+            if not quiet:
+                print("%s  %-24s %s" % (self.time(when), self.name(thread),
+                                        self.describe(event_id, data, obj)))
+
+    def summary(self):
+        if self.start is None:
+            print("No records")
+            return
+
+        total = self.end - self.start
+        print("")
+        print("Traced %s" % self.time(total).strip())
+        print("")
+        print("%-24s %16s %6s %16s %8s" % ("thread", "cpu", "%", "slept",
+                                           "switches"))
+        for thread, cycles in sorted(self.cpu.items(),
+                                     key=lambda item: -item[1]):
+            busy = cycles - self.slept[thread]
+            print("%-24s %16s %6.1f %16s %8d" %
+                  (self.name(thread), self.time(busy).strip(),
+                   100.0 * busy / total if total else 0,
+                   self.time(self.slept[thread]).strip(),
+                   self.switches[thread]))
+        if self.last_switch < self.end:
+            print("(%s after the last context switch not accounted)" %
+                  self.time(self.end - self.last_switch).strip())
+
+        if self.irqs:
+            print("")
+            print("%-24s %8s" % ("irq", "count"))
+            for irq, count in sorted(self.irqs.items()):
+                print("%-24d %8d" % (irq, count))
+
+        if self.objects:
+            print("")
+            print("%-24s %s" % ("object", "events"))
+            for obj, stats in self.objects.items():
+                print("%-24s %s" % (self.name(obj), ", ".join(
+                    "%s %d" % item for item in sorted(stats.items()))))
+
+
+def main():
+    parser = ArgumentParser(description="Decode kernel event trace records")
+    parser.add_argument("input", help="binary records, or console log "
+                        "with --text")
+    parser.add_argument("-t", "--text", action="store_true",
+                        help="read records printed in hexadecimal")
+    parser.add_argument("-e", "--elf", help="image to resolve thread and "
+                        "object addresses in")
+    parser.add_argument("--nm", default="nm", help="nm of the toolchain "
+                        "the image was built with")
+    parser.add_argument("--hz", type=int, default=0,
+                        help="timestamp rate, to print times in us")
+    parser.add_argument("-s", "--summary", action="store_true",
+                        help="only print the summary")
+    args = parser.parse_args()
+
+    records = read_text(args.input) if args.text else read_binary(args.input)
+    symbols = read_symbols(args.elf, args.nm) if args.elf else {}
+
+    decoder = Decoder(symbols, args.hz)
+    if records:
+        decoder.timeline(unwrap(records), args.summary)
+    decoder.summary()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Tickless kernel wakeups benchmark
+ *
+ * Sleeps for periods much longer than a tick, then reports the number of
+ * interrupts serviced, i.e. the number of times the system was woken up,
+ * and the share of the time spent idle. Also measures the time k_sleep()
+ * actually sleeps for its shortest timeout, and checks that threads of
+ * equal priority still share the CPU by time slices.
+ */
+
+#include <kernel.h>
+#include <misc/util.h>
+#include <misc/int_latency.h>
+
+#include <tc_util.h>
+
+#define PERIODS 10
+#define PERIOD_MS 100
+
+/* at most one wakeup per period, and a few more for other interrupts */
+#define MAX_WAKEUPS (PERIODS * 2)
+
+#define STACK_SIZE 512
+#define SPINNER_PRIO K_PRIO_PREEMPT(5)
+#define SLICE_MS 10
+#define SPIN_MS 100
+
+static char __stack spinner_stacks[2][STACK_SIZE];
+static volatile uint32_t spins[2];
+
+static uint32_t interrupts_get(void)
+{
+	struct int_latency_irq_stats irqs[CONFIG_INT_LATENCY_STATS_IRQS];
+	uint32_t total = 0;
+	int count, i;
+
+	count = int_latency_irq_stats_get(irqs, ARRAY_SIZE(irqs));
+
+	for (i = 0; i < count; i++) {
+		total += irqs[i].count;
+	}
+
+	return total;
+}
+
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+	return (uint32_t)((uint64_t)cycles * USEC_PER_SEC /
+			  sys_clock_hw_cycles_per_sec);
+}
+
+static void spinner_entry(void *count, void *p2, void *p3)
+{
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		(*(volatile uint32_t *)count)++;
+	}
+}
+
+/* neither of two busy threads of equal priority may starve the other */
+static int test_time_slicing(void)
+{
+	k_tid_t tids[2];
+	int i;
+
+	k_sched_time_slice_set(SLICE_MS, SPINNER_PRIO);
+
+	for (i = 0; i < 2; i++) {
+		tids[i] = k_thread_spawn(spinner_stacks[i], STACK_SIZE,
+					 spinner_entry, (void *)&spins[i],
+					 NULL, NULL, SPINNER_PRIO, 0, 0);
+	}
+
+	k_sleep(SPIN_MS);
+
+	for (i = 0; i < 2; i++) {
+		k_thread_abort(tids[i]);
+	}
+
+	k_sched_time_slice_set(0, 0);
+
+	TC_PRINT("Spinners sharing %d ms slices: %u and %u spins\n",
+		 SLICE_MS, spins[0], spins[1]);
+
+	if (!spins[0] || !spins[1]) {
+		TC_ERROR("A thread starved its peer of equal priority\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	uint32_t interrupts, start, slept;
+	int idle, i;
+	int result = TC_PASS;
+
+	TC_START("Tickless kernel wakeups");
+
+	int_latency_init();
+
+	/* the idle share since boot is of no interest */
+	k_thread_runtime_idle_percent_get();
+	int_latency_stats_reset();
+
+	for (i = 0; i < PERIODS; i++) {
+		k_sleep(PERIOD_MS);
+	}
+
+	interrupts = interrupts_get();
+	idle = k_thread_runtime_idle_percent_get();
+
+	TC_PRINT("%d periods of %d ms: %u interrupts, %d%% idle\n", PERIODS,
+		 PERIOD_MS, interrupts, idle);
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	if (interrupts > MAX_WAKEUPS) {
+		TC_ERROR("Woken up more than once per period\n");
+		result = TC_FAIL;
+	}
+#endif
+
+	/* start sleeping right after a wakeup */
+	k_sleep(1);
+
+	start = k_cycle_get_32();
+	k_sleep(1);
+	slept = k_cycle_get_32() - start;
+
+	TC_PRINT("k_sleep(1) slept %u us, one tick is %u us\n",
+		 cycles_to_us(slept), sys_clock_us_per_tick);
+
+	if (cycles_to_us(slept) < USEC_PER_MSEC) {
+		TC_ERROR("Slept less than requested\n");
+		result = TC_FAIL;
+	}
+
+	if (test_time_slicing() != TC_PASS) {
+		result = TC_FAIL;
+	}
+
+	TC_END_REPORT(result);
+}
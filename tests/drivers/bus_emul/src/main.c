@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * @file
+ * @brief Emulated bus test
+ *
+ * Reads the BMI160, BME280 and HTS221 drivers against the register models
+ * of the emulated SPI and I2C masters, checks the converted values and
+ * reports the bus traffic each sample takes.
+ */
+
+#include <zephyr.h>
+#include <sensor.h>
+#include <drivers/bus_emul.h>
+
+#include <tc_util.h>
+
+#define SAMPLES 16
+
+typedef int (*check_fn)(struct device *dev, int seq);
+
+static int check_value(const char *name, struct sensor_value *val,
+		       int32_t val1, int32_t val2)
+{
+	if (val->val1 != val1 || val->val2 != val2) {
+		TC_ERROR("%s reads %d.%06d, expected %d.%06d\n", name,
+			 val->val1, val->val2, val1, val2);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int64_t to_micro(struct sensor_value *val)
+{
+	return (int64_t)val->val1 * 1000000 + val->val2;
+}
+
+static int check_bmi160(struct device *dev, int seq)
+{
+	struct sensor_value accel[3], gyro[3];
+	int16_t gyro_raw[3], accel_raw[3];
+	int i;
+
+	/* axis i reads i + 1 times the first one, with opposite signs */
+	for (i = 0; i < 3; i++) {
+		gyro_raw[i] = (seq + 1) * 100 * (i + 1);
+		accel_raw[i] = -gyro_raw[i];
+	}
+
+	bus_emul_bmi160_set_sample(gyro_raw, accel_raw);
+
+	if (sensor_sample_fetch(dev) < 0 ||
+	    sensor_channel_get(dev, SENSOR_CHAN_ACCEL_ANY, accel) < 0 ||
+	    sensor_channel_get(dev, SENSOR_CHAN_GYRO_ANY, gyro) < 0) {
+		TC_ERROR("BMI160 fetch failed\n");
+		return TC_FAIL;
+	}
+
+	for (i = 1; i < 3; i++) {
+		if (to_micro(&gyro[i]) <= to_micro(&gyro[i - 1]) ||
+		    to_micro(&accel[i]) >= to_micro(&accel[i - 1]) ||
+		    to_micro(&gyro[0]) <= 0 || to_micro(&accel[0]) >= 0) {
+			TC_ERROR("BMI160 axes read back wrong\n");
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+static int check_bme280(struct device *dev, int seq)
+{
+	struct sensor_value val;
+
+	/* the compensation example of the datasheet */
+	bus_emul_bme280_set_adc(519888, 415148, 30000);
+
+	if (sensor_sample_fetch(dev) < 0) {
+		TC_ERROR("BME280 fetch failed\n");
+		return TC_FAIL;
+	}
+
+	if (sensor_channel_get(dev, SENSOR_CHAN_TEMP, &val) < 0 ||
+	    check_value("BME280 temperature", &val, 25, 80000) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* kPa */
+	if (sensor_channel_get(dev, SENSOR_CHAN_PRESS, &val) < 0 ||
+	    check_value("BME280 pressure", &val, 100, 653253) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* milli %RH */
+	if (sensor_channel_get(dev, SENSOR_CHAN_HUMIDITY, &val) < 0 ||
+	    check_value("BME280 humidity", &val, 54997, 70000) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int check_hts221(struct device *dev, int seq)
+{
+	struct sensor_value val;
+
+	bus_emul_hts221_set_out(3000, 1500);
+
+	if (sensor_sample_fetch(dev) < 0) {
+		TC_ERROR("HTS221 fetch failed\n");
+		return TC_FAIL;
+	}
+
+	if (sensor_channel_get(dev, SENSOR_CHAN_TEMP, &val) < 0 ||
+	    check_value("HTS221 temperature", &val, 25, 0) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* milli %RH */
+	if (sensor_channel_get(dev, SENSOR_CHAN_HUMIDITY, &val) < 0 ||
+	    check_value("HTS221 humidity", &val, 50000, 0) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int run_sensor(const char *name, const char *bus_name, check_fn check)
+{
+	struct bus_emul_stats stats;
+	struct device *dev, *bus;
+	int i;
+
+	dev = device_get_binding(name);
+	bus = device_get_binding(bus_name);
+	if (!dev || !bus) {
+		TC_ERROR("Cannot get %s or %s device\n", name, bus_name);
+		return TC_FAIL;
+	}
+
+	bus_emul_reset_stats(bus);
+
+	for (i = 0; i < SAMPLES; i++) {
+		if (check(dev, i) != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	bus_emul_get_stats(bus, &stats);
+
+	TC_PRINT("%s: %u transfers, %u messages, %u bytes for %d samples\n",
+		 name, stats.transfers, stats.messages, stats.bytes, SAMPLES);
+
+	/* every driver fetches a sample in a single burst */
+	if (stats.transfers != SAMPLES || stats.nacks) {
+		TC_ERROR("%s: expected %d transfers\n", name, SAMPLES);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("Emulated bus");
+
+	result = run_sensor(CONFIG_BMI160_NAME, CONFIG_SPI_EMUL_NAME,
+			    check_bmi160);
+
+	if (result == TC_PASS) {
+		result = run_sensor(CONFIG_BME280_DEV_NAME,
+				    CONFIG_I2C_EMUL_NAME, check_bme280);
+	}
+
+	if (result == TC_PASS) {
+		result = run_sensor(CONFIG_HTS221_NAME, CONFIG_I2C_EMUL_NAME,
+				    check_hts221);
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Sensor FIFO read test
+ *
+ * Reads a BMI160 on an emulated SPI bus one sample at a time with
+ * sensor_sample_fetch() and sensor_channel_get(), then in batches with
+ * sensor_fifo_read(), checks the batched samples and reports the bus
+ * transfers, bytes and cycles spent per sample for both.
+ */
+
+#include <zephyr.h>
+#include <sensor.h>
+#include <misc/util.h>
+#include <drivers/bus_emul.h>
+
+#include <tc_util.h>
+
+
+#define SAMPLES 256
+#define BATCH 64
+
+/* The driver's default output data rate is 100Hz */
+#define PERIOD (sys_clock_hw_cycles_per_sec / 100)
+
+static struct sensor_fifo_frame frames[BATCH];
+
+static struct device *spi;
+
+static void print_stats(const char *phase, uint32_t cycles)
+{
+	struct bus_emul_stats stats;
+
+	bus_emul_get_stats(spi, &stats);
+
+	TC_PRINT("%s: %u transfers, %u bytes, %u cycles for %d samples\n",
+		 phase, stats.transfers, stats.bytes, cycles, SAMPLES);
+	TC_PRINT("%s: %u.%02u transfers, %u.%02u bytes, %u cycles "
+		 "per sample\n", phase,
+		 stats.transfers / SAMPLES,
+		 stats.transfers * 100 / SAMPLES % 100,
+		 stats.bytes / SAMPLES, stats.bytes * 100 / SAMPLES % 100,
+		 cycles / SAMPLES);
+}
+
+static int fetch_samples(struct device *dev, uint32_t *transfers)
+{
+	struct sensor_value accel[3], gyro[3];
+	struct bus_emul_stats stats;
+	uint32_t start;
+	int i;
+
+	bus_emul_reset_stats(spi);
+	start = sys_cycle_get_32();
+
+	for (i = 0; i < SAMPLES; i++) {
+		if (sensor_sample_fetch(dev) < 0 ||
+		    sensor_channel_get(dev, SENSOR_CHAN_ACCEL_ANY, accel) < 0 ||
+		    sensor_channel_get(dev, SENSOR_CHAN_GYRO_ANY, gyro) < 0) {
+			TC_ERROR("Sample %d fetch failed\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	print_stats("Fetch", sys_cycle_get_32() - start);
+
+	bus_emul_get_stats(spi, &stats);
+	*transfers = stats.transfers;
+
+	return TC_PASS;
+}
+
+static int check_frames(struct sensor_fifo *fifo, int seq, int count)
+{
+	int i, j;
+
+	if (fifo->num_frames != count) {
+		TC_ERROR("Read %u frames, expected %d\n", fifo->num_frames,
+			 count);
+		return TC_FAIL;
+	}
+
+	if (!fifo->accel_scale || !fifo->gyro_scale) {
+		TC_ERROR("Missing scales\n");
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < count; i++, seq++) {
+		for (j = 0; j < 3; j++) {
+			if (fifo->frames[i].gyro[j] !=
+			    bus_emul_bmi160_gyro(seq, j) ||
+			    fifo->frames[i].accel[j] !=
+			    bus_emul_bmi160_accel(seq, j)) {
+				TC_ERROR("Frame %d holds wrong data\n", i);
+				return TC_FAIL;
+			}
+		}
+
+		if (i && fifo->frames[i].timestamp -
+		    fifo->frames[i - 1].timestamp != PERIOD) {
+			TC_ERROR("Frame %d timestamp off\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+static int read_batches(struct device *dev, uint32_t *transfers)
+{
+	struct sensor_fifo fifo = {
+		.frames = frames,
+		.max_frames = BATCH,
+	};
+	struct bus_emul_stats stats;
+	uint32_t start, cycles = 0;
+	int seq;
+
+	bus_emul_reset_stats(spi);
+
+	for (seq = 0; seq < SAMPLES; seq += BATCH) {
+		bus_emul_bmi160_fifo_fill(BATCH, seq);
+
+		start = sys_cycle_get_32();
+
+		if (sensor_fifo_read(dev, &fifo) < 0) {
+			TC_ERROR("FIFO read failed\n");
+			return TC_FAIL;
+		}
+
+		cycles += sys_cycle_get_32() - start;
+
+		if (check_frames(&fifo, seq, BATCH) != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	print_stats("FIFO", cycles);
+
+	bus_emul_get_stats(spi, &stats);
+	*transfers = stats.transfers;
+
+	return TC_PASS;
+}
+
+static int read_partial(struct device *dev)
+{
+	struct sensor_fifo fifo = {
+		.frames = frames,
+		.max_frames = 8,
+	};
+
+	/* fewer frames fit in the buffer than are queued */
+	bus_emul_bmi160_fifo_fill(20, 0);
+
+	if (sensor_fifo_read(dev, &fifo) < 0 ||
+	    check_frames(&fifo, 0, 8) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	fifo.max_frames = BATCH;
+
+	if (sensor_fifo_read(dev, &fifo) < 0 ||
+	    check_frames(&fifo, 8, 12) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* an empty FIFO is not an error */
+	if (sensor_fifo_read(dev, &fifo) < 0 ||
+	    check_frames(&fifo, 20, 0) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *dev;
+	uint32_t fetch_transfers, fifo_transfers;
+	int result;
+
+	TC_START("Sensor FIFO read");
+
+	dev = device_get_binding(CONFIG_BMI160_NAME);
+	if (!dev) {
+		TC_ERROR("Cannot get %s device\n", CONFIG_BMI160_NAME);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	spi = device_get_binding(CONFIG_SPI_EMUL_NAME);
+
+	result = fetch_samples(dev, &fetch_transfers);
+
+	if (result == TC_PASS) {
+		result = read_batches(dev, &fifo_transfers);
+	}
+
+	if (result == TC_PASS) {
+		result = read_partial(dev);
+	}
+
+	if (result == TC_PASS && fifo_transfers >= fetch_transfers) {
+		TC_ERROR("FIFO reads took %u transfers, fetches %u\n",
+			 fifo_transfers, fetch_transfers);
+		result = TC_FAIL;
+	}
+
+	TC_END_REPORT(result);
+}
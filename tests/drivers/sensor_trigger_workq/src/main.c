@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * @file
+ * @brief Sensor trigger work queue test
+ *
+ * Submits work items of two priority levels from a fiber, as a GPIO
+ * interrupt would, and checks that the higher level runs first, that a
+ * pending item is coalesced and that the latency statistics add up.
+ */
+
+#include <zephyr.h>
+#include <sensor.h>
+#include <misc/util.h>
+
+#include <tc_util.h>
+
+#define FIBER_PRIORITY (CONFIG_SENSOR_TRIGGER_WORKQ_PRIORITY - 1)
+#define STACK_SIZE 512
+
+/* the handlers only compare the device pointers */
+static struct device dev_low, dev_high, dev_none;
+
+static struct sensor_trigger_work work_low, work_high;
+
+static struct device *order[2];
+static int runs;
+
+static struct nano_sem handled_sem;
+static struct nano_sem done_sem;
+
+static char __stack fiber_stack[STACK_SIZE];
+
+static void work_handler(struct device *dev)
+{
+	if (runs < ARRAY_SIZE(order)) {
+		order[runs] = dev;
+	}
+
+	if (++runs == ARRAY_SIZE(order)) {
+		nano_sem_give(&handled_sem);
+	}
+}
+
+static void submit_fiber(int arg1, int arg2)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	/* the work queue fiber has a lower priority, nothing runs yet */
+	sensor_trigger_work_submit(&work_low);
+	sensor_trigger_work_submit(&work_high);
+	sensor_trigger_work_submit(&work_low);
+
+	nano_fiber_sem_take(&handled_sem, TICKS_UNLIMITED);
+	nano_fiber_sem_give(&done_sem);
+}
+
+static int check_stats(struct device *dev, uint32_t coalesced)
+{
+	struct sensor_trigger_stats stats;
+
+	if (sensor_trigger_stats_get(dev, &stats) < 0) {
+		TC_ERROR("No statistics\n");
+		return TC_FAIL;
+	}
+
+	TC_PRINT("count %u, coalesced %u, latency %u/%u/%u cycles\n",
+		 stats.count, stats.coalesced, stats.latency_min,
+		 stats.latency_avg, stats.latency_max);
+
+	if (stats.count != 1 || stats.coalesced != coalesced ||
+	    stats.latency_min != stats.latency_max ||
+	    stats.latency_avg != stats.latency_min) {
+		TC_ERROR("Wrong statistics\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct sensor_trigger_stats stats;
+	int result = TC_PASS;
+
+	TC_START("Sensor trigger work queue");
+
+	nano_sem_init(&handled_sem);
+	nano_sem_init(&done_sem);
+
+	sensor_trigger_work_init(&work_low, &dev_low, work_handler, 1);
+	sensor_trigger_work_init(&work_high, &dev_high, work_handler, 0);
+
+	task_fiber_start(fiber_stack, STACK_SIZE, submit_fiber, 0, 0,
+			 FIBER_PRIORITY, 0);
+
+	nano_task_sem_take(&done_sem, TICKS_UNLIMITED);
+
+	if (runs != 2 || order[0] != &dev_high || order[1] != &dev_low) {
+		TC_ERROR("Work ran %d times or out of order\n", runs);
+		result = TC_FAIL;
+	}
+
+	if (result == TC_PASS) {
+		result = check_stats(&dev_high, 0);
+	}
+
+	if (result == TC_PASS) {
+		result = check_stats(&dev_low, 1);
+	}
+
+	if (result == TC_PASS &&
+	    sensor_trigger_stats_get(&dev_none, &stats) != -ENODEV) {
+		TC_ERROR("Statistics of an unknown device\n");
+		result = TC_FAIL;
+	}
+
+	TC_END_REPORT(result);
+}
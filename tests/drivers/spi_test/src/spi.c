@@ -20,6 +20,7 @@
 #include <string.h>
 #include <spi.h>
 #include <misc/printk.h>
+#include <misc/util.h>
 
 
 
@@ -64,6 +65,48 @@ static void _spi_show(struct spi_config *spi_conf)
 	printk("\tMax speed Hz: 0x%X\n", spi_conf->max_sys_freq);
 }
 
+#ifdef CONFIG_SPI_ASYNC
+static struct nano_sem async_done;
+static int async_status;
+
+static void async_callback(struct device *dev, int status, void *user_data)
+{
+	async_status = status;
+	nano_sem_give(&async_done);
+}
+
+static void spi_async_test(struct device *spi)
+{
+	static unsigned char cmd[4] = { 0x03, 0x00, 0x00, 0x00 };
+	static unsigned char data[16];
+	struct spi_msg msgs[] = {
+		{ .tx_buf = cmd, .tx_len = sizeof(cmd) },
+		{ .rx_buf = data, .rx_len = sizeof(data) },
+	};
+	struct spi_transaction trans = {
+		.config = &spi_conf,
+		.slave = SPI_SLAVE,
+		.msgs = msgs,
+		.num_msgs = ARRAY_SIZE(msgs),
+		.callback = async_callback,
+	};
+
+	nano_sem_init(&async_done);
+
+	printk("Queueing a command and read...\n");
+
+	if (spi_transceive_async(spi, &trans)) {
+		printk("Queueing failed\n");
+		return;
+	}
+
+	nano_sem_take(&async_done, TICKS_UNLIMITED);
+
+	printk("SPI transaction done (%d)\n", async_status);
+	print_buf_hex(data, sizeof(data));
+}
+#endif
+
 void main(void)
 {
 	struct device *spi;
@@ -90,4 +133,8 @@ void main(void)
 
 	printk("SPI transceived: %s\n", rbuf);
 	print_buf_hex(rbuf, 6);
+
+#ifdef CONFIG_SPI_ASYNC
+	spi_async_test(spi);
+#endif
 }
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Asynchronous UART API test
+ *
+ * The UART is put in loopback mode, so what uart_async_tx() sends comes
+ * back to the ring buffer given to uart_async_rx_enable().
+ */
+
+#include <string.h>
+
+#include <nanokernel.h>
+#include <uart.h>
+#include <soc.h>
+
+#include <tc_util.h>
+
+#define UART_DEV "UART_1"
+#define UART_MCR (UART_NS16550_PORT_1_BASE_ADDR + 4)
+#define MCR_LOOP 0x10
+
+#define DATA_LEN 100
+#define RING_SIZE 128
+#define SMALL_RING_SIZE 32
+#define THRESHOLD 16
+
+#define WAIT_TICKS (sys_clock_ticks_per_sec / 2)
+
+static uint8_t tx_data[DATA_LEN];
+static uint8_t rx_data[DATA_LEN];
+static uint8_t ring[RING_SIZE];
+
+static struct nano_sem tx_done;
+static struct nano_sem rx_ready;
+static volatile uint32_t events_seen;
+
+static void async_cb(struct device *dev, uint32_t events)
+{
+	events_seen |= events;
+
+	if (events & UART_ASYNC_TX_DONE) {
+		nano_isr_sem_give(&tx_done);
+	}
+
+	if (events & (UART_ASYNC_RX_READY | UART_ASYNC_RX_IDLE)) {
+		nano_isr_sem_give(&rx_ready);
+	}
+}
+
+static int send(struct device *dev, uint32_t len)
+{
+	int ret;
+
+	ret = uart_async_tx(dev, tx_data, len);
+	if (ret) {
+		TC_ERROR("Send failed (%d)\n", ret);
+		return TC_FAIL;
+	}
+
+	if (uart_async_tx(dev, tx_data, len) != -EBUSY) {
+		TC_ERROR("Sent a buffer while another one was sent\n");
+		return TC_FAIL;
+	}
+
+	if (!nano_task_sem_take(&tx_done, WAIT_TICKS)) {
+		TC_ERROR("UART_ASYNC_TX_DONE not reported\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/* Reads until @a len bytes came in, or the line stays quiet */
+static int receive(struct device *dev, uint32_t len)
+{
+	uint32_t received = 0;
+	int ret;
+
+	while (received < len) {
+		ret = uart_async_read(dev, rx_data + received,
+				      len - received);
+		if (ret < 0) {
+			TC_ERROR("Read failed (%d)\n", ret);
+			return -1;
+		}
+
+		received += ret;
+
+		if (!ret && !nano_task_sem_take(&rx_ready, WAIT_TICKS)) {
+			break;
+		}
+	}
+
+	return received;
+}
+
+static int test_loopback(struct device *dev)
+{
+	struct uart_async_stats stats;
+	int i;
+
+	if (uart_async_tx(dev, tx_data, 0) != -EINVAL) {
+		TC_ERROR("Sent an empty buffer\n");
+		return TC_FAIL;
+	}
+
+	if (uart_async_rx_enable(dev, ring, RING_SIZE, THRESHOLD)) {
+		TC_ERROR("Cannot enable reception\n");
+		return TC_FAIL;
+	}
+
+	if (send(dev, DATA_LEN) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	if (receive(dev, DATA_LEN) != DATA_LEN) {
+		TC_ERROR("Not all the data came back\n");
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < DATA_LEN; i++) {
+		if (rx_data[i] != tx_data[i]) {
+			TC_ERROR("Byte %d is 0x%02x, sent 0x%02x\n", i,
+				 rx_data[i], tx_data[i]);
+			return TC_FAIL;
+		}
+	}
+
+	uart_async_stats_get(dev, &stats);
+
+	TC_PRINT("%u bytes out, %u in, %u interrupts, %u callbacks\n",
+		 stats.tx_bytes, stats.rx_bytes, stats.interrupts,
+		 stats.callbacks);
+
+	if (stats.tx_bytes != DATA_LEN || stats.rx_bytes != DATA_LEN ||
+	    stats.rx_dropped) {
+		TC_ERROR("Wrong byte counters\n");
+		return TC_FAIL;
+	}
+
+	/* The FIFOs are serviced whole, not a byte per interrupt */
+	if (stats.interrupts >= DATA_LEN ||
+	    stats.callbacks > stats.interrupts || !stats.callbacks) {
+		TC_ERROR("Wrong interrupt or callback counters\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int test_overflow(struct device *dev)
+{
+	struct uart_async_stats before, after;
+	int received;
+
+	/* The ring keeps the oldest bytes, the newer ones are dropped */
+	if (uart_async_rx_enable(dev, ring, SMALL_RING_SIZE,
+				 SMALL_RING_SIZE)) {
+		TC_ERROR("Cannot enable reception\n");
+		return TC_FAIL;
+	}
+
+	uart_async_stats_get(dev, &before);
+	events_seen = 0;
+
+	if (send(dev, DATA_LEN) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* Let the last bytes come back */
+	task_sleep(WAIT_TICKS);
+
+	uart_async_stats_get(dev, &after);
+
+	if (!(events_seen & UART_ASYNC_RX_OVERFLOW) ||
+	    after.rx_dropped - before.rx_dropped !=
+	    DATA_LEN - SMALL_RING_SIZE) {
+		TC_ERROR("%u bytes dropped, overflow %sreported\n",
+			 after.rx_dropped - before.rx_dropped,
+			 events_seen & UART_ASYNC_RX_OVERFLOW ? "" : "not ");
+		return TC_FAIL;
+	}
+
+	received = receive(dev, DATA_LEN);
+	if (received != SMALL_RING_SIZE ||
+	    memcmp(rx_data, tx_data, SMALL_RING_SIZE)) {
+		TC_ERROR("Ring buffer does not hold the first bytes\n");
+		return TC_FAIL;
+	}
+
+	uart_async_rx_disable(dev);
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *dev;
+	int result;
+	int i;
+
+	TC_START("Test asynchronous UART API");
+
+	nano_sem_init(&tx_done);
+	nano_sem_init(&rx_ready);
+
+	for (i = 0; i < DATA_LEN; i++) {
+		tx_data[i] = i * 7 + 1;
+	}
+
+	dev = device_get_binding(UART_DEV);
+	if (!dev) {
+		TC_ERROR("Cannot get %s\n", UART_DEV);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	sys_out8(sys_in8(UART_MCR) | MCR_LOOP, UART_MCR);
+
+	if (uart_async_callback_set(dev, async_cb)) {
+		TC_ERROR("No asynchronous API\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	result = test_loopback(dev);
+
+	if (result == TC_PASS) {
+		result = test_overflow(dev);
+	}
+
+	uart_async_callback_set(dev, NULL);
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief FAT flash disk benchmark
+ *
+ * Measures write throughput and write amplification of the FAT file system
+ * on flash, with the counters of whichever of the flash translation layer,
+ * sector cache and flash simulator are enabled.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <fs.h>
+#include <fs/fat_diskio.h>
+#ifdef CONFIG_FLASH_SIMULATOR
+#include <drivers/flash_simulator.h>
+#endif
+
+#include <tc_util.h>
+
+#define TEST_FILE "ftlbench.bin"
+
+#define CHUNK_SIZE 512
+/* Chunks in the file, rewritten ROUNDS times */
+#define CHUNK_COUNT 16
+#define ROUNDS 8
+
+static uint8_t chunk[CHUNK_SIZE];
+
+static void fill_chunk(int index, int round)
+{
+	int i;
+
+	for (i = 0; i < CHUNK_SIZE; i++) {
+		chunk[i] = (uint8_t)(i + index * 3 + round * 7);
+	}
+}
+
+/* Counters at the start of the measurement */
+struct bench_stats {
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+	struct fat_flash_ftl_stats ftl;
+#endif
+#ifdef CONFIG_FLASH_SIMULATOR
+	struct flash_simulator_stats sim;
+#endif
+	uint32_t ticks;
+};
+
+static void bench_start(struct bench_stats *start)
+{
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+	fat_flash_ftl_get_stats(&start->ftl);
+#endif
+#ifdef CONFIG_FLASH_SIMULATOR
+	flash_simulator_get_stats(
+		device_get_binding(CONFIG_FLASH_SIMULATOR_DEV_NAME),
+		&start->sim);
+#endif
+	start->ticks = sys_tick_get_32();
+}
+
+static void print_stats(const char *phase, const struct bench_stats *start,
+			uint32_t bytes)
+{
+	uint32_t ticks = sys_tick_get_32() - start->ticks;
+
+	if (!ticks) {
+		ticks = 1;
+	}
+
+	TC_PRINT("%s: %u bytes in %u ticks, %u bytes/s\n", phase, bytes,
+		 ticks, (uint32_t)((uint64_t)bytes * sys_clock_ticks_per_sec /
+				   ticks));
+
+#ifdef CONFIG_FS_FAT_FLASH_FTL
+	{
+		struct fat_flash_ftl_stats now;
+		uint32_t host, flash;
+
+		fat_flash_ftl_get_stats(&now);
+
+		host = now.host_writes - start->ftl.host_writes;
+		flash = now.flash_writes - start->ftl.flash_writes;
+
+		TC_PRINT("%s: FTL %u sectors written, %u programmed, "
+			 "%u moved by GC, write amplification %u.%02u\n",
+			 phase, host, flash,
+			 now.gc_moves - start->ftl.gc_moves,
+			 host ? flash / host : 0,
+			 host ? (flash * 100 / host) % 100 : 0);
+		TC_PRINT("%s: FTL %u erases, erase count %u..%u, "
+			 "%u free blocks\n", phase,
+			 now.erases - start->ftl.erases, now.min_erase_count,
+			 now.max_erase_count, now.free_blocks);
+	}
+#endif
+
+#ifdef CONFIG_FLASH_SIMULATOR
+	{
+		struct flash_simulator_stats now;
+		uint32_t programmed;
+
+		flash_simulator_get_stats(
+			device_get_binding(CONFIG_FLASH_SIMULATOR_DEV_NAME),
+			&now);
+
+		programmed = now.bytes_written - start->sim.bytes_written;
+
+		TC_PRINT("%s: flash %u bytes programmed (%u.%02u per byte "
+			 "written), %u erases, erase count %u..%u\n", phase,
+			 programmed, programmed / bytes,
+			 (uint32_t)((uint64_t)programmed * 100 / bytes) % 100,
+			 now.erases - start->sim.erases,
+			 now.min_erase_count, now.max_erase_count);
+	}
+#endif
+
+#ifdef CONFIG_FS_FAT_FLASH_CACHE
+	{
+		struct fat_flash_cache_stats cache;
+
+		fat_flash_cache_get_stats(&cache);
+
+		TC_PRINT("%s: cache %u hits, %u misses, %u evictions, "
+			 "%u block writes\n", phase, cache.hits,
+			 cache.misses, cache.evictions, cache.block_writes);
+	}
+#endif
+}
+
+static int write_rounds(ZFILE *fp)
+{
+	struct bench_stats start;
+	int round, i;
+
+	bench_start(&start);
+
+	for (round = 0; round < ROUNDS; round++) {
+		if (fs_seek(fp, 0, SEEK_SET)) {
+			TC_ERROR("Seek failed\n");
+			return TC_FAIL;
+		}
+
+		for (i = 0; i < CHUNK_COUNT; i++) {
+			fill_chunk(i, round);
+
+			if (fs_write(fp, chunk, CHUNK_SIZE) != CHUNK_SIZE) {
+				TC_ERROR("Write failed\n");
+				return TC_FAIL;
+			}
+
+			/* Commit FAT and directory entry every time */
+			if (fs_sync(fp)) {
+				TC_ERROR("Sync failed\n");
+				return TC_FAIL;
+			}
+		}
+	}
+
+	print_stats("Rewrite", &start, ROUNDS * CHUNK_COUNT * CHUNK_SIZE);
+
+	return TC_PASS;
+}
+
+static int verify(ZFILE *fp)
+{
+	static uint8_t expected[CHUNK_SIZE];
+	int i;
+
+	if (fs_seek(fp, 0, SEEK_SET)) {
+		TC_ERROR("Seek failed\n");
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < CHUNK_COUNT; i++) {
+		fill_chunk(i, ROUNDS - 1);
+		memcpy(expected, chunk, CHUNK_SIZE);
+
+		if (fs_read(fp, chunk, CHUNK_SIZE) != CHUNK_SIZE ||
+		    memcmp(chunk, expected, CHUNK_SIZE)) {
+			TC_ERROR("Data mismatch in chunk %d\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	ZFILE fp;
+	int result;
+
+	TC_START("FAT flash disk benchmark");
+
+	if (fs_open(&fp, TEST_FILE)) {
+		TC_ERROR("Cannot open %s\n", TEST_FILE);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	result = write_rounds(&fp);
+	if (result == TC_PASS) {
+		result = verify(&fp);
+	}
+
+	fs_close(&fp);
+	fs_unlink(TEST_FILE);
+
+	TC_END_REPORT(result);
+}
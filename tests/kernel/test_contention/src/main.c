@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Mutex, semaphore and fifo contention statistics test
+ *
+ * A higher priority thread waits on a mutex held by the main thread, then
+ * on a semaphore and a fifo the main thread gives and puts to after a
+ * sleep. Checks the acquisitions, contentions, waits and hold time
+ * accounted to each object.
+ */
+
+#include <kernel.h>
+
+#include <tc_util.h>
+
+#define SLEEP_MS 10
+#define STACK_SIZE 512
+#define MAX_OBJS 16
+
+static char __stack waiter_stack[STACK_SIZE];
+
+/* statically defined objects are listed on first use */
+static K_MUTEX_DEFINE(mutex);
+static K_FIFO_DEFINE(fifo);
+
+static struct k_sem sem;
+
+static struct k_contention objs[MAX_OBJS];
+
+static void waiter_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	k_mutex_lock(&mutex, K_FOREVER);
+	k_mutex_unlock(&mutex);
+
+	k_sem_take(&sem, K_FOREVER);
+
+	k_fifo_get(&fifo, K_FOREVER);
+}
+
+static struct k_contention_stats *find_obj(void *obj)
+{
+	int count, i;
+
+	count = k_contention_stats_all_get(objs, MAX_OBJS);
+
+	for (i = 0; i < count && i < MAX_OBJS; i++) {
+		if (objs[i].obj == obj) {
+			return &objs[i].stats;
+		}
+	}
+
+	return NULL;
+}
+
+static int check_obj(const char *name, void *obj, uint32_t acquisitions,
+		     uint32_t contended)
+{
+	struct k_contention_stats *stats = find_obj(obj);
+
+	if (!stats) {
+		TC_ERROR("%s not listed\n", name);
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%s: %u acquisitions, %u contended, %u cycles waited, "
+		 "max wait %u, max hold %u\n", name, stats->acquisitions,
+		 stats->contended, (uint32_t)stats->total_wait,
+		 stats->max_wait, stats->max_hold);
+
+	if (stats->acquisitions != acquisitions ||
+	    stats->contended != contended || !stats->max_wait ||
+	    stats->total_wait < stats->max_wait) {
+		TC_ERROR("%s statistics wrong\n", name);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	static char item[8];
+	int result = TC_PASS;
+
+	TC_START("Contention statistics");
+
+	k_sem_init(&sem, 0, 1);
+
+	k_mutex_lock(&mutex, K_FOREVER);
+
+	/* the waiter preempts the main thread and blocks on the mutex */
+	k_thread_spawn(waiter_stack, STACK_SIZE, waiter_entry, NULL, NULL, NULL,
+		       K_PRIO_PREEMPT(0), 0, 0);
+
+	k_sleep(SLEEP_MS);
+	k_mutex_unlock(&mutex);
+
+	/* not available to the main thread either */
+	k_sem_take(&sem, K_NO_WAIT);
+
+	k_sleep(SLEEP_MS);
+	k_sem_give(&sem);
+
+	k_sleep(SLEEP_MS);
+	k_fifo_put(&fifo, item);
+
+	if (check_obj("mutex", &mutex, 2, 1) != TC_PASS ||
+	    check_obj("sem", &sem, 1, 2) != TC_PASS ||
+	    check_obj("fifo", &fifo, 1, 1) != TC_PASS) {
+		result = TC_FAIL;
+	}
+
+	if (result == TC_PASS && !find_obj(&mutex)->max_hold) {
+		TC_ERROR("Mutex hold time not measured\n");
+		result = TC_FAIL;
+	}
+
+	k_contention_stats_reset();
+
+	if (result == TC_PASS && find_obj(&sem)->contended) {
+		TC_ERROR("Statistics not reset\n");
+		result = TC_FAIL;
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief 64-bit cycle count test
+ *
+ * Checks that sys_cycle_get_64() is monotonic across ticks and agrees with
+ * sys_cycle_get_32(), and that the conversions to nanoseconds and
+ * microseconds hold over a year of cycles.
+ */
+
+#include <zephyr.h>
+
+#include <tc_util.h>
+
+#define TICKS 5
+
+/* a year, long past any wrap of the 32-bit cycle count */
+#define YEAR_SEC (365ULL * 24 * 60 * 60)
+
+static int check_monotonic(void)
+{
+	uint32_t start_tick = sys_tick_get_32();
+	uint64_t prev, now;
+	int reads = 0;
+
+	prev = sys_cycle_get_64();
+
+	while (sys_tick_get_32() - start_tick < TICKS) {
+		now = sys_cycle_get_64();
+		if (now < prev) {
+			TC_ERROR("Cycle count went back after %d reads\n",
+				 reads);
+			return TC_FAIL;
+		}
+		prev = now;
+		reads++;
+	}
+
+	TC_PRINT("%d reads over %d ticks\n", reads, TICKS);
+
+	return TC_PASS;
+}
+
+static int check_low_word(void)
+{
+	uint64_t cycles_64 = sys_cycle_get_64();
+	uint32_t cycles_32 = sys_cycle_get_32();
+
+	if (cycles_32 - (uint32_t)cycles_64 >
+	    (uint32_t)sys_clock_hw_cycles_per_tick) {
+		TC_ERROR("64-bit count %u, 32-bit count %u\n",
+			 (uint32_t)cycles_64, cycles_32);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int check_conversion(uint64_t secs)
+{
+	uint64_t cycles = secs * sys_clock_hw_cycles_per_sec;
+	/* the 32.32 factor is exact to 2^-32 of a unit per cycle */
+	uint64_t error = (cycles >> 32) + 2;
+	uint64_t ns = sys_clock_cycles_to_ns64(cycles);
+	uint64_t us = sys_clock_cycles_to_us64(cycles);
+
+	if (ns > secs * NSEC_PER_SEC || ns + error < secs * NSEC_PER_SEC ||
+	    us > secs * USEC_PER_SEC || us + error < secs * USEC_PER_SEC) {
+		TC_ERROR("%u seconds of cycles converted to %u ms\n",
+			 (uint32_t)secs,
+			 (uint32_t)(us / USEC_PER_MSEC));
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("64-bit cycle count");
+
+	result = check_monotonic();
+
+	if (result == TC_PASS) {
+		result = check_low_word();
+	}
+
+	if (result == TC_PASS) {
+		result = check_conversion(1);
+	}
+
+	if (result == TC_PASS) {
+		result = check_conversion(YEAR_SEC);
+	}
+
+	TC_END_REPORT(result);
+}
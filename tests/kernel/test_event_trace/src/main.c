@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Kernel event trace test
+ *
+ * Has a task and a fiber hand a semaphore and a FIFO item to each other,
+ * checks the context switch and object records they leave in the trace
+ * buffer and prints them for scripts/trace_decode.py. Then checks the drop
+ * counter and reports the cycles taken to record an event against a kernel
+ * event logger put.
+ */
+
+#include <zephyr.h>
+#include <misc/kernel_event_logger.h>
+
+#include <tc_util.h>
+
+#define TRACE_SIZE CONFIG_KERNEL_EVENT_LOGGER_TRACE_BUFFER_SIZE
+#define BENCH_EVENTS 32
+
+#define TEST_EVENT_ID 255
+
+#define FIBER_PRIORITY 5
+#define FIBER_STACK_SIZE 512
+
+static char __stack fiber_stack[FIBER_STACK_SIZE];
+
+static struct nano_sem sem;
+static struct nano_fifo fifo;
+static void *fifo_item[2];
+
+static struct sys_k_event_trace_record records[TRACE_SIZE];
+
+struct expected_record {
+	uint16_t event_id;
+	uint16_t data;
+	void *thread;
+	void *object;
+};
+
+static void fiber_entry(int arg1, int arg2)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	nano_fiber_sem_take(&sem, TICKS_UNLIMITED);
+	nano_fiber_fifo_put(&fifo, fifo_item);
+}
+
+static void drain(void)
+{
+	while (sys_k_event_trace_get(records, TRACE_SIZE)) {
+	}
+}
+
+static void print_records(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		TC_PRINT("%08x %04x %04x %08x %08x\n", records[i].timestamp,
+			 records[i].event_id, records[i].data,
+			 records[i].thread, records[i].object);
+	}
+}
+
+static int check_handoff(void)
+{
+	nano_thread_id_t task = sys_thread_self_get();
+	nano_thread_id_t fiber;
+	uint32_t last = 0;
+	int count, i, n = 0;
+
+	drain();
+
+	fiber = task_fiber_start(fiber_stack, FIBER_STACK_SIZE, fiber_entry,
+				 0, 0, FIBER_PRIORITY, 0);
+	nano_task_sem_give(&sem);
+	nano_task_fifo_get(&fifo, TICKS_NONE);
+
+	/* records left by the handoff, in order, interrupts aside */
+	const struct expected_record expected[] = {
+		{ KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, 0, task, 0 },
+		{ KERNEL_EVENT_LOGGER_SEM_TAKE_EVENT_ID, 1, fiber, &sem },
+		{ KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, 0, fiber, 0 },
+		{ KERNEL_EVENT_LOGGER_SEM_GIVE_EVENT_ID, 0, task, &sem },
+		{ KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, 0, task, 0 },
+		{ KERNEL_EVENT_LOGGER_FIFO_PUT_EVENT_ID, 0, fiber, &fifo },
+		{ KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, 0, fiber, 0 },
+		{ KERNEL_EVENT_LOGGER_FIFO_GET_EVENT_ID, 0, task, &fifo },
+	};
+
+	count = sys_k_event_trace_get(records, TRACE_SIZE);
+	print_records(count);
+
+	for (i = 0; i < count && n < ARRAY_SIZE(expected); i++) {
+		if (records[i].event_id ==
+		    KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID) {
+			continue;
+		}
+
+		if (records[i].event_id != expected[n].event_id ||
+		    records[i].data != expected[n].data ||
+		    records[i].thread != (uint32_t)expected[n].thread ||
+		    records[i].object != (uint32_t)expected[n].object) {
+			TC_ERROR("Record %d does not match event %d\n", i, n);
+			return TC_FAIL;
+		}
+
+		if (n && records[i].timestamp - last > 0x7fffffff) {
+			TC_ERROR("Record %d goes back in time\n", i);
+			return TC_FAIL;
+		}
+
+		last = records[i].timestamp;
+		n++;
+	}
+
+	if (n != ARRAY_SIZE(expected)) {
+		TC_ERROR("Found %d of %d events\n", n,
+			 (int)ARRAY_SIZE(expected));
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int check_dropped(void)
+{
+	uint32_t dropped;
+	int i;
+
+	drain();
+	dropped = sys_k_event_trace_dropped_get();
+
+	for (i = 0; i < TRACE_SIZE + 8; i++) {
+		nano_task_sem_give(&sem);
+	}
+
+	if (sys_k_event_trace_get(records, TRACE_SIZE) != TRACE_SIZE ||
+	    sys_k_event_trace_dropped_get() - dropped < 8) {
+		TC_ERROR("Full trace buffer did not drop records\n");
+		return TC_FAIL;
+	}
+
+	drain();
+	nano_task_sem_give(&sem);
+
+	if (!sys_k_event_trace_get(records, 1) ||
+	    records[0].event_id != KERNEL_EVENT_LOGGER_SEM_GIVE_EVENT_ID) {
+		TC_ERROR("Nothing recorded after the buffer was drained\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static void bench(void)
+{
+	uint32_t data[2] = { 0, 0 };
+	uint32_t start, trace, logger;
+	int i;
+
+	drain();
+
+	start = sys_cycle_get_32();
+	for (i = 0; i < BENCH_EVENTS; i++) {
+		_sys_k_event_trace(TEST_EVENT_ID, 0, 0);
+	}
+	trace = sys_cycle_get_32() - start;
+
+	start = sys_cycle_get_32();
+	for (i = 0; i < BENCH_EVENTS; i++) {
+		sys_k_event_logger_put(TEST_EVENT_ID, data, ARRAY_SIZE(data));
+	}
+	logger = sys_cycle_get_32() - start;
+
+	drain();
+
+	TC_PRINT("Trace record: %u cycles, event logger put: %u cycles\n",
+		 trace / BENCH_EVENTS, logger / BENCH_EVENTS);
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("Kernel event trace");
+
+	nano_sem_init(&sem);
+	nano_fifo_init(&fifo);
+
+	result = check_handoff();
+
+	if (result == TC_PASS) {
+		result = check_dropped();
+	}
+
+	if (result == TC_PASS) {
+		bench();
+	}
+
+	TC_END_REPORT(result);
+}
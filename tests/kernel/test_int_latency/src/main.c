@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Interrupt service statistics and latency histograms test
+ *
+ * Busy waits for a few system clock ticks, then keeps interrupts locked for a
+ * known time. Checks the timer interrupt is accounted, and that the
+ * longest interrupt lock is the one of the test, then prints the
+ * statistics and histograms.
+ */
+
+#include <zephyr.h>
+#include <misc/util.h>
+#include <misc/int_latency.h>
+
+#include <tc_util.h>
+
+#define TICKS 10
+#define LOCK_US 1000
+
+static void lock_interrupts(void)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	sys_thread_busy_wait(LOCK_US);
+	irq_unlock(key);
+}
+
+static int check_irqs(void)
+{
+	struct int_latency_irq_stats irqs[CONFIG_INT_LATENCY_STATS_IRQS];
+	int count, i;
+
+	count = int_latency_irq_stats_get(irqs, ARRAY_SIZE(irqs));
+
+	for (i = 0; i < count; i++) {
+		if (irqs[i].count >= TICKS - 1 && irqs[i].max_cycles &&
+		    irqs[i].cycles >= irqs[i].max_cycles) {
+			return TC_PASS;
+		}
+	}
+
+	TC_ERROR("Timer interrupt not accounted\n");
+	return TC_FAIL;
+}
+
+static int check_lock(void)
+{
+	struct int_latency_hist hist;
+	uint32_t worst, min;
+	void *lock_caller;
+	int i, samples = 0;
+
+	lock_caller = int_latency_worst_lock_get(&worst);
+	min = (uint32_t)((uint64_t)LOCK_US * sys_clock_hw_cycles_per_sec /
+			 USEC_PER_SEC);
+
+	TC_PRINT("Longest lock %u cycles at %p, lock_interrupts() at %p\n",
+		 worst, lock_caller, lock_interrupts);
+
+	if (worst < min ||
+	    (char *)lock_caller < (char *)lock_interrupts ||
+	    (char *)lock_caller > (char *)lock_interrupts + 64) {
+		TC_ERROR("Longest lock not the one of the test\n");
+		return TC_FAIL;
+	}
+
+	int_latency_hist_get(INT_LATENCY_HIST_LOCK, &hist);
+
+	for (i = 0; i < INT_LATENCY_HIST_BUCKETS; i++) {
+		samples += hist.count[i];
+	}
+
+	if (!samples || !hist.count[31 - __builtin_clz(worst)]) {
+		TC_ERROR("Lock histogram wrong\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("Interrupt statistics");
+
+	int_latency_init();
+
+	/* the timer interrupts keep coming while busy */
+	sys_thread_busy_wait(TICKS * USEC_PER_SEC / sys_clock_ticks_per_sec);
+
+	lock_interrupts();
+
+	result = check_irqs();
+	if (result == TC_PASS) {
+		result = check_lock();
+	}
+
+	int_latency_stats_show();
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Deferred logging test
+ *
+ * Checks the output of deferred log calls and the drop counter, and
+ * reports the cycles a log call takes against a printk() of the same
+ * message. The test runs in a fiber so the output fiber only runs when
+ * the test flushes the log.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <misc/log_deferred.h>
+
+#include <tc_util.h>
+
+#define BUF_SZ 1024
+#define BENCH_CALLS 32
+
+/* Words in the log buffer, a message without arguments takes two */
+#define LOG_WORDS (CONFIG_LOG_DEFERRED_BUF_SIZE / 4)
+
+#define FIBER_PRIORITY 5
+#define FIBER_STACK_SIZE 1024
+
+static char __stack fiber_stack[FIBER_STACK_SIZE];
+static struct nano_sem result_sem;
+static int result;
+
+static int pos;
+static char ram_console[BUF_SZ];
+
+extern int (*_char_out)(int);
+static int (*old_char_out)(int);
+
+static int ram_console_out(int character)
+{
+	if (pos < BUF_SZ - 1) {
+		ram_console[pos++] = (char)character;
+		ram_console[pos] = '\0';
+	}
+
+	return character;
+}
+
+static void capture_start(void)
+{
+	pos = 0;
+	ram_console[0] = '\0';
+	_char_out = ram_console_out;
+}
+
+static void capture_stop(void)
+{
+	_char_out = old_char_out;
+}
+
+static int check_output(void)
+{
+	static const char expected[] = "-5 7 0000beef str z\n"
+		"no arguments\n";
+	int count;
+
+	capture_start();
+
+	LOG_DEFERRED("%d %u %x %s %c\n", -5, 7, 0xbeef, "str", 'z');
+	LOG_DEFERRED("no arguments\n");
+
+	/* nothing is output until the log is flushed */
+	if (pos) {
+		capture_stop();
+		TC_ERROR("Output before flush\n");
+		return TC_FAIL;
+	}
+
+	count = log_deferred_flush();
+	capture_stop();
+
+	if (count != 2 || strcmp(ram_console, expected)) {
+		TC_ERROR("Flushed %d messages: %s\n", count, ram_console);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int check_drops(void)
+{
+	struct log_deferred_stats before, after;
+	int i, count;
+
+	log_deferred_stats_get(&before);
+	capture_start();
+
+	/* twice what fits */
+	for (i = 0; i < LOG_WORDS; i++) {
+		LOG_DEFERRED("x");
+	}
+
+	log_deferred_stats_get(&after);
+	count = log_deferred_flush();
+	capture_stop();
+
+	if (after.logged - before.logged != LOG_WORDS / 2 ||
+	    after.dropped - before.dropped != LOG_WORDS / 2 ||
+	    count != LOG_WORDS / 2) {
+		TC_ERROR("Logged %u, dropped %u, flushed %d\n",
+			 after.logged - before.logged,
+			 after.dropped - before.dropped, count);
+		return TC_FAIL;
+	}
+
+	if (!strstr(ram_console, "log messages dropped")) {
+		TC_ERROR("Drops not reported\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static void benchmark(void)
+{
+	uint32_t start, deferred, direct;
+	int i;
+
+	start = sys_cycle_get_32();
+	for (i = 0; i < BENCH_CALLS; i++) {
+		LOG_DEFERRED("log call %d of %d at %x\n", i, BENCH_CALLS,
+			     start);
+	}
+	deferred = sys_cycle_get_32() - start;
+
+	log_deferred_flush();
+
+	start = sys_cycle_get_32();
+	for (i = 0; i < BENCH_CALLS; i++) {
+		printk("log call %d of %d at %x\n", i, BENCH_CALLS, start);
+	}
+	direct = sys_cycle_get_32() - start;
+
+	TC_PRINT("Deferred log call: %u cycles\n", deferred / BENCH_CALLS);
+	TC_PRINT("printk call: %u cycles\n", direct / BENCH_CALLS);
+}
+
+static void test_fiber(int arg1, int arg2)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	/* messages logged during boot */
+	log_deferred_flush();
+
+	result = check_output();
+
+	if (result == TC_PASS) {
+		result = check_drops();
+	}
+
+	if (result == TC_PASS) {
+		benchmark();
+	}
+
+	nano_fiber_sem_give(&result_sem);
+}
+
+void main(void)
+{
+	TC_START("Test deferred logging");
+
+	old_char_out = _char_out;
+	nano_sem_init(&result_sem);
+
+	task_fiber_start(fiber_stack, FIBER_STACK_SIZE, test_fiber, 0, 0,
+			 FIBER_PRIORITY, 0);
+
+	nano_task_sem_take(&result_sem, TICKS_UNLIMITED);
+
+	TC_END_RESULT(result);
+	TC_END_REPORT(result);
+}
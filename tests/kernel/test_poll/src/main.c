@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief k_poll() test
+ *
+ * Polls a semaphore, a fifo and a signal at once. Checks that the poll
+ * reports the objects already ready, times out when none gets ready, is
+ * woken up by whichever object a thread makes ready and tells which one,
+ * and that a second thread cannot poll an object already being polled.
+ */
+
+#include <kernel.h>
+#include <misc/util.h>
+
+#include <tc_util.h>
+
+#define STACK_SIZE 512
+#define HELPER_PRIO K_PRIO_PREEMPT(5)
+
+#define TIMEOUT_MS 50
+/* delay of the helper thread, well within TIMEOUT_MS */
+#define DELAY_MS 20
+
+#define SEM_EVENT 0
+#define FIFO_EVENT 1
+#define SIGNAL_EVENT 2
+#define NUM_EVENTS 3
+
+static char __stack helper_stack[STACK_SIZE];
+
+static K_SEM_DEFINE(sem, 0, 1);
+static K_FIFO_DEFINE(fifo);
+static struct k_poll_signal sig = K_POLL_SIGNAL_INITIALIZER();
+
+static struct k_poll_event events[NUM_EVENTS] = {
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE, &sem),
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_FIFO_DATA_AVAILABLE, &fifo),
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL, &sig),
+};
+
+static const uint32_t ready_states[NUM_EVENTS] = {
+	K_POLL_STATE_SEM_AVAILABLE,
+	K_POLL_STATE_FIFO_DATA_AVAILABLE,
+	K_POLL_STATE_SIGNALED,
+};
+
+static struct fifo_item {
+	void *fifo_reserved;
+} item;
+
+static volatile int helper_rc;
+static volatile uint32_t helper_state;
+
+static void make_ready(int which)
+{
+	switch (which) {
+	case SEM_EVENT:
+		k_sem_give(&sem);
+		break;
+	case FIFO_EVENT:
+		k_fifo_put(&fifo, &item);
+		break;
+	default:
+		k_poll_signal(&sig, 0x1234);
+		break;
+	}
+}
+
+static void consume(int which)
+{
+	switch (which) {
+	case SEM_EVENT:
+		k_sem_take(&sem, K_NO_WAIT);
+		break;
+	case FIFO_EVENT:
+		k_fifo_get(&fifo, K_NO_WAIT);
+		break;
+	default:
+		sig.signaled = 0;
+		break;
+	}
+}
+
+static int check_states(int which)
+{
+	int i;
+
+	for (i = 0; i < NUM_EVENTS; i++) {
+		uint32_t expected = i == which ? ready_states[i] :
+				    K_POLL_STATE_NOT_READY;
+
+		if (events[i].state != expected) {
+			TC_ERROR("Event %d in state %u, expected %u\n", i,
+				 events[i].state, expected);
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+static void make_ready_entry(void *which, void *p2, void *p3)
+{
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	make_ready((int)which);
+}
+
+static int test_ready(void)
+{
+	int which, rc;
+
+	if (k_poll(events, NUM_EVENTS, K_NO_WAIT) != -EAGAIN) {
+		TC_ERROR("Poll found an event ready\n");
+		return TC_FAIL;
+	}
+
+	for (which = 0; which < NUM_EVENTS; which++) {
+		make_ready(which);
+
+		rc = k_poll(events, NUM_EVENTS, K_NO_WAIT);
+		if (rc != 0) {
+			TC_ERROR("Poll for ready event %d returned %d\n",
+				 which, rc);
+			return TC_FAIL;
+		}
+
+		if (check_states(which) != TC_PASS) {
+			return TC_FAIL;
+		}
+
+		consume(which);
+	}
+
+	return TC_PASS;
+}
+
+static int test_timeout(void)
+{
+	int64_t start = k_uptime_get();
+	int rc;
+
+	rc = k_poll(events, NUM_EVENTS, TIMEOUT_MS);
+	if (rc != -EAGAIN) {
+		TC_ERROR("Poll returned %d instead of timing out\n", rc);
+		return TC_FAIL;
+	}
+
+	if (k_uptime_get() - start < TIMEOUT_MS) {
+		TC_ERROR("Poll timed out early\n");
+		return TC_FAIL;
+	}
+
+	if (sem.poll_event || fifo.poll_event || sig.poll_event) {
+		TC_ERROR("Events left registered after the timeout\n");
+		return TC_FAIL;
+	}
+
+	return check_states(-1);
+}
+
+static int test_wake(void)
+{
+	int which, rc;
+
+	for (which = 0; which < NUM_EVENTS; which++) {
+		k_thread_spawn(helper_stack, STACK_SIZE, make_ready_entry,
+			       (void *)which, NULL, NULL, HELPER_PRIO, 0,
+			       DELAY_MS);
+
+		rc = k_poll(events, NUM_EVENTS, TIMEOUT_MS);
+		if (rc != 0) {
+			TC_ERROR("Poll woken by event %d returned %d\n",
+				 which, rc);
+			return TC_FAIL;
+		}
+
+		if (check_states(which) != TC_PASS) {
+			return TC_FAIL;
+		}
+
+		if (which == SIGNAL_EVENT && sig.result != 0x1234) {
+			TC_ERROR("Signal result %d\n", sig.result);
+			return TC_FAIL;
+		}
+
+		consume(which);
+	}
+
+	return TC_PASS;
+}
+
+static void poll_sem_entry(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event event;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	k_poll_event_init(&event, K_POLL_TYPE_SEM_AVAILABLE, &sem);
+
+	helper_rc = k_poll(&event, 1, K_FOREVER);
+	helper_state = event.state;
+}
+
+static int test_busy(void)
+{
+	helper_rc = -1;
+
+	/* the helper runs, and polls the semaphore, while main sleeps */
+	k_thread_spawn(helper_stack, STACK_SIZE, poll_sem_entry, NULL, NULL,
+		       NULL, HELPER_PRIO, 0, 0);
+	k_sleep(DELAY_MS);
+
+	if (k_poll(events, NUM_EVENTS, K_FOREVER) != -EADDRINUSE ||
+	    events[SEM_EVENT].state != K_POLL_STATE_EADDRINUSE) {
+		TC_ERROR("Polled a semaphore another thread polls\n");
+		return TC_FAIL;
+	}
+
+	if (fifo.poll_event || sig.poll_event) {
+		TC_ERROR("Events left registered after the failed poll\n");
+		return TC_FAIL;
+	}
+
+	k_sem_give(&sem);
+	k_sleep(DELAY_MS);
+
+	if (helper_rc != 0 || helper_state != K_POLL_STATE_SEM_AVAILABLE) {
+		TC_ERROR("Poller returned %d, state %u\n", helper_rc,
+			 helper_state);
+		return TC_FAIL;
+	}
+
+	k_sem_take(&sem, K_NO_WAIT);
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("k_poll");
+
+	result = test_ready();
+
+	if (result == TC_PASS) {
+		result = test_timeout();
+	}
+
+	if (result == TC_PASS) {
+		result = test_wake();
+	}
+
+	if (result == TC_PASS) {
+		result = test_busy();
+	}
+
+	TC_END_REPORT(result);
+}
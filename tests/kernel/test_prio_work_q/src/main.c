@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Priority workqueue test
+ *
+ * Checks that items execute by priority and deadline, that a slow item
+ * only holds up one thread of a pool, that cancelled items do not execute,
+ * and that waits, execution times and missed deadlines are accounted.
+ */
+
+#include <kernel.h>
+#include <misc/util.h>
+
+#include <tc_util.h>
+
+#define STACK_SIZE 512
+#define WORKER_PRIO 5
+
+#define SLOW_MS 50
+/* long enough for the workers, at a lower priority, to run */
+#define SETTLE_MS 20
+
+#define NUM_ITEMS 5
+
+static char __stack single_stack[1][STACK_SIZE];
+static char __stack pool_stacks[2][STACK_SIZE];
+
+static struct k_prio_work_q single_q;
+static struct k_prio_work_q pool_q;
+
+static struct k_prio_work items[NUM_ITEMS];
+static int order[NUM_ITEMS];
+static int executed;
+
+static struct k_prio_work slow_item;
+static volatile int slow_done;
+
+static void record_handler(struct k_work *work)
+{
+	struct k_prio_work *item = CONTAINER_OF(work, struct k_prio_work, work);
+
+	order[executed++] = item - items;
+}
+
+static void slow_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	/* e.g. waiting for a flash write to complete */
+	k_sleep(SLOW_MS);
+	slow_done = 1;
+}
+
+static void start_queues(void)
+{
+	const struct k_thread_config single_config = {
+		.stack = single_stack[0],
+		.stack_size = STACK_SIZE,
+		.prio = WORKER_PRIO,
+	};
+	const struct k_thread_config pool_config = {
+		.stack = pool_stacks[0],
+		.stack_size = STACK_SIZE,
+		.prio = WORKER_PRIO,
+	};
+	int i;
+
+	k_prio_work_q_start(&single_q, &single_config, 1);
+	k_prio_work_q_start(&pool_q, &pool_config, ARRAY_SIZE(pool_stacks));
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		k_prio_work_init(&items[i], record_handler);
+	}
+	k_prio_work_init(&slow_item, slow_handler);
+}
+
+static int test_order(void)
+{
+	static const int expected[NUM_ITEMS] = { 2, 1, 3, 4, 0 };
+	int i;
+
+	/* the worker does not run until this thread sleeps */
+	executed = 0;
+	k_prio_work_submit(&single_q, &items[0], 2, K_FOREVER);
+	k_prio_work_submit(&single_q, &items[1], 0, 500);
+	k_prio_work_submit(&single_q, &items[2], 0, 100);
+	k_prio_work_submit(&single_q, &items[3], 0, K_FOREVER);
+	k_prio_work_submit(&single_q, &items[4], 1, 10);
+
+	k_sleep(SETTLE_MS);
+
+	if (executed != NUM_ITEMS) {
+		TC_ERROR("%d items executed\n", executed);
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		if (order[i] != expected[i]) {
+			TC_ERROR("Item %d executed at position %d\n",
+				 order[i], i);
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+static int test_pool(void)
+{
+	slow_done = 0;
+	executed = 0;
+
+	k_prio_work_submit(&pool_q, &slow_item, 0, K_FOREVER);
+	k_sleep(SETTLE_MS);
+
+	/* one worker is stuck in the slow handler, the other is free */
+	k_prio_work_submit(&pool_q, &items[0], 0, K_FOREVER);
+	k_sleep(SETTLE_MS);
+
+	if (executed != 1 || slow_done) {
+		TC_ERROR("Item held up by the slow one\n");
+		return TC_FAIL;
+	}
+
+	k_sleep(SLOW_MS);
+
+	if (!slow_done) {
+		TC_ERROR("Slow item did not complete\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int test_cancel_and_stats(void)
+{
+	struct k_prio_work_q_stats stats;
+	uint32_t ms_cycles = (uint32_t)sys_clock_hw_cycles_per_sec /
+			     MSEC_PER_SEC;
+
+	k_prio_work_q_stats_reset(&single_q);
+	executed = 0;
+
+	k_prio_work_submit(&single_q, &slow_item, 0, K_FOREVER);
+	k_sleep(SETTLE_MS);
+
+	/* queued behind the slow item on the single worker */
+	k_prio_work_submit(&single_q, &items[0], 0, K_FOREVER);
+	k_prio_work_submit(&single_q, &items[1], 0, SETTLE_MS);
+
+	if (k_prio_work_cancel(&single_q, &items[0]) != 0 ||
+	    k_prio_work_cancel(&single_q, &items[0]) != -EINVAL) {
+		TC_ERROR("Cancel failed\n");
+		return TC_FAIL;
+	}
+
+	k_sleep(SLOW_MS + SETTLE_MS);
+
+	if (executed != 1 || order[0] != 1) {
+		TC_ERROR("Cancelled item executed\n");
+		return TC_FAIL;
+	}
+
+	k_prio_work_q_stats_get(&single_q, &stats);
+
+	TC_PRINT("%u executed, %u missed, max wait %u, max exec %u cycles\n",
+		 stats.executed, stats.deadline_misses, stats.max_wait,
+		 stats.max_exec);
+
+	if (stats.executed != 2 || stats.deadline_misses != 1 ||
+	    stats.max_exec < ms_cycles * (SLOW_MS - SETTLE_MS) ||
+	    stats.max_wait < ms_cycles * (SLOW_MS - 2 * SETTLE_MS)) {
+		TC_ERROR("Wrong statistics\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("Priority workqueue");
+
+	start_queues();
+
+	result = test_order();
+
+	if (result == TC_PASS) {
+		result = test_pool();
+	}
+
+	if (result == TC_PASS) {
+		result = test_cancel_and_stats();
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Stack usage reporting test
+ *
+ * Runs a fiber that uses a known amount of its stack, checks the high
+ * water mark reported for it and prints the stack usage of all threads.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <misc/stack.h>
+
+#include <tc_util.h>
+
+#define FIBER_PRIORITY 5
+#define FIBER_STACK_SIZE 1024
+#define FIBER_STACK_USED 512
+
+#define MAX_THREADS 8
+
+static char __stack fiber_stack[FIBER_STACK_SIZE];
+
+static struct nano_sem done_sem;
+
+static struct stack_usage usage[MAX_THREADS];
+
+static void fiber_entry(int arg1, int arg2)
+{
+	volatile char buf[FIBER_STACK_USED];
+
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	memset((char *)buf, 0, sizeof(buf));
+
+	/* stay alive to be reported */
+	nano_fiber_sem_take(&done_sem, TICKS_UNLIMITED);
+}
+
+static int check_fiber(void)
+{
+	int count, i;
+
+	count = stack_usage_get(usage, MAX_THREADS);
+	if (count > MAX_THREADS) {
+		TC_ERROR("%d threads, expected at most %d\n", count,
+			 MAX_THREADS);
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (usage[i].thread != (void *)fiber_stack) {
+			continue;
+		}
+
+		TC_PRINT("Fiber used %u of %u bytes\n", usage[i].used,
+			 usage[i].size);
+
+		if (usage[i].used < FIBER_STACK_USED ||
+		    usage[i].used >= usage[i].size) {
+			TC_ERROR("Fiber usage out of range\n");
+			return TC_FAIL;
+		}
+
+		return TC_PASS;
+	}
+
+	TC_ERROR("Fiber not reported\n");
+	return TC_FAIL;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("Stack usage reporting");
+
+	nano_sem_init(&done_sem);
+
+	/* the fiber preempts the task and runs until it blocks */
+	task_fiber_start(fiber_stack, FIBER_STACK_SIZE, fiber_entry, 0, 0,
+			 FIBER_PRIORITY, 0);
+
+	result = check_fiber();
+
+	stack_usage_print();
+
+	nano_task_sem_give(&done_sem);
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Thread runtime statistics test
+ *
+ * Lets a low priority thread spin while the main thread sleeps, checks it
+ * is accounted the time and the preemptions by the main thread, and that
+ * the idle share of the CPU drops while it spins and rises once it is
+ * aborted. Prints the statistics of all threads.
+ */
+
+#include <kernel.h>
+
+#include <tc_util.h>
+
+#define SLEEP_MS 100
+#define STACK_SIZE 512
+#define MAX_THREADS 8
+
+static char __stack busy_stack[STACK_SIZE];
+
+static struct k_thread_runtime threads[MAX_THREADS];
+
+static void busy_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (;;) {
+		k_busy_wait(1000);
+	}
+}
+
+static void print_threads(void)
+{
+	int count, i;
+
+	count = k_thread_runtime_stats_all_get(threads, MAX_THREADS);
+
+	for (i = 0; i < count && i < MAX_THREADS; i++) {
+		TC_PRINT("thread %p: %u cycles, %u switches, %u preemptions, "
+			 "max run %u cycles\n", threads[i].thread,
+			 (uint32_t)threads[i].stats.cycles,
+			 threads[i].stats.switches,
+			 threads[i].stats.preemptions,
+			 threads[i].stats.max_run);
+	}
+}
+
+static int find_thread(k_tid_t thread)
+{
+	int count, i;
+
+	count = k_thread_runtime_stats_all_get(threads, MAX_THREADS);
+
+	for (i = 0; i < count && i < MAX_THREADS; i++) {
+		if (threads[i].thread == thread) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	struct k_thread_runtime_stats stats;
+	k_tid_t busy;
+	int idle;
+	int result = TC_PASS;
+
+	TC_START("Thread runtime statistics");
+
+	busy = k_thread_spawn(busy_stack, STACK_SIZE, busy_entry,
+			      NULL, NULL, NULL,
+			      K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+	/* the idle share since boot is of no interest */
+	k_thread_runtime_idle_percent_get();
+
+	k_sleep(SLEEP_MS);
+
+	idle = k_thread_runtime_idle_percent_get();
+	k_thread_runtime_stats_get(busy, &stats);
+	print_threads();
+
+	TC_PRINT("Idle %d%% while busy\n", idle);
+
+	if (!stats.cycles || !stats.preemptions || !stats.max_run) {
+		TC_ERROR("Busy thread not accounted\n");
+		result = TC_FAIL;
+	}
+
+	if (idle > 50) {
+		TC_ERROR("Idle while a thread is busy\n");
+		result = TC_FAIL;
+	}
+
+	if (!find_thread(busy) || !find_thread(k_current_get())) {
+		TC_ERROR("Threads missing from the statistics\n");
+		result = TC_FAIL;
+	}
+
+	k_thread_abort(busy);
+
+	k_thread_runtime_idle_percent_get();
+	k_sleep(SLEEP_MS);
+	idle = k_thread_runtime_idle_percent_get();
+
+	TC_PRINT("Idle %d%% once aborted\n", idle);
+
+	if (idle < 50) {
+		TC_ERROR("Not idle while all threads sleep\n");
+		result = TC_FAIL;
+	}
+
+	TC_END_REPORT(result);
+}
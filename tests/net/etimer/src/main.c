@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Arms several event timers at once, each expiring later than the one
+ * before. They must fire in order, none before its time, and each one
+ * must cost the net timer fiber a single wakeup: arming the later timers
+ * must not wake it up, nor must it poll in between.
+ */
+
+#include <stdint.h>
+
+#include <nanokernel.h>
+
+#include <net/net_core.h>
+
+#include "contiki/os/sys/process.h"
+#include "contiki/os/sys/etimer.h"
+
+#include <tc_util.h>
+
+#define NUM_TIMERS 4
+#define INTERVAL (sys_clock_ticks_per_sec / 10)
+
+/* The stack timers fire once then stay idle, the last one within 1 s */
+#define SETTLE_TICKS (sys_clock_ticks_per_sec * 2)
+#define TEST_TIMEOUT (sys_clock_ticks_per_sec * 5)
+
+static struct etimer timers[NUM_TIMERS];
+static clock_time_t armed;
+static uint32_t start_wakeups;
+
+static int fired;
+static int order[NUM_TIMERS];
+static uint32_t wakeups[NUM_TIMERS];
+static clock_time_t fire_time[NUM_TIMERS];
+
+static struct nano_sem done;
+
+PROCESS(test_timer_process, "Test timer process");
+
+PROCESS_THREAD(test_timer_process, ev, data, buf, user_data)
+{
+	struct etimer *t;
+	int i;
+
+	PROCESS_BEGIN();
+
+	armed = clock_time();
+
+	for (i = 0; i < NUM_TIMERS; i++) {
+		etimer_set(&timers[i], (i + 1) * INTERVAL,
+			   &test_timer_process);
+	}
+
+	/* Only the first timer may have woken up the fiber */
+	start_wakeups = net_timer_wakeups_get();
+
+	while (fired < NUM_TIMERS) {
+		PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+
+		t = data;
+		if (t < timers || t >= timers + NUM_TIMERS) {
+			continue;
+		}
+
+		etimer_set_triggered(t);
+
+		order[fired] = t - timers;
+		wakeups[fired] = net_timer_wakeups_get();
+		fire_time[fired] = clock_time();
+
+		if (++fired == NUM_TIMERS) {
+			nano_fiber_sem_give(&done);
+		}
+	}
+
+	PROCESS_END();
+}
+
+static int check_timers(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_TIMERS; i++) {
+		if (order[i] != i) {
+			TC_ERROR("Timer %d fired in place of timer %d\n",
+				 order[i], i);
+			return TC_FAIL;
+		}
+
+		if ((int32_t)(fire_time[i] - armed) < (i + 1) * INTERVAL) {
+			TC_ERROR("Timer %d fired early, after %u ticks\n", i,
+				 fire_time[i] - armed);
+			return TC_FAIL;
+		}
+
+		if (wakeups[i] != start_wakeups + i + 1) {
+			TC_ERROR("Timer %d fired at wakeup %u, expected %u\n",
+				 i, wakeups[i], start_wakeups + i + 1);
+			return TC_FAIL;
+		}
+
+		TC_PRINT("Timer %d fired after %u ticks, wakeup %u\n", i,
+			 fire_time[i] - armed, wakeups[i]);
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result = TC_FAIL;
+
+	TC_START("Net timer wakeups");
+
+	nano_sem_init(&done);
+
+	if (net_init() < 0) {
+		TC_ERROR("net_init failed\n");
+		goto out;
+	}
+
+	task_sleep(SETTLE_TICKS);
+
+	process_start(&test_timer_process, NULL, NULL);
+
+	if (!nano_task_sem_take(&done, TEST_TIMEOUT)) {
+		TC_ERROR("Only %d timers fired\n", fired);
+		goto out;
+	}
+
+	result = check_timers();
+
+out:
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Sends more packets over the loopback interface than the RX quota of the
+ * receiving context lets it queue, without reading them. The UDP packets
+ * over the quota must be dropped and counted as failures, the TCP data
+ * must all be kept and charged, and reading must give all the buffers
+ * back.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nanokernel.h>
+
+#include <net/ip_buf.h>
+#include <net/net_core.h>
+#include <net/net_socket.h>
+
+#include <net_driver_loopback.h>
+
+#include <tc_util.h>
+
+#define UDP_SERVER_PORT 4242
+#define UDP_CLIENT_PORT 4243
+#define TCP_SERVER_PORT 4244
+#define TCP_CLIENT_PORT 4245
+
+#define QUOTA CONFIG_IP_BUF_CONTEXT_RX_QUOTA
+#define UDP_PACKETS (QUOTA + 3)
+#define TCP_SEGMENTS (QUOTA + 2)
+#define DATA_LEN 64
+
+#define WAIT_TICKS (sys_clock_ticks_per_sec / 10)
+#define TEST_TIMEOUT (sys_clock_ticks_per_sec * 10)
+
+static struct net_addr loopback_addr;
+static struct net_addr any_addr;
+
+static int send_packet(struct net_context *ctx, uint8_t id)
+{
+	struct net_buf *buf;
+	uint8_t *data;
+	int ret;
+
+	buf = ip_buf_get_tx(ctx);
+	if (!buf) {
+		return -EAGAIN;
+	}
+
+	data = net_buf_add(buf, DATA_LEN);
+	memset(data, id, DATA_LEN);
+	ip_buf_appdatalen(buf) = DATA_LEN;
+
+	ret = net_send(buf);
+	if (ret < 0) {
+		ip_buf_unref(buf);
+	}
+
+	return ret;
+}
+
+static int check_udp(void)
+{
+	const struct ip_buf_quota *quota;
+	struct net_context *server, *client;
+	struct net_buf *bufs[QUOTA];
+	int i;
+
+	server = net_context_get(IPPROTO_UDP, &any_addr, 0,
+				 &loopback_addr, UDP_SERVER_PORT);
+	client = net_context_get(IPPROTO_UDP, &loopback_addr,
+				 UDP_SERVER_PORT, &loopback_addr,
+				 UDP_CLIENT_PORT);
+	if (!server || !client) {
+		TC_ERROR("Cannot get UDP contexts\n");
+		return TC_FAIL;
+	}
+
+	/* Registers the receiver */
+	net_receive(server, TICKS_NONE);
+
+	for (i = 0; i < UDP_PACKETS; i++) {
+		if (send_packet(client, i) < 0) {
+			TC_ERROR("Cannot send UDP packet %d\n", i);
+			return TC_FAIL;
+		}
+
+		task_sleep(WAIT_TICKS);
+	}
+
+	quota = ip_buf_get_quota(server);
+
+	if (quota->used[IP_BUF_RX] != QUOTA ||
+	    quota->alloc_failures[IP_BUF_RX] != UDP_PACKETS - QUOTA) {
+		TC_ERROR("%d RX buffers charged, %u dropped\n",
+			 quota->used[IP_BUF_RX],
+			 quota->alloc_failures[IP_BUF_RX]);
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < QUOTA; i++) {
+		bufs[i] = net_receive(server, TICKS_NONE);
+		if (!bufs[i] || ip_buf_appdatalen(bufs[i]) != DATA_LEN ||
+		    *(uint8_t *)ip_buf_appdata(bufs[i]) != i) {
+			TC_ERROR("UDP packet %d not received\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	if (net_receive(server, TICKS_NONE)) {
+		TC_ERROR("Packet over the quota queued\n");
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < QUOTA; i++) {
+		ip_buf_unref(bufs[i]);
+	}
+
+	if (quota->used[IP_BUF_RX]) {
+		TC_ERROR("%d RX buffers still charged\n",
+			 quota->used[IP_BUF_RX]);
+		return TC_FAIL;
+	}
+
+	net_context_put(client);
+	net_context_put(server);
+
+	return TC_PASS;
+}
+
+static int check_tcp(void)
+{
+	const struct ip_buf_quota *quota;
+	struct net_context *server, *client;
+	struct net_buf *buf;
+	int64_t deadline;
+	int sent = 0, received = 0;
+	int ret;
+
+	server = net_context_get(IPPROTO_TCP, &any_addr, 0,
+				 &loopback_addr, TCP_SERVER_PORT);
+	client = net_context_get(IPPROTO_TCP, &loopback_addr,
+				 TCP_SERVER_PORT, &loopback_addr,
+				 TCP_CLIENT_PORT);
+	if (!server || !client) {
+		TC_ERROR("Cannot get TCP contexts\n");
+		return TC_FAIL;
+	}
+
+	/* Listens */
+	net_receive(server, TICKS_NONE);
+
+	quota = ip_buf_get_quota(server);
+	deadline = sys_tick_get() + TEST_TIMEOUT;
+
+	while (quota->used[IP_BUF_RX] < TCP_SEGMENTS &&
+	       sys_tick_get() < deadline) {
+		if (sent == TCP_SEGMENTS) {
+			task_sleep(WAIT_TICKS);
+			continue;
+		}
+
+		ret = send_packet(client, sent);
+		if (ret == -EAGAIN || ret == -EINPROGRESS ||
+		    ret == -ECONNRESET) {
+			task_sleep(1);
+			continue;
+		}
+
+		if (ret < 0) {
+			TC_ERROR("Cannot send TCP segment %d (%d)\n",
+				 sent, ret);
+			return TC_FAIL;
+		}
+
+		sent++;
+	}
+
+	if (quota->used[IP_BUF_RX] != TCP_SEGMENTS ||
+	    quota->alloc_failures[IP_BUF_RX]) {
+		TC_ERROR("%d RX buffers charged, %u dropped\n",
+			 quota->used[IP_BUF_RX],
+			 quota->alloc_failures[IP_BUF_RX]);
+		return TC_FAIL;
+	}
+
+	while ((buf = net_receive(server, TICKS_NONE))) {
+		received += ip_buf_appdatalen(buf);
+		ip_buf_unref(buf);
+	}
+
+	if (received != TCP_SEGMENTS * DATA_LEN) {
+		TC_ERROR("Received %d of %d bytes\n", received,
+			 TCP_SEGMENTS * DATA_LEN);
+		return TC_FAIL;
+	}
+
+	if (quota->used[IP_BUF_RX]) {
+		TC_ERROR("%d RX buffers still charged\n",
+			 quota->used[IP_BUF_RX]);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	static const struct in6_addr in6addr_loopback =
+						IN6ADDR_LOOPBACK_INIT;
+	static const struct in6_addr in6addr_any = IN6ADDR_ANY_INIT;
+	int result;
+
+	TC_START("Test IP buffer RX quota");
+
+	net_init();
+	net_driver_loopback_init();
+
+	loopback_addr.family = AF_INET6;
+	loopback_addr.in6_addr = in6addr_loopback;
+	any_addr.family = AF_INET6;
+	any_addr.in6_addr = in6addr_any;
+
+	result = check_udp();
+
+	if (result == TC_PASS) {
+		result = check_tcp();
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Streams data over a TCP connection on the loopback interface and reports
+ * the throughput. A loopback filter watches the segments: it checks that no
+ * more than CONFIG_TCP_SEND_SEGMENTS are ever in flight, and more than one
+ * unless the window is down to stop-and-wait, and drops one data segment
+ * to check that it gets retransmitted. It also fails the transmission of
+ * another segment after uIP has queued it, when there is a window: uIP
+ * must retransmit it, and the stack must not send its data again as new
+ * data. The receiver checks that
+ * the data arrives whole, in order and only once.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nanokernel.h>
+
+#include <net/ip_buf.h>
+#include <net/net_core.h>
+#include <net/net_socket.h>
+
+#include <net_driver_loopback.h>
+
+#include <tc_util.h>
+
+#define SERVER_PORT 4242
+#define CLIENT_PORT 4243
+
+#define SEGMENT_LEN 256
+#define SEGMENT_COUNT 64
+#define TOTAL_LEN (SEGMENT_LEN * SEGMENT_COUNT)
+
+/* the segment lost on its first transmission */
+#define DROP_OFFSET (SEGMENT_LEN * 8)
+/* the segment the driver fails to send the first time, with a window */
+#define FAIL_OFFSET (SEGMENT_LEN * 20)
+#define FAIL_SEND (CONFIG_TCP_SEND_SEGMENTS > 1)
+
+/* IPv6 and TCP header fields, without extension headers */
+#define IPV6_HDR_LEN 40
+#define IPV6_PAYLOAD_LEN 4
+#define IPV6_NEXT_HDR 6
+#define TCP_HDR_LEN 20
+#define TCP_SRC_PORT 0
+#define TCP_DST_PORT 2
+#define TCP_SEQ 4
+#define TCP_ACK 8
+#define TCP_OFFSET 12
+#define TCP_FLAGS 13
+#define TCP_FLAG_ACK 0x10
+
+#define WAIT_TICKS (sys_clock_ticks_per_sec / 10)
+/* each lost segment costs a retransmission timeout of a few seconds */
+#define TEST_TIMEOUT (sys_clock_ticks_per_sec * 60)
+
+#define STACKSIZE 2000
+static char __noinit __stack receiver_stack[STACKSIZE];
+
+static struct nano_sem received;
+static int received_len;
+static uint32_t received_at;
+static bool received_ok = true;
+
+static struct net_addr loopback_addr;
+static struct net_addr any_addr;
+
+/* what the loopback filter saw, as offsets in the stream */
+static bool data_started;
+static uint32_t data_seq;
+static int32_t sent_max;
+static int32_t acked;
+static int max_in_flight;
+static bool dropped;
+static bool retransmitted;
+static bool failed;
+static bool failed_resent;
+
+static inline uint8_t pattern(int pos)
+{
+	return (uint8_t)(pos * 7 + (pos >> 8));
+}
+
+static inline uint16_t get_be16(const uint8_t *p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+static inline uint32_t get_be32(const uint8_t *p)
+{
+	return ((uint32_t)get_be16(p) << 16) | get_be16(p + 2);
+}
+
+static int tcp_filter(struct net_buf *buf)
+{
+	uint8_t *ip = buf->data;
+	uint8_t *tcp = ip + IPV6_HDR_LEN;
+	int32_t offset;
+	int in_flight;
+	int len;
+
+	if (buf->len < IPV6_HDR_LEN + TCP_HDR_LEN ||
+	    ip[IPV6_NEXT_HDR] != IPPROTO_TCP) {
+		return 1;
+	}
+
+	len = get_be16(ip + IPV6_PAYLOAD_LEN) - (tcp[TCP_OFFSET] >> 4) * 4;
+
+	if (get_be16(tcp + TCP_SRC_PORT) == SERVER_PORT) {
+		if (data_started && (tcp[TCP_FLAGS] & TCP_FLAG_ACK)) {
+			offset = get_be32(tcp + TCP_ACK) - data_seq;
+			if (offset > acked) {
+				acked = offset;
+			}
+		}
+
+		return 1;
+	}
+
+	if (get_be16(tcp + TCP_DST_PORT) != SERVER_PORT || len <= 0) {
+		return 1;
+	}
+
+	if (!data_started) {
+		data_seq = get_be32(tcp + TCP_SEQ);
+		data_started = true;
+	}
+
+	offset = get_be32(tcp + TCP_SEQ) - data_seq;
+
+	if (FAIL_SEND && offset == FAIL_OFFSET) {
+		if (!failed) {
+			failed = true;
+			return -EIO;
+		}
+
+		failed_resent = true;
+	}
+
+	if (offset + len <= sent_max) {
+		if (offset == DROP_OFFSET) {
+			retransmitted = true;
+		}
+
+		return 1;
+	}
+
+	sent_max = offset + len;
+
+	in_flight = (sent_max - acked + SEGMENT_LEN - 1) / SEGMENT_LEN;
+	if (in_flight > max_in_flight) {
+		max_in_flight = in_flight;
+	}
+
+	if (offset == DROP_OFFSET && !dropped) {
+		dropped = true;
+		return 0;
+	}
+
+	return 1;
+}
+
+static int check_window(void)
+{
+	TC_PRINT("at most %d segments in flight, window of %d\n",
+		 max_in_flight, CONFIG_TCP_SEND_SEGMENTS);
+
+	if (max_in_flight > CONFIG_TCP_SEND_SEGMENTS) {
+		TC_ERROR("More segments in flight than the window\n");
+		return TC_FAIL;
+	}
+
+	if (CONFIG_TCP_SEND_SEGMENTS > 1 && max_in_flight < 2) {
+		TC_ERROR("Window not used, sent stop-and-wait\n");
+		return TC_FAIL;
+	}
+
+	if (!dropped || !retransmitted) {
+		TC_ERROR("Lost segment not retransmitted\n");
+		return TC_FAIL;
+	}
+
+	if (FAIL_SEND && (!failed || !failed_resent)) {
+		TC_ERROR("Segment that failed to send not retransmitted\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static void receiver(void)
+{
+	struct net_context *ctx;
+	struct net_buf *buf;
+	uint8_t *data;
+	int i;
+
+	ctx = net_context_get(IPPROTO_TCP, &any_addr, 0,
+			      &loopback_addr, SERVER_PORT);
+	if (!ctx) {
+		TC_ERROR("Cannot get server context\n");
+		received_ok = false;
+		nano_fiber_sem_give(&received);
+		return;
+	}
+
+	while (received_len < TOTAL_LEN) {
+		buf = net_receive(ctx, WAIT_TICKS);
+		if (!buf) {
+			continue;
+		}
+
+		data = ip_buf_appdata(buf);
+		for (i = 0; i < ip_buf_appdatalen(buf); i++) {
+			if (data[i] != pattern(received_len + i)) {
+				received_ok = false;
+			}
+		}
+
+		received_len += ip_buf_appdatalen(buf);
+		ip_buf_unref(buf);
+	}
+
+	received_at = sys_tick_get_32();
+
+	/* Data sent twice would come after the end of the stream */
+	buf = net_receive(ctx, WAIT_TICKS * 5);
+	if (buf) {
+		received_len += ip_buf_appdatalen(buf);
+		received_ok = false;
+		ip_buf_unref(buf);
+	}
+
+	nano_fiber_sem_give(&received);
+}
+
+static int send_segment(struct net_context *ctx, int pos)
+{
+	struct net_buf *buf;
+	uint8_t *data;
+	int ret, i;
+
+	buf = ip_buf_get_tx(ctx);
+	if (!buf) {
+		return -EAGAIN;
+	}
+
+	data = net_buf_add(buf, SEGMENT_LEN);
+	for (i = 0; i < SEGMENT_LEN; i++) {
+		data[i] = pattern(pos + i);
+	}
+
+	ip_buf_appdatalen(buf) = SEGMENT_LEN;
+
+	ret = net_send(buf);
+	if (ret < 0) {
+		ip_buf_unref(buf);
+		return ret;
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	static const struct in6_addr in6addr_loopback =
+						IN6ADDR_LOOPBACK_INIT;
+	static const struct in6_addr in6addr_any = IN6ADDR_ANY_INIT;
+	struct net_context *ctx;
+	uint32_t start, elapsed;
+	int64_t deadline;
+	int pos = 0;
+	int ret;
+
+	TC_START("Test TCP send window throughput");
+
+	net_init();
+	net_driver_loopback_init();
+	net_driver_loopback_filter_set(tcp_filter);
+	nano_sem_init(&received);
+
+	loopback_addr.family = AF_INET6;
+	loopback_addr.in6_addr = in6addr_loopback;
+	any_addr.family = AF_INET6;
+	any_addr.in6_addr = in6addr_any;
+
+	task_fiber_start(&receiver_stack[0], STACKSIZE,
+			 (nano_fiber_entry_t)receiver, 0, 0, 7, 0);
+
+	ctx = net_context_get(IPPROTO_TCP, &loopback_addr, SERVER_PORT,
+			      &loopback_addr, CLIENT_PORT);
+	if (!ctx) {
+		TC_ERROR("Cannot get client context\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	start = sys_tick_get_32();
+	deadline = sys_tick_get() + TEST_TIMEOUT;
+
+	while (pos < TOTAL_LEN && sys_tick_get() < deadline) {
+		ret = send_segment(ctx, pos);
+		if (ret == -EAGAIN || ret == -EINPROGRESS ||
+		    ret == -ECONNRESET) {
+			task_sleep(1);
+			continue;
+		}
+
+		if (ret < 0) {
+			TC_ERROR("Send failed (%d)\n", ret);
+			TC_END_REPORT(TC_FAIL);
+			return;
+		}
+
+		pos += SEGMENT_LEN;
+	}
+
+	if (!nano_task_sem_take(&received,
+				deadline - sys_tick_get() + WAIT_TICKS)) {
+		TC_ERROR("Received only %d of %d bytes\n", received_len,
+			 TOTAL_LEN);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	elapsed = received_at - start;
+	if (!elapsed) {
+		elapsed = 1;
+	}
+
+	TC_PRINT("%d segments in flight: %d bytes in %u ticks, %u bytes/s\n",
+		 CONFIG_TCP_SEND_SEGMENTS, received_len, elapsed,
+		 (uint32_t)((uint64_t)received_len *
+			    sys_clock_ticks_per_sec / elapsed));
+
+	if (!received_ok) {
+		TC_ERROR("Received data out of order or corrupted\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	TC_END_REPORT(check_window());
+}
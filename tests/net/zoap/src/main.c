@@ -813,6 +813,207 @@ done:
 	return result;
 }
 
+static int test_notification_patch(void)
+{
+	uint8_t result_pdu[] = {
+		0x53, 0x45, 0x12, 0x34,
+		't', 'o', 'k',
+		0x61, 0x03, /* observe option */
+		0xFF, 'a', 'b', 'c',
+	};
+	static const char payload[] = "abc";
+	struct zoap_packet tmpl, pkt;
+	struct zoap_observer observer = { .token = "tok", .tkl = 3 };
+	struct net_buf *tmpl_buf, *buf = NULL;
+	const uint8_t *token;
+	uint8_t *appdata, tkl;
+	int result = TC_FAIL;
+	uint16_t len;
+	int r;
+
+	tmpl_buf = net_buf_get(&zoap_fifo, 0);
+	if (!tmpl_buf) {
+		TC_PRINT("Could not get buffer from pool\n");
+		goto done;
+	}
+	ip_buf_appdata(tmpl_buf) = net_buf_tail(tmpl_buf);
+	ip_buf_appdatalen(tmpl_buf) = net_buf_tailroom(tmpl_buf);
+
+	r = zoap_packet_init(&tmpl, tmpl_buf);
+	if (r) {
+		TC_PRINT("Could not initialize packet\n");
+		goto done;
+	}
+
+	zoap_header_set_version(&tmpl, 1);
+	zoap_header_set_type(&tmpl, ZOAP_TYPE_NON_CON);
+	zoap_header_set_code(&tmpl, ZOAP_RESPONSE_CODE_CONTENT);
+
+	r = zoap_add_option_int(&tmpl, ZOAP_OPTION_OBSERVE, 3);
+	if (r) {
+		TC_PRINT("Could not add option\n");
+		goto done;
+	}
+
+	appdata = zoap_packet_get_payload(&tmpl, &len);
+	if (!appdata || len < sizeof(payload) - 1) {
+		TC_PRINT("Not enough space to insert payload\n");
+		goto done;
+	}
+
+	memcpy(appdata, payload, sizeof(payload) - 1);
+	zoap_packet_set_used(&tmpl, sizeof(payload) - 1);
+
+	buf = net_buf_get(&zoap_incoming_fifo, 0);
+	if (!buf) {
+		TC_PRINT("Could not get buffer from pool\n");
+		goto done;
+	}
+	ip_buf_appdata(buf) = net_buf_tail(buf);
+	ip_buf_appdatalen(buf) = net_buf_tailroom(buf);
+
+	r = zoap_packet_init(&pkt, buf);
+	if (r) {
+		TC_PRINT("Could not initialize packet\n");
+		goto done;
+	}
+
+	r = zoap_notification_patch(&pkt, &tmpl, &observer, 0x1234);
+	if (r) {
+		TC_PRINT("Could not patch notification\n");
+		goto done;
+	}
+
+	if (ip_buf_appdatalen(buf) != sizeof(result_pdu)) {
+		TC_PRINT("Different size from the reference packet\n");
+		goto done;
+	}
+
+	if (memcmp(result_pdu, ip_buf_appdata(buf), ip_buf_appdatalen(buf))) {
+		TC_PRINT("Patched packet doesn't match reference packet\n");
+		goto done;
+	}
+
+	token = zoap_header_get_token(&pkt, &tkl);
+	if (tkl != observer.tkl || memcmp(token, observer.token, tkl)) {
+		TC_PRINT("Token doesn't match the observer token\n");
+		goto done;
+	}
+
+	appdata = zoap_packet_get_payload(&pkt, &len);
+	if (!appdata || memcmp(appdata, payload, sizeof(payload) - 1)) {
+		TC_PRINT("Payload doesn't match the template payload\n");
+		goto done;
+	}
+
+	/* A template carrying a token is rejected */
+	r = zoap_notification_patch(&tmpl, &pkt, &observer, 0x1234);
+	if (r != -EINVAL) {
+		TC_PRINT("Patching from a packet with a token should fail\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	if (tmpl_buf) {
+		net_buf_unref(tmpl_buf);
+	}
+	if (buf) {
+		net_buf_unref(buf);
+	}
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static int rate_notify_count;
+static int rate_notify_age;
+
+static void rate_notify_callback(struct zoap_resource *resource,
+				 struct zoap_observer *observer)
+{
+	rate_notify_count++;
+	rate_notify_age = resource->age;
+}
+
+static int test_notify_rate_limit(void)
+{
+	struct zoap_resource resource = {
+		.notify = rate_notify_callback,
+	};
+	struct zoap_observer observer = { };
+	int result = TC_FAIL;
+	int i, age, r;
+
+	rate_notify_count = 0;
+
+	/* As zoap_observer_init() does, the registration is a notification */
+	observer.last_notify = sys_tick_get_32();
+	zoap_register_observer(&resource, &observer);
+
+	/* Updates faster than the limit coalesce into one pending */
+	for (i = 0; i < 5; i++) {
+		r = zoap_resource_notify(&resource);
+		if (r) {
+			TC_PRINT("Could not notify resource\n");
+			goto done;
+		}
+	}
+
+	age = resource.age;
+
+	if (rate_notify_count || !observer.pending) {
+		TC_PRINT("Notified before the interval expired\n");
+		goto done;
+	}
+
+	r = zoap_resource_notify_pending(&resource);
+	if (r <= 0 || r > CONFIG_ZOAP_OBSERVE_MIN_INTERVAL) {
+		TC_PRINT("Wrong time until the pending notification: %d\n",
+			 r);
+		goto done;
+	}
+
+	if (rate_notify_count) {
+		TC_PRINT("Pending notification sent too early\n");
+		goto done;
+	}
+
+	task_sleep(MSEC(r) + 1);
+
+	/* The pending notification goes out with the latest state */
+	r = zoap_resource_notify_pending(&resource);
+	if (r) {
+		TC_PRINT("Observer still pending after the interval\n");
+		goto done;
+	}
+
+	if (rate_notify_count != 1 || rate_notify_age != age ||
+	    observer.pending) {
+		TC_PRINT("%d notifications sent, of age %d instead of %d\n",
+			 rate_notify_count, rate_notify_age, age);
+		goto done;
+	}
+
+	/* And restarts the interval */
+	zoap_resource_notify(&resource);
+	if (rate_notify_count != 1 || !observer.pending) {
+		TC_PRINT("Notified again before the interval expired\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	zoap_remove_observer(&resource, &observer);
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 static const struct {
 	const char *name;
 	int (*func)(void);
@@ -825,6 +1026,8 @@ static const struct {
 	{ "Test retransmission", test_retransmit_second_round, },
 	{ "Test observer server", test_observer_server, },
 	{ "Test observer server", test_observer_client, },
+	{ "Test notification patch", test_notification_patch, },
+	{ "Test notification rate limit", test_notify_rate_limit, },
 };
 
 int main(int argc, char *argv[])
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CONFIG_SYS_CLOCK_TICKS_PER_SEC 100
+#define CONFIG_NETWORKING 1
+#define CONFIG_NETWORKING_WITH_IPV6 1
+#define CONFIG_NETWORKING_WITH_6LOWPAN 1
+#define CONFIG_NETWORKING_WITH_15_4 1
+#define CONFIG_NETWORKING_WITH_15_4_MAC_CSMA 1
+#define CONFIG_15_4_CSMA_NEIGHBOR_QUEUES 2
+#define CONFIG_15_4_CSMA_PACKETS_PER_NEIGHBOR 3
+#define CONFIG_15_4_CSMA_DROP_HEAD 1
+#define CONFIG_L2_BUFFERS 1
+
+#include <ztest.h>
+
+/* The radio never completes a transmission unless the test says so */
+#define NETSTACK_RDC test_rdc_driver
+
+#include "contiki/mac/csma.c"
+#include "contiki/os/lib/memb.c"
+#include "contiki/linkaddr.c"
+
+#define QUEUE_LEN CONFIG_15_4_CSMA_PACKETS_PER_NEIGHBOR
+#define NUM_FRAMES (QUEUE_LEN + 2)
+
+/* Like the 6LoWPAN fragmenter, all the frames go through one buffer */
+static NET_BUF_POOL(frag_pool, 1, 128, NULL, NULL, sizeof(struct l2_buf));
+static struct net_buf *frag = &frag_pool[0].buf;
+
+static const linkaddr_t receiver = { { 1, 2, 3, 4, 5, 6, 7, 8 } };
+
+/* A queued copy of a frame, remembers which frame it is */
+struct queuebuf {
+	int frame;
+	packetbuf_attr_t seqno;
+	bool used;
+};
+
+static struct queuebuf queuebufs[QUEUEBUF_NUM];
+static int queuebufs_used;
+
+static int frames[NUM_FRAMES];
+static int current_frame;
+
+/* What the radio was last asked to send */
+static mac_callback_t rdc_sent;
+static void *rdc_ptr;
+static struct rdc_buf_list *rdc_list;
+
+/* The sent callbacks called, in order */
+static int sent_frames[NUM_FRAMES];
+static int sent_status[NUM_FRAMES];
+static int sent_count;
+
+int packetbuf_set_attr(struct net_buf *buf, uint8_t type,
+		       const packetbuf_attr_t val)
+{
+	uip_pkt_packetbuf_attrs(buf)[type].val = val;
+	return 1;
+}
+
+packetbuf_attr_t packetbuf_attr(struct net_buf *buf, uint8_t type)
+{
+	return uip_pkt_packetbuf_attrs(buf)[type].val;
+}
+
+const linkaddr_t *packetbuf_addr(struct net_buf *buf, uint8_t type)
+{
+	return &uip_pkt_packetbuf_addrs(buf)[type - PACKETBUF_ADDR_FIRST].addr;
+}
+
+void queuebuf_init(void)
+{
+	memset(queuebufs, 0, sizeof(queuebufs));
+	queuebufs_used = 0;
+}
+
+struct queuebuf *queuebuf_new_from_packetbuf(struct net_buf *buf)
+{
+	int i;
+
+	for (i = 0; i < QUEUEBUF_NUM; i++) {
+		if (!queuebufs[i].used) {
+			queuebufs[i].used = true;
+			queuebufs[i].frame = current_frame;
+			queuebufs[i].seqno = packetbuf_attr(buf,
+						PACKETBUF_ATTR_MAC_SEQNO);
+			queuebufs_used++;
+			return &queuebufs[i];
+		}
+	}
+
+	return NULL;
+}
+
+void queuebuf_update_attr_from_packetbuf(struct net_buf *buf,
+					 struct queuebuf *b)
+{
+}
+
+void queuebuf_free(struct queuebuf *b)
+{
+	assert_true(b->used, "queuebuf freed twice");
+	b->used = false;
+	queuebufs_used--;
+}
+
+packetbuf_attr_t queuebuf_attr(struct queuebuf *b, uint8_t type)
+{
+	assert_equal(type, PACKETBUF_ATTR_MAC_SEQNO, "unexpected attribute");
+	return b->seqno;
+}
+
+void ctimer_set(struct net_buf *buf, struct ctimer *c, clock_time_t t,
+		void (*f)(struct net_buf *, void *), void *ptr)
+{
+}
+
+unsigned short random_rand(void)
+{
+	return 0;
+}
+
+void mac_call_sent_callback(struct net_buf *buf, mac_callback_t sent,
+			    void *ptr, int status, int num_tx)
+{
+	assert_equal(buf, frag, "sent callback for another buffer");
+
+	sent_frames[sent_count] = (int *)ptr - frames;
+	sent_status[sent_count] = status;
+	sent_count++;
+}
+
+static uint8_t rdc_send_list(struct net_buf *buf, mac_callback_t sent,
+			     void *ptr, struct rdc_buf_list *list)
+{
+	rdc_sent = sent;
+	rdc_ptr = ptr;
+	rdc_list = list;
+
+	return 1;
+}
+
+static unsigned short rdc_channel_check_interval(void)
+{
+	return 1;
+}
+
+const struct rdc_driver test_rdc_driver = {
+	.name = "test",
+	.send_list = rdc_send_list,
+	.channel_check_interval = rdc_channel_check_interval,
+};
+
+const struct llsec_driver nullsec_driver;
+
+static void setup(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		frames[i] = i;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	sent_count = 0;
+	rdc_list = NULL;
+
+	LIST_STRUCT_INIT((struct l2_buf *)net_buf_user_data(frag),
+			 neighbor_list);
+	linkaddr_copy(&uip_pkt_packetbuf_addrs(frag)[PACKETBUF_ADDR_RECEIVER -
+						     PACKETBUF_ADDR_FIRST].addr,
+		      &receiver);
+
+	csma_driver.init();
+}
+
+static void send_frame(int frame)
+{
+	current_frame = frame;
+	csma_driver.send(frag, NULL, true, &frames[frame]);
+}
+
+/* Checks the frames left in the neighbor queue, oldest first */
+static void check_queue(const int *expected, int len)
+{
+	struct rdc_buf_list *q = rdc_list;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		assert_not_null(q, "queue too short");
+		assert_equal(q->buf->frame, expected[i], "wrong frame queued");
+		q = list_item_next(q);
+	}
+
+	assert_is_null(q, "queue too long");
+	assert_equal(queuebufs_used, len, "queuebufs leaked");
+}
+
+static void test_drop_oldest(void)
+{
+	static const int left[] = { 2, 3, 4 };
+	int i;
+
+	setup();
+
+	for (i = 0; i < QUEUE_LEN; i++) {
+		send_frame(i);
+	}
+
+	assert_equal(sent_count, 0, "frame dropped before the queue is full");
+	assert_equal(stats.head_drops, 0, "head drop counted too early");
+
+	/* Each frame over the limit pushes the oldest one out */
+	send_frame(QUEUE_LEN);
+	send_frame(QUEUE_LEN + 1);
+
+	assert_equal(sent_count, 2, "oldest frames not dropped");
+	assert_equal(sent_frames[0], 0, "first frame not dropped first");
+	assert_equal(sent_frames[1], 1, "second frame not dropped next");
+	assert_equal(sent_status[0], MAC_TX_ERR, "drop not reported");
+	assert_equal(sent_status[1], MAC_TX_ERR, "drop not reported");
+
+	assert_equal(stats.queued, NUM_FRAMES, "queued frames not counted");
+	assert_equal(stats.head_drops, 2, "head drops not counted");
+	assert_equal(stats.tail_drops, 0, "tail drop counted");
+	assert_equal(stats.no_buffer_drops, 0, "buffer drop counted");
+
+	check_queue(left, ARRAY_SIZE(left));
+}
+
+static void test_keep_in_flight(void)
+{
+	static const int left[] = { 0, 2, 3 };
+	int i;
+
+	setup();
+
+	for (i = 0; i < QUEUE_LEN; i++) {
+		send_frame(i);
+	}
+
+	/* The oldest frame collides, it is now being retransmitted */
+	packetbuf_set_attr(frag, PACKETBUF_ATTR_MAC_SEQNO,
+			   rdc_list->buf->seqno);
+	rdc_sent(frag, rdc_ptr, MAC_TX_COLLISION, 1);
+
+	send_frame(QUEUE_LEN);
+
+	assert_equal(sent_count, 1, "no frame dropped");
+	assert_equal(sent_frames[0], 1, "frame in flight dropped");
+	assert_equal(stats.head_drops, 1, "head drop not counted");
+
+	check_queue(left, ARRAY_SIZE(left));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(csma_test,
+		ztest_unit_test(test_drop_oldest),
+		ztest_unit_test(test_keep_in_flight)
+	);
+
+	ztest_run_test_suite(csma_test);
+}
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CONFIG_USB_DEVICE_TRANSFER 1
+#define CONFIG_SYS_LOG_USB_LEVEL 0
+
+#include <ztest.h>
+
+#include <net/buf.c>
+
+/* Count the locks, to check which callbacks run with interrupts locked */
+static int irq_locked;
+
+#undef irq_lock
+#undef irq_unlock
+#define irq_lock() (irq_locked++)
+#define irq_unlock(key) ((void)(key), irq_locked--)
+
+#include <usb/usb_transfer.c>
+
+/* One packet at a time in the FIFO of the OUT endpoint */
+static uint8_t fifo[128];
+static uint32_t fifo_len;
+static uint32_t fifo_pos;
+
+/* The IN endpoint writes, of one packet of up to IN_FIFO_LEN bytes, and
+ * whether the next one finds the FIFO full
+ */
+#define IN_FIFO_LEN 64
+
+static uint32_t written[8];
+static int writes;
+static bool fifo_full;
+
+static struct net_buf *cb_buf;
+static int cb_status;
+static int cb_count;
+static int cb_irq_locked;
+
+#define BUF_COUNT 4
+#define BUF_SIZE 256
+
+static NET_BUF_POOL(bufs_pool, BUF_COUNT, BUF_SIZE, NULL, NULL, 0);
+static int next_buf;
+
+void nano_fifo_init(struct nano_fifo *fifo) {}
+void nano_fifo_put_list(struct nano_fifo *fifo, void *head, void *tail) {}
+void nano_fifo_put(struct nano_fifo *fifo, void *data) {}
+
+nano_context_type_t sys_execution_context_type_get(void)
+{
+	return NANO_CTX_FIBER;
+}
+
+void *nano_fifo_get(struct nano_fifo *fifo, int32_t timeout)
+{
+	return &bufs_pool[next_buf++ % BUF_COUNT].buf;
+}
+
+uint32_t sys_cycle_get_32(void)
+{
+	return 0;
+}
+
+int usb_dc_ep_read(const uint8_t ep, uint8_t *const data,
+		   const uint32_t max_data_len, uint32_t * const read_bytes)
+{
+	uint32_t len = min(max_data_len, fifo_len - fifo_pos);
+
+	if (!data && !max_data_len) {
+		*read_bytes = fifo_len - fifo_pos;
+		return 0;
+	}
+
+	memcpy(data, fifo + fifo_pos, len);
+	fifo_pos += len;
+	*read_bytes = len;
+
+	/* All read, the endpoint is re-armed */
+	if (fifo_pos == fifo_len) {
+		fifo_len = 0;
+		fifo_pos = 0;
+	}
+
+	return 0;
+}
+
+int usb_dc_ep_write(const uint8_t ep, const uint8_t *const data,
+		    const uint32_t data_len, uint32_t * const ret_bytes)
+{
+	if (fifo_full) {
+		return -EAGAIN;
+	}
+
+	*ret_bytes = min(data_len, IN_FIFO_LEN);
+	written[writes++] = *ret_bytes;
+
+	return 0;
+}
+
+int usb_dc_ep_flush(const uint8_t ep)
+{
+	return 0;
+}
+
+static void transfer_cb(uint8_t ep, struct net_buf *buf, int status)
+{
+	cb_buf = buf;
+	cb_status = status;
+	cb_count++;
+	cb_irq_locked = irq_locked;
+}
+
+static struct net_buf *get_buf(void)
+{
+	return net_buf_get_timeout(NULL, 0, TICKS_NONE);
+}
+
+static void setup(void)
+{
+	cb_buf = NULL;
+	cb_status = 0;
+	cb_count = 0;
+	writes = 0;
+	fifo_full = false;
+	fifo_len = 0;
+	fifo_pos = 0;
+}
+
+static inline uint8_t pattern(int pos)
+{
+	return (uint8_t)(pos * 7 + 3);
+}
+
+/* Put the next packet in the FIFO and raise its interrupt */
+static void receive(uint8_t ep, int pos, int len)
+{
+	int i;
+
+	assert_equal(fifo_len, 0, "Previous packet not read");
+
+	for (i = 0; i < len; i++) {
+		fifo[i] = pattern(pos + i);
+	}
+
+	fifo_len = len;
+	fifo_pos = 0;
+
+	usb_transfer_ep_callback(ep, USB_DC_EP_DATA_OUT);
+}
+
+static void check_data(struct net_buf *buf, int len)
+{
+	int i;
+
+	assert_equal(buf->len, len, "Wrong length received");
+
+	for (i = 0; i < len; i++) {
+		assert_equal(buf->data[i], pattern(i), "Wrong data received");
+	}
+}
+
+static void test_out(void)
+{
+	static struct usb_transfer_ep tep;
+	struct net_buf *buf = get_buf();
+
+	setup();
+	assert_equal(usb_transfer_ep_init(&tep, 0x01, 64), 0, "");
+	assert_equal(usb_transfer(0x01, buf, transfer_cb), 0, "");
+
+	receive(0x01, 0, 64);
+	receive(0x01, 64, 64);
+	assert_equal(cb_count, 0, "Completed on a full packet");
+
+	receive(0x01, 128, 10);
+	assert_equal(cb_count, 1, "Short packet did not complete");
+	assert_equal(cb_status, 138, "Wrong transfer status");
+	assert_equal_ptr(cb_buf, buf, "Wrong buffer completed");
+	assert_equal(cb_irq_locked, 0, "Callback with interrupts locked");
+	check_data(buf, 138);
+
+	assert_equal(tep.stats.transfers, 1, "");
+	assert_equal(tep.stats.bytes, 138, "");
+	assert_equal(tep.stats.packets, 3, "");
+}
+
+static void test_out_held(void)
+{
+	static struct usb_transfer_ep tep;
+	struct net_buf *buf = get_buf();
+
+	setup();
+	assert_equal(usb_transfer_ep_init(&tep, 0x02, 64), 0, "");
+
+	/* The first packet goes to the packet buffer, the second stays in
+	 * the controller without overwriting it.
+	 */
+	receive(0x02, 0, 64);
+	assert_equal(fifo_len, 0, "First packet not read");
+
+	receive(0x02, 64, 16);
+	assert_equal(fifo_len, 16, "Second packet not left in the FIFO");
+	assert_equal(tep.stats.naked, 1, "Held packet not counted");
+
+	assert_equal(usb_transfer(0x02, buf, transfer_cb), 0, "");
+	assert_equal(fifo_len, 0, "Held packet not read");
+	assert_equal(cb_count, 1, "Held short packet did not complete");
+	assert_equal(cb_status, 80, "Wrong transfer status");
+	assert_equal(cb_irq_locked, 1, "");
+	check_data(buf, 80);
+}
+
+static void test_out_too_large(void)
+{
+	static struct usb_transfer_ep tep;
+	struct net_buf *buf = get_buf();
+
+	setup();
+	assert_equal(usb_transfer_ep_init(&tep, 0x03, 64), 0, "");
+	assert_equal(usb_transfer(0x03, buf, transfer_cb), 0, "");
+
+	receive(0x03, 0, 100);
+	assert_equal(fifo_len, 0, "Packet too large not drained");
+	assert_equal(cb_count, 1, "Packet too large did not fail");
+	assert_equal(cb_status, -EMSGSIZE, "Wrong transfer status");
+	assert_equal(tep.stats.errors, 1, "Error not counted");
+}
+
+static void test_in(void)
+{
+	static struct usb_transfer_ep tep;
+	struct net_buf *buf = get_buf();
+
+	setup();
+	assert_equal(usb_transfer_ep_init(&tep, 0x81, 64), 0, "");
+
+	net_buf_add(buf, 128);
+	fifo_full = true;
+	assert_equal(usb_transfer(0x81, buf, transfer_cb), 0, "");
+	assert_equal(writes, 0, "Written to a full FIFO");
+
+	fifo_full = false;
+	usb_transfer_ep_callback(0x81, USB_DC_EP_DATA_IN);
+	usb_transfer_ep_callback(0x81, USB_DC_EP_DATA_IN);
+	assert_equal(cb_count, 0, "Completed before the ZLP");
+
+	usb_transfer_ep_callback(0x81, USB_DC_EP_DATA_IN);
+	usb_transfer_ep_callback(0x81, USB_DC_EP_DATA_IN);
+	assert_equal(writes, 3, "Wrong number of writes");
+	assert_equal(written[0], 64, "");
+	assert_equal(written[1], 64, "");
+	assert_equal(written[2], 0, "No ZLP after a full packet");
+	assert_equal(cb_count, 1, "Transfer did not complete");
+	assert_equal(cb_status, 128, "Wrong transfer status");
+}
+
+static void test_cancel(void)
+{
+	static struct usb_transfer_ep tep;
+
+	setup();
+	assert_equal(usb_transfer_ep_init(&tep, 0x04, 64), 0, "");
+	assert_equal(usb_transfer(0x04, get_buf(), transfer_cb), 0, "");
+	assert_equal(usb_transfer(0x04, get_buf(), transfer_cb), 0, "");
+	assert_equal(usb_transfer(0x04, get_buf(), transfer_cb), -EBUSY,
+		     "Queued more than USB_TRANSFER_QUEUE_LEN");
+
+	assert_equal(usb_transfer_cancel(0x04), 0, "");
+	assert_equal(cb_count, 2, "Transfers not canceled");
+	assert_equal(cb_status, -ECANCELED, "Wrong transfer status");
+	assert_equal(cb_irq_locked, 0, "Callback with interrupts locked");
+	assert_equal(tep.stats.errors, 2, "Canceled transfers not counted");
+
+	/* The endpoint takes transfers again */
+	assert_equal(usb_transfer(0x04, get_buf(), transfer_cb), 0, "");
+	receive(0x04, 0, 8);
+	assert_equal(cb_count, 3, "");
+	assert_equal(cb_status, 8, "");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(usb_transfer_test,
+		ztest_unit_test(test_out),
+		ztest_unit_test(test_out_held),
+		ztest_unit_test(test_out_too_large),
+		ztest_unit_test(test_in),
+		ztest_unit_test(test_cancel)
+	);
+
+	ztest_run_test_suite(usb_transfer_test);
+}
@@ -233,4 +233,158 @@ int usb_write(uint8_t ep, const uint8_t *data, uint32_t data_len,
 int usb_read(uint8_t ep, uint8_t *data, uint32_t max_data_len,
 		uint32_t *ret_bytes);
 
+#ifdef CONFIG_USB_DEVICE_TRANSFER
+
+#include <net/buf.h>
+#include <misc/slist.h>
+
+/** Largest endpoint max packet size usable with usb_transfer() */
+#define USB_TRANSFER_MAX_MPS	64
+
+/**
+ * Number of transfers that can be queued on an endpoint, the one in
+ * progress and the one the controller moves on to when it completes
+ */
+#define USB_TRANSFER_QUEUE_LEN	2
+
+/**
+ * Callback function signature for the completion of usb_transfer()
+ *
+ * Called from the endpoint interrupt, or with interrupts locked from
+ * usb_transfer() when a packet held by the endpoint completes the
+ * transfer, or from usb_transfer_cancel(). @a status is the number of bytes
+ * transferred, or a negative errno code: -EMSGSIZE when an OUT transfer
+ * received more than the buffer holds, or a packet larger than
+ * USB_TRANSFER_MAX_MPS, -ECANCELED when the transfer was
+ * canceled, or the error of the device controller.
+ */
+typedef void (*usb_transfer_callback)(uint8_t ep, struct net_buf *buf,
+				      int status);
+
+/*
+ * @brief Endpoint throughput counters
+ */
+struct usb_ep_stats {
+	/** Completed transfers, including failed ones */
+	uint32_t transfers;
+	/** Failed or canceled transfers */
+	uint32_t errors;
+	/** Bytes transferred */
+	uint32_t bytes;
+	/** Reads from or writes to the controller FIFO */
+	uint32_t packets;
+	/** Packets that went through the endpoint packet buffer */
+	uint32_t copies;
+	/** OUT packets left NAKed until a buffer was queued */
+	uint32_t naked;
+	/** Hardware cycles with a transfer in progress */
+	uint32_t busy_cycles;
+};
+
+struct usb_transfer_req {
+	struct net_buf *buf;
+	usb_transfer_callback cb;
+};
+
+/*
+ * @brief Endpoint driven with usb_transfer()
+ *
+ * Allocated by the class driver and registered with
+ * usb_transfer_ep_init(), the fields are private.
+ */
+struct usb_transfer_ep {
+	uint8_t ep;
+	uint16_t mps;
+	struct usb_transfer_req queue[USB_TRANSFER_QUEUE_LEN];
+	uint8_t head;
+	uint8_t count;
+	/** A transfer of the queue head is in progress */
+	uint8_t active;
+	/** IN: a write is waiting for its completion */
+	uint8_t busy;
+	/** IN: the zero length packet ending the transfer was sent */
+	uint8_t zlp_sent;
+	/** OUT: the data received did not fit in the buffer */
+	uint8_t overflow;
+	/** OUT: a packet is left unread, NAKing the host, until it fits */
+	uint8_t held;
+	/** Fragment, and offset in it, the transfer continues at */
+	struct net_buf *frag;
+	uint16_t offset;
+	/** OUT: length of the packet held in @a packet */
+	int16_t stash_len;
+	uint32_t total;
+	uint32_t start;
+	/** Word aligned, the controller FIFO is accessed per 32-bit word */
+	uint32_t packet[USB_TRANSFER_MAX_MPS / 4];
+	struct usb_ep_stats stats;
+	sys_snode_t node;
+};
+
+/*
+ * @brief register an endpoint for asynchronous transfers
+ *
+ * The endpoint callback in the device configuration table must be
+ * usb_transfer_ep_callback().
+ *
+ * @param[in] tep Endpoint state
+ * @param[in] ep  Endpoint address
+ * @param[in] mps Endpoint max packet size, as in its descriptor
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+int usb_transfer_ep_init(struct usb_transfer_ep *tep, uint8_t ep,
+			 uint16_t mps);
+
+/*
+ * @brief endpoint callback of endpoints driven with usb_transfer()
+ */
+void usb_transfer_ep_callback(uint8_t ep,
+			      enum usb_dc_ep_cb_status_code ep_status);
+
+/*
+ * @brief queue an asynchronous transfer
+ *
+ * IN endpoints send the data of @a buf and its fragments, packetised
+ * straight from the buffers, followed by a zero length packet when the
+ * length is a multiple of the max packet size. OUT endpoints receive into
+ * the tailroom of @a buf and its fragments until a short packet ends the
+ * transfer or the buffers are full. Only packets straddling two fragments,
+ * or received where the tailroom is not word aligned, are copied.
+ *
+ * While one transfer is in progress the next one can be queued, so the
+ * endpoint moves on to it without waiting for the application.
+ *
+ * @param[in] ep  Endpoint address
+ * @param[in] buf Buffer chain, owned by the USB stack until @a cb is called
+ * @param[in] cb  Completion callback
+ *
+ * @return 0 on success, -EBUSY if the queue is full, negative errno code
+ * on fail
+ */
+int usb_transfer(uint8_t ep, struct net_buf *buf, usb_transfer_callback cb);
+
+/*
+ * @brief cancel the transfers queued on an endpoint
+ *
+ * Their callbacks are called with -ECANCELED.
+ *
+ * @param[in] ep Endpoint address
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+int usb_transfer_cancel(uint8_t ep);
+
+/*
+ * @brief get the throughput counters of an endpoint
+ *
+ * @param[in]  ep    Endpoint address
+ * @param[out] stats Counters
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+int usb_transfer_get_stats(uint8_t ep, struct usb_ep_stats *stats);
+
+#endif /* CONFIG_USB_DEVICE_TRANSFER */
+
 #endif /* USB_DEVICE_H_ */
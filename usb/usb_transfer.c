@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Asynchronous USB endpoint transfers
+ *
+ * Transfers of net_buf chains on bulk and interrupt endpoints, driven from
+ * the endpoint interrupts. Data goes between the controller FIFO and the
+ * buffers directly, the endpoint packet buffer is only used to gather or
+ * scatter packets that straddle fragments, and to hold an OUT packet that
+ * arrives while no transfer is queued. Further OUT packets are left unread
+ * in the controller, which NAKs the host until a transfer is queued.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <misc/util.h>
+#include "usb_device.h"
+
+#define SYS_LOG_LEVEL CONFIG_SYS_LOG_USB_LEVEL
+#include <misc/sys_log.h>
+
+#define EP_IS_IN(ep) (((ep) & USB_EP_DIR_MASK) == USB_EP_DIR_IN)
+
+static sys_slist_t transfer_eps;
+
+static struct usb_transfer_ep *transfer_ep_get(uint8_t ep)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&transfer_eps, node) {
+		struct usb_transfer_ep *tep;
+
+		tep = CONTAINER_OF(node, struct usb_transfer_ep, node);
+		if (tep->ep == ep) {
+			return tep;
+		}
+	}
+
+	return NULL;
+}
+
+static void transfer_start(struct usb_transfer_ep *tep);
+
+static void transfer_complete(struct usb_transfer_ep *tep, int status)
+{
+	struct usb_transfer_req req = tep->queue[tep->head];
+
+	tep->head = (tep->head + 1) % USB_TRANSFER_QUEUE_LEN;
+	tep->count--;
+	tep->active = 0;
+
+	tep->stats.transfers++;
+	if (status < 0) {
+		tep->stats.errors++;
+	} else {
+		tep->stats.bytes += status;
+	}
+	tep->stats.busy_cycles += sys_cycle_get_32() - tep->start;
+
+	/* The callback may queue another transfer */
+	req.cb(tep->ep, req.buf, status);
+
+	if (!tep->active && tep->count) {
+		transfer_start(tep);
+	}
+}
+
+/* Skip to the next fragment with data left to send */
+static void tx_advance(struct usb_transfer_ep *tep, uint32_t len)
+{
+	while (tep->frag) {
+		uint32_t left = tep->frag->len - tep->offset;
+
+		if (len < left) {
+			tep->offset += len;
+			return;
+		}
+
+		len -= left;
+		tep->frag = tep->frag->frags;
+		tep->offset = 0;
+
+		if (!len && tep->frag && tep->frag->len) {
+			return;
+		}
+	}
+}
+
+/* Copy the next packet, straddling fragments, to the packet buffer */
+static uint32_t tx_gather(struct usb_transfer_ep *tep)
+{
+	uint8_t *packet = (uint8_t *)tep->packet;
+	struct net_buf *frag = tep->frag;
+	uint32_t offset = tep->offset;
+	uint32_t len = 0;
+
+	while (frag && len < tep->mps) {
+		uint32_t n = min(frag->len - offset, tep->mps - len);
+
+		memcpy(packet + len, frag->data + offset, n);
+		len += n;
+		frag = frag->frags;
+		offset = 0;
+	}
+
+	tep->stats.copies++;
+
+	return len;
+}
+
+static void tx_continue(struct usb_transfer_ep *tep)
+{
+	const uint8_t *data;
+	uint32_t len, written;
+	int ret;
+
+	if (tep->frag && !tep->frag->len) {
+		tx_advance(tep, 0);
+	}
+
+	if (!tep->frag) {
+		/* A transfer ending on a full packet, or empty, needs a ZLP */
+		if (tep->zlp_sent || tep->total % tep->mps) {
+			transfer_complete(tep, tep->total);
+			return;
+		}
+
+		data = NULL;
+		len = 0;
+		tep->zlp_sent = 1;
+	} else {
+		len = tep->frag->len - tep->offset;
+		data = tep->frag->data + tep->offset;
+
+		if (tep->frag->frags && len < tep->mps) {
+			len = tx_gather(tep);
+			data = (uint8_t *)tep->packet;
+		} else if (tep->frag->frags) {
+			/* Keep the packets of the fragment full */
+			len -= len % tep->mps;
+		}
+	}
+
+	ret = usb_dc_ep_write(tep->ep, data, len, &written);
+	if (ret == -EAGAIN) {
+		/* No FIFO space, retry when the pending write completes */
+		if (!len) {
+			tep->zlp_sent = 0;
+		}
+		tep->busy = 1;
+		return;
+	}
+
+	if (ret < 0) {
+		SYS_LOG_ERR("EP 0x%02x write failed: %d", tep->ep, ret);
+		transfer_complete(tep, ret);
+		return;
+	}
+
+	tep->busy = 1;
+	tep->stats.packets++;
+	tep->total += written;
+	tx_advance(tep, written);
+}
+
+/* Skip to the next fragment with room left to receive into */
+static struct net_buf *rx_frag(struct usb_transfer_ep *tep)
+{
+	while (tep->frag && !net_buf_tailroom(tep->frag)) {
+		tep->frag = tep->frag->frags;
+	}
+
+	return tep->frag;
+}
+
+/* Scatter received data over the fragments */
+static void rx_store(struct usb_transfer_ep *tep, const uint8_t *data,
+		     uint32_t len)
+{
+	tep->total += len;
+
+	while (len && rx_frag(tep)) {
+		uint32_t n = min(net_buf_tailroom(tep->frag), len);
+
+		memcpy(net_buf_add(tep->frag, n), data, n);
+		data += n;
+		len -= n;
+	}
+
+	if (len) {
+		tep->overflow = 1;
+	}
+}
+
+static void rx_check_complete(struct usb_transfer_ep *tep, uint32_t len)
+{
+	if (tep->overflow) {
+		transfer_complete(tep, -EMSGSIZE);
+	} else if (len < tep->mps || !rx_frag(tep)) {
+		transfer_complete(tep, tep->total);
+	}
+}
+
+/* Read and throw away a packet too large for the packet buffer */
+static void rx_discard(struct usb_transfer_ep *tep, uint32_t avail)
+{
+	uint32_t len;
+
+	while (avail) {
+		if (usb_dc_ep_read(tep->ep, (uint8_t *)tep->packet,
+				   min(avail, sizeof(tep->packet)), &len) < 0 ||
+		    !len) {
+			return;
+		}
+
+		avail -= len;
+	}
+}
+
+static void rx_packet(struct usb_transfer_ep *tep)
+{
+	struct net_buf *frag;
+	uint8_t *dst;
+	uint32_t avail, len;
+	int ret;
+
+	usb_dc_ep_read(tep->ep, NULL, 0, &avail);
+
+	/* Without a transfer, hold the packet in the packet buffer if it
+	 * is free, or else leave it unread: the endpoint is not re-armed
+	 * and NAKs the host until transfer_start() reads the packet.
+	 */
+	if (!tep->active &&
+	    (tep->stash_len >= 0 || avail > sizeof(tep->packet))) {
+		if (!tep->held) {
+			tep->held = 1;
+			tep->stats.naked++;
+		}
+		return;
+	}
+
+	tep->held = 0;
+
+	if (avail > sizeof(tep->packet)) {
+		SYS_LOG_ERR("EP 0x%02x packet of %u bytes too large", tep->ep,
+			    avail);
+		tep->stats.packets++;
+		rx_discard(tep, avail);
+		transfer_complete(tep, -EMSGSIZE);
+		return;
+	}
+
+	frag = tep->active ? rx_frag(tep) : NULL;
+
+	/* The FIFO is read per 32-bit word, straight to aligned tailroom */
+	if (frag && net_buf_tailroom(frag) >= avail &&
+	    !((uintptr_t)net_buf_tail(frag) & 0x3)) {
+		dst = net_buf_tail(frag);
+	} else {
+		dst = (uint8_t *)tep->packet;
+	}
+
+	/* Reading also re-arms the endpoint, even for a ZLP */
+	ret = usb_dc_ep_read(tep->ep, dst, avail, &len);
+	if (ret < 0) {
+		SYS_LOG_ERR("EP 0x%02x read failed: %d", tep->ep, ret);
+		if (tep->active) {
+			transfer_complete(tep, ret);
+		}
+		return;
+	}
+
+	tep->stats.packets++;
+
+	if (!tep->active) {
+		/* Hold on to the packet until a buffer is queued */
+		tep->stash_len = len;
+		tep->stats.copies++;
+		return;
+	}
+
+	if (dst == (uint8_t *)tep->packet) {
+		tep->stats.copies++;
+		rx_store(tep, dst, len);
+	} else {
+		net_buf_add(frag, len);
+		tep->total += len;
+	}
+
+	rx_check_complete(tep, len);
+}
+
+static void transfer_start(struct usb_transfer_ep *tep)
+{
+	uint32_t len;
+
+	tep->active = 1;
+	tep->frag = tep->queue[tep->head].buf;
+	tep->offset = 0;
+	tep->total = 0;
+	tep->zlp_sent = 0;
+	tep->overflow = 0;
+	tep->start = sys_cycle_get_32();
+
+	if (EP_IS_IN(tep->ep)) {
+		if (!tep->busy) {
+			tx_continue(tep);
+		}
+		return;
+	}
+
+	if (tep->stash_len >= 0) {
+		len = tep->stash_len;
+		tep->stash_len = -1;
+		rx_store(tep, (uint8_t *)tep->packet, len);
+		rx_check_complete(tep, len);
+	}
+
+	/* Into this transfer, the next one, or the packet buffer freed */
+	if (tep->held) {
+		rx_packet(tep);
+	}
+}
+
+int usb_transfer_ep_init(struct usb_transfer_ep *tep, uint8_t ep,
+			 uint16_t mps)
+{
+	int key;
+
+	if (!mps || mps > USB_TRANSFER_MAX_MPS) {
+		return -EINVAL;
+	}
+
+	memset(tep, 0, sizeof(*tep));
+	tep->ep = ep;
+	tep->mps = mps;
+	tep->stash_len = -1;
+
+	key = irq_lock();
+
+	if (transfer_ep_get(ep)) {
+		irq_unlock(key);
+		return -EALREADY;
+	}
+
+	sys_slist_append(&transfer_eps, &tep->node);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+void usb_transfer_ep_callback(uint8_t ep,
+			      enum usb_dc_ep_cb_status_code ep_status)
+{
+	struct usb_transfer_ep *tep = transfer_ep_get(ep);
+
+	if (!tep) {
+		return;
+	}
+
+	switch (ep_status) {
+	case USB_DC_EP_DATA_IN:
+		tep->busy = 0;
+		if (tep->active) {
+			tx_continue(tep);
+		}
+		break;
+	case USB_DC_EP_DATA_OUT:
+		rx_packet(tep);
+		break;
+	default:
+		break;
+	}
+}
+
+int usb_transfer(uint8_t ep, struct net_buf *buf, usb_transfer_callback cb)
+{
+	struct usb_transfer_ep *tep = transfer_ep_get(ep);
+	int key;
+
+	if (!tep) {
+		return -ENODEV;
+	}
+
+	if (!buf || !cb) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (tep->count == USB_TRANSFER_QUEUE_LEN) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	tep->queue[(tep->head + tep->count) % USB_TRANSFER_QUEUE_LEN] =
+		(struct usb_transfer_req) { .buf = buf, .cb = cb };
+	tep->count++;
+
+	if (!tep->active) {
+		transfer_start(tep);
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int usb_transfer_cancel(uint8_t ep)
+{
+	struct usb_transfer_ep *tep = transfer_ep_get(ep);
+	struct usb_transfer_req reqs[USB_TRANSFER_QUEUE_LEN];
+	int key, count, i;
+
+	if (!tep) {
+		return -ENODEV;
+	}
+
+	key = irq_lock();
+
+	if (tep->active) {
+		if (EP_IS_IN(ep)) {
+			usb_dc_ep_flush(ep);
+			tep->busy = 0;
+		}
+		tep->stats.busy_cycles += sys_cycle_get_32() - tep->start;
+	}
+
+	for (count = 0; tep->count; count++) {
+		reqs[count] = tep->queue[tep->head];
+		tep->head = (tep->head + 1) % USB_TRANSFER_QUEUE_LEN;
+		tep->count--;
+	}
+
+	tep->active = 0;
+	tep->stats.transfers += count;
+	tep->stats.errors += count;
+
+	irq_unlock(key);
+
+	/* Transfers queued by the callbacks are not canceled */
+	for (i = 0; i < count; i++) {
+		reqs[i].cb(ep, reqs[i].buf, -ECANCELED);
+	}
+
+	return 0;
+}
+
+int usb_transfer_get_stats(uint8_t ep, struct usb_ep_stats *stats)
+{
+	struct usb_transfer_ep *tep = transfer_ep_get(ep);
+	int key;
+
+	if (!tep) {
+		return -ENODEV;
+	}
+
+	key = irq_lock();
+	*stats = tep->stats;
+	irq_unlock(key);
+
+	return 0;
+}